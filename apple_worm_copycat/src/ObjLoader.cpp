@@ -1,11 +1,120 @@
 #include "ObjLoader.h"
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include <chrono>
 #include <direct.h>
 
+namespace {
+    const float POW10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
 
+    inline bool isBlank(char c) { return c == ' ' || c == '\t'; }
+    inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    inline void skipBlanks(const char*& p, const char* end) {
+        while (p < end && isBlank(*p)) ++p;
+    }
+
+    inline void skipLine(const char*& p, const char* end) {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+
+    bool parseInt(const char*& p, const char* end, int& out) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p >= end || !isDigit(*p)) return false;
+        int value = 0;
+        while (p < end && isDigit(*p)) {
+            int digit = *p - '0';
+            if (value > (INT_MAX - digit) / 10) return false;  // No entra en un int: mal formado
+            value = value * 10 + digit;
+            ++p;
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+
+    bool parseFloat(const char*& p, const char* end, float& out) {
+        skipBlanks(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+        while (p < end && isDigit(*p)) {
+            if (digits < 18) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) ++digits;
+            }
+            else {
+                ++exponent;
+            }
+            any = true;
+            ++p;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && isDigit(*p)) {
+                if (digits < 18) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    if (mantissa) ++digits;
+                    --exponent;
+                }
+                any = true;
+                ++p;
+            }
+        }
+        if (!any) return false;
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* save = p;
+            ++p;
+            int expValue;
+            if (parseInt(p, end, expValue)) exponent += expValue;
+            else p = save;
+        }
+        double value = static_cast<double>(mantissa);
+        if (exponent < 0) value = exponent >= -10 ? value / POW10[-exponent] : value * std::pow(10.0, exponent);
+        else if (exponent > 0) value = exponent <= 10 ? value * POW10[exponent] : value * std::pow(10.0, exponent);
+        out = static_cast<float>(negative ? -value : value);
+        return true;
+    }
+
+    // Índice OBJ (base 1 o negativo relativo al final) a base 0; -1 si no existe
+    inline int resolveIndex(int index, size_t count) {
+        int resolved = index > 0 ? index - 1 : static_cast<int>(count) + index;
+        return (index != 0 && resolved >= 0 && resolved < static_cast<int>(count)) ? resolved : -1;
+    }
+
+    struct Corner {
+        int pos, tex, norm;
+    };
+
+    // p, p/t, p//n o p/t/n
+    bool parseCorner(const char*& p, const char* end, Corner& c) {
+        c.pos = c.tex = c.norm = 0;
+        if (!parseInt(p, end, c.pos)) return false;
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/' && !parseInt(p, end, c.tex)) return false;
+            if (p < end && *p == '/') {
+                ++p;
+                if (!parseInt(p, end, c.norm)) return false;
+            }
+        }
+        return true;
+    }
+}
 
 //https://www.opengl-tutorial.org/beginners-tutorials/tutorial-7-model-loading/
 //https://en.wikibooks.org/wiki/OpenGL_Programming/Modern_OpenGL_Tutorial_Load_OBJ
@@ -27,70 +136,94 @@ std::vector<ObjVertex> ObjectLoader::loadOBJ(const std::string& filename, float
     std::vector<Vec2> tempTexCoords;
     std::vector<ObjVertex> vertices;
 
-    std::ifstream file(filename);
+    auto start = std::chrono::steady_clock::now();
+
+    // Se lee el archivo completo de una vez y se recorre con punteros, sin copias por línea
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         // std::cerr << "No se pudo abrir el archivo OBJ: " << filename << std::endl;
         return vertices;
     }
+    std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(buffer.data(), buffer.size());
+    file.close();
 
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-
-        if (prefix == "v") {
-            Vec3 pos;
-            iss >> pos.x >> pos.y >> pos.z;
-            pos.x *= scale;
-            pos.y *= scale;
-            pos.z *= scale;
-            tempPositions.push_back(pos);
-        }
-        else if (prefix == "vt") {
-            Vec2 uv;
-            iss >> uv.x >> uv.y;
-            tempTexCoords.push_back(uv);
-        }
-        else if (prefix == "vn") {
-            Vec3 norm;
-            iss >> norm.x >> norm.y >> norm.z;
-            tempNormals.push_back(norm);
-        }
-        else if (prefix == "f") {
-            std::vector<std::string> faceVertices;
-            std::string vertexData;
-            while (iss >> vertexData) {
-                faceVertices.push_back(vertexData);
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+
+    auto emit = [&](const Corner& c) {
+        ObjVertex vtx;
+        int pos = resolveIndex(c.pos, tempPositions.size());
+        int tex = resolveIndex(c.tex, tempTexCoords.size());
+        int norm = resolveIndex(c.norm, tempNormals.size());
+        vtx.position = pos >= 0 ? tempPositions[pos] : Vec3{0,0,0};
+        vtx.texCoord = tex >= 0 ? tempTexCoords[tex] : Vec2{0,0};
+        vtx.texCoord.y = 1.0f - vtx.texCoord.y;
+        vtx.normal = norm >= 0 ? tempNormals[norm] : Vec3{0,0,0};
+        vertices.push_back(vtx);
+    };
+
+    while (p < end) {
+        skipBlanks(p, end);
+        if (p >= end) break;
+
+        if (*p == 'v' && p + 1 < end) {
+            char kind = p[1];
+            p += (kind == '\n' || kind == '\r') ? 1 : 2;
+            if (isBlank(kind)) {
+                Vec3 pos{0,0,0};
+                parseFloat(p, end, pos.x);
+                parseFloat(p, end, pos.y);
+                parseFloat(p, end, pos.z);
+                pos.x *= scale;
+                pos.y *= scale;
+                pos.z *= scale;
+                tempPositions.push_back(pos);
             }
-            for (size_t i = 1; i + 1 < faceVertices.size(); ++i) {
-                int posIdx[3] = {0, 0, 0};
-                int texIdx[3] = {0, 0, 0};
-                int normIdx[3] = {0, 0, 0};
-                std::string vStr[3] = {faceVertices[0], faceVertices[i], faceVertices[i+1]};
-                for (int j = 0; j < 3; ++j) {
-                    std::stringstream vss(vStr[j]);
-                    std::string posStr, texStr, normStr;
-                    std::getline(vss, posStr, '/');
-                    std::getline(vss, texStr, '/');
-                    std::getline(vss, normStr, '/');
-                    posIdx[j] = !posStr.empty() ? std::stoi(posStr) : 0;
-                    texIdx[j] = !texStr.empty() ? std::stoi(texStr) : 0;
-                    normIdx[j] = !normStr.empty() ? std::stoi(normStr) : 0;
-                }
-                for (int j = 0; j < 3; ++j) {
-                    ObjVertex vtx;
-                    vtx.position = (posIdx[j] > 0 && posIdx[j] <= (int)tempPositions.size()) ? tempPositions[posIdx[j] - 1] : Vec3{0,0,0};
-                    vtx.texCoord = (texIdx[j] > 0 && texIdx[j] <= (int)tempTexCoords.size()) ? tempTexCoords[texIdx[j] - 1] : Vec2{0,0};
-                    vtx.texCoord.y = 1.0f - vtx.texCoord.y;
-                    vtx.normal = (normIdx[j] > 0 && normIdx[j] <= (int)tempNormals.size()) ? tempNormals[normIdx[j] - 1] : Vec3{0,0,0};
-                    vertices.push_back(vtx);
+            else if (kind == 't') {
+                Vec2 uv{0,0};
+                parseFloat(p, end, uv.x);
+                parseFloat(p, end, uv.y);
+                tempTexCoords.push_back(uv);
+            }
+            else if (kind == 'n') {
+                Vec3 norm{0,0,0};
+                parseFloat(p, end, norm.x);
+                parseFloat(p, end, norm.y);
+                parseFloat(p, end, norm.z);
+                tempNormals.push_back(norm);
+            }
+        }
+        else if (*p == 'f' && p + 1 < end && isBlank(p[1])) {
+            ++p;
+            Corner first{0,0,0}, previous{0,0,0}, current{0,0,0};
+            int corners = 0;
+            while (true) {
+                skipBlanks(p, end);
+                if (p >= end || *p == '\n' || *p == '\r' || *p == '#') break;
+                if (!parseCorner(p, end, current)) break;
+                // Triangulación en abanico
+                if (corners >= 2) {
+                    emit(first);
+                    emit(previous);
+                    emit(current);
                 }
+                if (corners == 0) first = current;
+                previous = current;
+                ++corners;
             }
         }
+        skipLine(p, end);
     }
 
-    file.close();
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = buffer.size() / (1024.0 * 1024.0);
+    std::cout << "OBJ leído: " << filename << " (" << megabytes << " MB) en " << elapsedMs << " ms";
+    if (elapsedMs > 0.0) {
+        std::cout << " - " << megabytes / (elapsedMs / 1000.0) << " MB/s";
+    }
+    std::cout << std::endl;
 
     // Debug: imprimir los primeros 10 vértices cargados
     // std::cout << "Primeros 10 vértices cargados:" << std::endl;
@@ -12,6 +12,8 @@ public:
     bool hit(const Ray& r, const Interval& ray_t) const;
     static AABB surroundingBox(const AABB& box0, const AABB& box1);
     void expandToInclude(const AABB& other);
+    double surfaceArea() const;
+    Vec3 centroid() const;
 
     Vec3 getMin() const;
     Vec3 getMax() const;
@@ -0,0 +1,121 @@
+/**
+ * @file BVH.h
+ * @brief Jerarquía de volúmenes envolventes (BVH) para acelerar la intersección con mallas
+ *
+ * La construcción usa la heurística de área de superficie (SAH) evaluada sobre
+ * particiones discretas ("bins"). Los niveles superiores reparten el binning entre
+ * varios hilos y los subárboles inferiores se construyen como tareas independientes.
+ * El árbol resultante se aplana en un arreglo en profundidad para recorrerlo sin recursión.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <ostream>
+#include "AABB.h"
+#include "Triangle.h"
+#include "Ray.h"
+#include "Interval.h"
+#include "HitRecord.h"
+
+/**
+ * @brief Estadísticas de construcción y calidad de un BVH
+ */
+struct BVHStats {
+	double build_ms = 0.0;                         ///< Tiempo de construcción en milisegundos
+	double sah_cost = 0.0;                         ///< Costo SAH total del árbol (relativo a la raíz)
+	size_t node_count = 0;                         ///< Cantidad total de nodos
+	size_t leaf_count = 0;                         ///< Cantidad de hojas
+	size_t primitive_count = 0;                    ///< Cantidad de primitivas indexadas
+	int max_depth = 0;                             ///< Profundidad máxima (la raíz tiene profundidad 0)
+	unsigned thread_count = 1;                     ///< Hilos disponibles durante la construcción
+	std::vector<size_t> leaf_size_histogram;       ///< Cantidad de hojas según su número de primitivas
+};
+
+/**
+ * @brief BVH de triángulos construido con SAH por bins y paralelismo por tareas
+ */
+class BVH {
+public:
+	/**
+	 * @brief Nodo del árbol aplanado
+	 *
+	 * El hijo izquierdo de un nodo interno es siempre el nodo siguiente en el arreglo;
+	 * sólo se guarda el índice del hijo derecho.
+	 */
+	struct Node {
+		AABB box;            ///< Caja envolvente del nodo
+		int right_child;     ///< Índice del hijo derecho (sólo nodos internos)
+		int first_prim;      ///< Primera primitiva de la hoja
+		int prim_count;      ///< Cantidad de primitivas (0 en nodos internos)
+		int axis;            ///< Eje de partición, usado para ordenar el recorrido
+	};
+
+	/**
+	 * @brief Constructor por defecto (BVH vacío)
+	 */
+	BVH();
+
+	/**
+	 * @brief Construye el árbol a partir de las primitivas dadas
+	 *
+	 * El BVH toma posesión de la lista y la reordena para que cada hoja
+	 * referencie un rango contiguo de primitivas.
+	 *
+	 * @param primitives Triángulos a indexar
+	 */
+	void build(std::vector<std::shared_ptr<Triangle>> primitives);
+
+	/**
+	 * @brief Adopta un árbol ya construido (por ejemplo, leído de una caché)
+	 *
+	 * @param primitives Triángulos en su orden original
+	 * @param prebuilt_nodes Nodos aplanados
+	 * @param order Índice original de la primitiva en cada posición de hoja
+	 * @return false si los nodos o el orden no son coherentes con las primitivas
+	 */
+	bool assign(std::vector<std::shared_ptr<Triangle>> primitives, std::vector<Node> prebuilt_nodes, const std::vector<int>& order);
+
+	/**
+	 * @brief Intersecta un rayo con el árbol y devuelve la intersección más cercana
+	 * @param r Rayo a testear
+	 * @param t Intervalo válido del parámetro t
+	 * @param rec Registro de la intersección más cercana
+	 * @return true si el rayo intersecta alguna primitiva
+	 */
+	bool hit(const Ray& r, Interval t, HitRecord& rec) const;
+
+	/**
+	 * @brief Caja envolvente de todas las primitivas
+	 */
+	AABB boundingBox() const;
+
+	const std::vector<std::shared_ptr<Triangle>>& getPrimitives() const;
+	const std::vector<Node>& getNodes() const;
+	const std::vector<int>& getPrimitiveOrder() const;
+	const BVHStats& getStats() const;
+
+	/**
+	 * @brief Imprime las estadísticas de construcción en el flujo dado
+	 * @param os Flujo de salida
+	 */
+	void printStats(std::ostream& os) const;
+
+private:
+	struct BuildNode;
+
+	std::unique_ptr<BuildNode> buildRange(std::vector<int>& order, int begin, int end, int depth);
+	int flatten(const BuildNode& node);
+	void computeStats();
+
+	std::vector<std::shared_ptr<Triangle>> primitives;  ///< Primitivas ordenadas por hoja
+	std::vector<Node> nodes;                             ///< Árbol aplanado en profundidad
+	std::vector<int> prim_order;                         ///< Índice original de cada primitiva ordenada
+	std::vector<AABB> prim_boxes;                        ///< Cajas de primitivas (sólo durante la construcción)
+	std::vector<Vec3> prim_centroids;                    ///< Centroides de primitivas (sólo durante la construcción)
+	int task_depth;                                      ///< Profundidad hasta la cual se lanzan tareas paralelas
+	BVHStats stats;                                      ///< Estadísticas de la última construcción
+};
@@ -0,0 +1,74 @@
+/**
+ * @file Benchmark.h
+ * @brief Benchmark del trazador sobre las escenas incluidas
+ *
+ * Renderiza sin ventana cada escena de assets/scenes con una resolución y cantidad de
+ * muestras fijas. Las semillas también son fijas, porque cada muestra se siembra con su
+ * bloque y su número de muestra. Mide el tiempo de pared (el mejor y la mediana de
+ * varias corridas, sin contar la carga), los rayos primarios, totales y de sombra por
+ * segundo y el pico de memoria residente del proceso.
+ *
+ * El resultado es un JSON con un objeto por escena en cada línea, para poder leerlo sin
+ * un parser general. El pico de memoria va una sola vez, fuera de las escenas: el sistema
+ * sólo da el máximo de todo el proceso, que nunca baja, así que cada escena heredaría el
+ * de las anteriores. Con una línea base guardada se compara el mejor tiempo de cada
+ * escena y se rechaza el cambio si alguna empeora más que la tolerancia.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Benchmark {
+public:
+	/**
+	 * @brief Medición de una escena
+	 */
+	struct Result {
+		std::string scene;
+		int width = 0;
+		int height = 0;
+		int samples = 0;
+		double load_seconds = 0.0;
+		double best_seconds = 0.0;    ///< Menor tiempo de render entre las corridas
+		double median_seconds = 0.0;
+		uint64_t primary_rays = 0;
+		uint64_t total_rays = 0;      ///< Consultas de intersección más rayos de sombra
+		uint64_t shadow_rays = 0;
+	};
+
+	/**
+	 * @brief Corre el benchmark completo
+	 * @param output_path JSON a escribir
+	 * @param baseline_path Línea base con la que comparar (vacío para no comparar)
+	 * @param tolerance_percent Empeoramiento admitido del tiempo de cada escena
+	 * @return 0 si terminó y no hay regresiones, 1 si no
+	 */
+	static int run(const std::string& output_path, const std::string& baseline_path, double tolerance_percent);
+
+	/**
+	 * @param peak_rss_bytes Pico de memoria residente del proceso después de todas las escenas
+	 */
+	static bool writeJSON(const std::string& path, const std::vector<Result>& results, unsigned threads, uint64_t peak_rss_bytes);
+
+	/**
+	 * @brief Lee un JSON escrito con writeJSON()
+	 * @return false si no existe o no tiene escenas
+	 */
+	static bool readJSON(const std::string& path, std::vector<Result>& results);
+
+	/**
+	 * @brief Compara con la línea base e imprime la diferencia de cada escena
+	 * @return false si alguna escena empeoró más que la tolerancia
+	 */
+	static bool compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double tolerance_percent);
+
+	/**
+	 * @brief Pico de memoria residente del proceso en bytes (0 si no se puede medir)
+	 */
+	static uint64_t peakResidentBytes();
+};
@@ -0,0 +1,68 @@
+/**
+ * @file BinaryStream.h
+ * @brief Escritura y lectura de datos binarios para los formatos de caché del ray tracer
+ *
+ * BinaryWriter escribe valores crudos sobre un std::ostream. BinaryReader recorre un
+ * bloque de memoria (típicamente un MappedFile) verificando los límites en cada lectura,
+ * de modo que un archivo truncado o corrupto se detecta en lugar de leer fuera del mapeo.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include "Vec3.h"
+#include "Color.h"
+
+class BinaryWriter {
+public:
+	explicit BinaryWriter(std::ostream& out);
+
+	template <typename T>
+	void write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Sólo se escriben tipos triviales");
+		out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void writeBytes(const void* data, size_t size);
+	void writeString(const std::string& value);
+	void writeVec3(const Vec3& value);
+	void writeColor(const Color& value);
+
+	bool good() const;
+
+private:
+	std::ostream& out;
+};
+
+class BinaryReader {
+public:
+	BinaryReader(const char* data, size_t size);
+
+	template <typename T>
+	bool read(T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Sólo se leen tipos triviales");
+		return readBytes(&value, sizeof(T));
+	}
+
+	bool readBytes(void* dst, size_t size);
+	bool readString(std::string& value);
+	bool readVec3(Vec3& value);
+	bool readColor(Color& value);
+
+	/**
+	 * @brief Verifica que queden al menos count elementos de element_size bytes
+	 */
+	bool canRead(uint64_t count, size_t element_size) const;
+
+	size_t remaining() const;
+
+private:
+	const char* cursor;
+	size_t left;
+};
@@ -17,6 +17,7 @@
 #include "Entity.h"
 #include "Scene.h"
 #include "WhittedTracer.h"
+#include "Sampler.h"
 
 class Camera {
 public:
@@ -37,11 +38,16 @@ public:
 
 	/**
 	 * @brief Obtiene un rayo para un píxel específico
+	 *
+	 * La posición dentro del píxel la da el patrón de muestreo de la cámara (ver Sampler)
+	 * según el píxel y el número de muestra.
+	 *
 	 * @param i Coordenada x del píxel
 	 * @param j Coordenada y del píxel
+	 * @param sample Número de muestra del píxel (0, 1, 2, ...)
 	 * @return Rayo generado
 	 */
-	Ray getRandomRay(int i, int j) const;
+	Ray getRandomRay(int i, int j, uint64_t sample) const;
 	
 	Ray getRay(int i, int j) const;
 
@@ -63,12 +69,38 @@ public:
 	 */
 	int getSamplesPerPixel() const; 
 
+	/**
+	 * @brief Obtiene la relación de aspecto con la que se construyó la cámara
+	 * @return Ancho sobre alto
+	 */
+	double getAspectRatio() const;
+
+	/**
+	 * @brief Cambia el patrón con el que se reparten las muestras dentro de cada píxel
+	 */
+	void setSampler(SamplerType type) { sampler = type; }
+	SamplerType getSampler() const { return sampler; }
+
 	void renderRow(int j, const Scene& scene, const WhittedTracer& tracer, std::vector<Color>& buffer) const;
 
 	Camera(const Vec3& eye, const Vec3& lookAt, const Vec3& up, double aspect_ratio, int image_width, int samples_per_pixel);
 	Vec3& getEye() { return eye; }
 	Vec3& getLookAt() { return lookAt; }
 	Vec3& getUp() { return up; }
+	const Vec3& getEye() const { return eye; }
+	const Vec3& getLookAt() const { return lookAt; }
+	const Vec3& getUp() const { return up; }
+
+	/**
+	 * @brief Cambia la posición y orientación de la cámara y recalcula el viewport
+	 *
+	 * No debe llamarse mientras otro hilo genera rayos con esta cámara.
+	 *
+	 * @param eye Posición de la cámara
+	 * @param lookAt Punto al que mira
+	 * @param up Vector hacia arriba
+	 */
+	void setView(const Vec3& eye, const Vec3& lookAt, const Vec3& up);
 
 private:
 	int image_height; ///< Altura de la imagen en píxeles
@@ -81,6 +113,8 @@ private:
 	Vec3 pixel00_loc; ///< Posición del píxel (0,0) en el viewport
 	Vec3 pixel_delta_u; ///< Vector delta horizontal entre píxeles
 	Vec3 pixel_delta_v; ///< Vector delta vertical entre píxeles
+	double differential_scale; ///< Escala de los diferenciales de rayo según las muestras por píxel
+	SamplerType sampler = SamplerType::Sobol; ///< Patrón de muestreo del píxel
 
 	/**
 	 * @brief Inicializa los parámetros de la cámara
@@ -99,7 +133,7 @@ private:
 	 * @brief Muestra un cuadrado para el muestreo
 	 * @return Vector de muestreo
 	 */
-	Vec3 sample_square() const;
+	Vec3 sample_square(int i, int j, uint64_t sample) const;
 
 	/**
 	 * @brief Genera un nombre de archivo con timestamp
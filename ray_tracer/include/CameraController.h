@@ -0,0 +1,51 @@
+/**
+ * @file CameraController.h
+ * @brief Navegación de la cámara con teclado y mouse en el visor en vivo
+ *
+ * El controlador guarda su propia copia de la vista (eye, lookAt, up) y la modifica con
+ * los eventos de SDL; la cámara real sólo cambia al llamar a apply(), para que el visor
+ * pueda detener antes los hilos de render que la están usando.
+ *
+ * Controles:
+ * - W/S: avanzar y retroceder, A/D: desplazarse a los lados, Q/E: bajar y subir
+ * - Flechas o arrastre con el botón izquierdo: girar la vista
+ * - Rueda del mouse: acercar y alejar
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <SDL.h>
+#include "Vec3.h"
+
+class Camera;
+
+class CameraController {
+public:
+	/**
+	 * @brief Toma la vista inicial de la cámara
+	 */
+	explicit CameraController(Camera& camera);
+
+	/**
+	 * @brief Actualiza la vista según un evento de SDL
+	 * @return true si la vista cambió
+	 */
+	bool handleEvent(const SDL_Event& event);
+
+	/**
+	 * @brief Copia la vista actual a la cámara
+	 */
+	void apply(Camera& camera) const;
+
+private:
+	void move(const Vec3& direction, double amount);
+	void rotate(double yaw, double pitch);
+
+	Vec3 eye;
+	Vec3 look_at;
+	Vec3 up;
+	double move_step;    ///< Distancia de cada paso, proporcional a la distancia al punto mirado
+	bool dragging;
+};
@@ -0,0 +1,37 @@
+/**
+ * @file CancellationToken.h
+ * @brief Señal compartida para pedir que un render termine antes de tiempo
+ *
+ * Quien lanza el render conserva el token y llama a cancel() desde cualquier hilo
+ * (por ejemplo al acercarse el límite de un trabajo programado); el render lo consulta
+ * entre bloques y se detiene dejando la mejor imagen obtenida hasta ese momento.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <atomic>
+
+class CancellationToken {
+public:
+	CancellationToken();
+
+	CancellationToken(const CancellationToken&) = delete;
+	CancellationToken& operator=(const CancellationToken&) = delete;
+
+	/**
+	 * @brief Pide la cancelación; es seguro llamarlo desde cualquier hilo y más de una vez
+	 */
+	void cancel();
+
+	/**
+	 * @brief Vuelve a dejar el token sin cancelar para reutilizarlo
+	 */
+	void reset();
+
+	bool isCancelled() const;
+
+private:
+	std::atomic<bool> cancelled;
+};
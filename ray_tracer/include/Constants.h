@@ -10,8 +10,10 @@
  */
 
 #pragma once
+#include <cstdint>
 #include <limits>
 #include <cstdlib>
+#include <ctime>
 
 const double PI = 3.14159265358979323846; ///< Valor de pi
 const int WIDTH = 800; ///< Ancho predeterminado de la imagen
@@ -38,12 +40,43 @@ inline double degToRad(double degrees) {
 	return degrees * (PI / 180.0);
 }
 
+/**
+ * @brief Estado del generador aleatorio del hilo actual
+ *
+ * Cada hilo tiene su propia secuencia (splitmix64), así que los hilos de render no
+ * comparten estado ni repiten los mismos números como pasaría con std::rand.
+ */
+inline uint64_t& random_state() {
+	thread_local uint64_t state = 0x853C49E6748FEA9BULL;
+	return state;
+}
+
+/**
+ * @brief Reinicia la secuencia aleatoria del hilo actual
+ *
+ * Sembrar con un valor que dependa sólo del trabajo (por ejemplo bloque y pasada) hace
+ * que la imagen no dependa de cuántos hilos la rendericen ni en qué orden.
+ *
+ * @param seed Semilla
+ */
+inline void seed_random(uint64_t seed) {
+	// Se mezcla la semilla para que semillas consecutivas no den secuencias desplazadas una de otra
+	uint64_t z = seed + 0x853C49E6748FEA9BULL;
+	z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCDULL;
+	z = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53ULL;
+	random_state() = z ^ (z >> 33);
+}
+
 /**
  * @brief Genera un número aleatorio entre 0 y 1
  * @return Número aleatorio en el rango [0,1)
  */
 inline double random_double() {
-	return std::rand() / (RAND_MAX + 1.0);
+	uint64_t z = (random_state() += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z ^= z >> 31;
+	return (z >> 11) * (1.0 / 9007199254740992.0);
 }
 
 /**
@@ -61,4 +94,22 @@ T clamp(T value, T min, T max) {
     if (value < min) return min;
     if (value > max) return max;
     return value;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Hora local de un instante, en cualquier plataforma
+ *
+ * localtime_s sólo existe con MSVC y localtime no es seguro con varios hilos; en el
+ * resto de las plataformas se usa localtime_r.
+ *
+ * @param time Instante
+ * @param out Hora local
+ * @return false si no se pudo convertir
+ */
+inline bool localTime(const std::time_t& time, std::tm& out) {
+#ifdef _WIN32
+    return localtime_s(&out, &time) == 0;
+#else
+    return localtime_r(&time, &out) != nullptr;
+#endif
+}
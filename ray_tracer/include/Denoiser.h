@@ -0,0 +1,82 @@
+/**
+ * @file Denoiser.h
+ * @brief Filtro de ruido posterior al render guiado por normal, profundidad y albedo
+ *
+ * Implementa el filtro à-trous con detección de bordes (Dammertz et al., "Edge-Avoiding
+ * À-Trous Wavelet Transform for fast Global Illumination Filtering", 2010): varias pasadas
+ * de un núcleo B3-spline de 5x5 con separación creciente entre muestras (1, 2, 4, ...),
+ * donde el peso de cada vecino cae si difiere del píxel central en color, normal,
+ * profundidad o albedo. Así se promedia dentro de cada superficie pero no a través de
+ * los bordes de la geometría.
+ *
+ * Las guías (AOV) se calculan aparte con unos pocos rayos primarios por píxel: la normal,
+ * la distancia y el albedo del material en el primer impacto. Antes de filtrar la imagen
+ * se divide por el albedo y después se vuelve a multiplicar, con lo que se filtra sólo la
+ * iluminación y el detalle de las texturas se conserva.
+ *
+ * Los datos se guardan por planos de floats (un vector por canal) y cada fila se recorre
+ * muestra del núcleo por muestra del núcleo, así el bucle interno es contiguo y sin saltos
+ * que impidan vectorizarlo. Las filas se reparten entre todos los núcleos.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "Color.h"
+#include "HDRImage.h"
+
+class Camera;
+class Scene;
+
+class Denoiser {
+public:
+	/**
+	 * @brief Guías del filtro, un plano por canal
+	 */
+	struct Features {
+		int width = 0;
+		int height = 0;
+		std::vector<float> albedo[3];   ///< Albedo del material en el primer impacto (0 sin impacto)
+		std::vector<float> normal[3];   ///< Normal en el primer impacto (0 sin impacto)
+		std::vector<float> depth;       ///< Distancia desde la cámara al primer impacto (0 sin impacto)
+	};
+
+	/**
+	 * @brief Parámetros del filtro
+	 */
+	struct Settings {
+		int iterations = 5;             ///< Pasadas (la última separa las muestras 2^(iterations-1) píxeles)
+		float sigma_color = 0.6f;       ///< Tolerancia de la luminancia, en escala logarítmica (se reduce a la mitad en cada pasada)
+		float sigma_normal = 0.3f;      ///< Tolerancia de la distancia entre normales
+		float sigma_depth = 0.03f;      ///< Tolerancia de la profundidad, relativa a la del píxel y a la separación
+		float sigma_albedo = 0.1f;      ///< Tolerancia de la distancia entre albedos
+	};
+
+	/**
+	 * @brief Calcula las guías promediando varios rayos primarios por píxel
+	 *
+	 * Las semillas dependen sólo de la fila, así el resultado no depende de los hilos.
+	 *
+	 * @param samples Rayos por píxel (con jitter, para que los bordes tengan valores intermedios como la imagen)
+	 */
+	static Features gatherFeatures(const Scene& scene, const Camera& camera, int samples);
+
+	/**
+	 * @brief Filtra una imagen lineal del mismo tamaño que las guías
+	 */
+	static std::vector<Color> denoise(const std::vector<Color>& image, const Features& features, const Settings& settings);
+
+	/**
+	 * @brief Filtra la imagen del render y guarda images/denoised_<fecha>.png
+	 *
+	 * Con un formato HDR guarda también la imagen filtrada en float y las guías
+	 * (albedo_, normal_ y depth_<fecha>) para posprocesarlas aparte.
+	 *
+	 * @param image Imagen lineal del render (por ejemplo ProgressiveRenderer::getImage())
+	 * @return true si se pudo guardar
+	 */
+	static bool run(const std::vector<Color>& image, const Scene& scene, const Camera& camera, HDRFormat hdr_format);
+};
@@ -0,0 +1,54 @@
+/**
+ * @file HDRImage.h
+ * @brief Escritura de imágenes de punto flotante (PFM u OpenEXR) con los valores lineales del render
+ *
+ * Los PNG pasan por la corrección de gamma y la saturación a 8 bits, así que cambiar la
+ * exposición o el tonemapping obliga a renderizar de nuevo. Guardando además el buffer
+ * lineal en float (FIT_RGBF de FreeImage) el posprocesado, la composición y el denoising
+ * trabajan sobre los datos guardados.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "Color.h"
+
+/**
+ * @brief Formato de la salida de punto flotante
+ */
+enum class HDRFormat {
+	None,   ///< Sólo PNG
+	PFM,    ///< Portable float map, float de 32 bits sin compresión
+	EXR     ///< OpenEXR con la compresión por defecto de FreeImage (half con PIZ)
+};
+
+class HDRImage {
+public:
+	/**
+	 * @brief Interpreta "pfm" o "exr"
+	 * @return false si el nombre no es un formato conocido
+	 */
+	static bool parseFormat(const std::string& name, HDRFormat& format);
+
+	/**
+	 * @brief Extensión del formato, con el punto (".pfm" o ".exr")
+	 */
+	static const char* extension(HDRFormat format);
+
+	/**
+	 * @brief Guarda una imagen lineal RGB
+	 * @param path Archivo de salida (con la extensión del formato)
+	 * @param pixels Píxeles por filas, de arriba hacia abajo
+	 * @return true si se pudo guardar
+	 */
+	static bool save(const std::string& path, const std::vector<Color>& pixels, int width, int height, HDRFormat format);
+
+	/**
+	 * @brief Guarda una imagen lineal como PNG con la corrección de gamma (raíz cuadrada) y la
+	 * saturación del render en vivo
+	 */
+	static bool savePNG(const std::string& path, const std::vector<Color>& pixels, int width, int height);
+};
@@ -38,6 +38,7 @@ public:
 	Vec3 normal;                             ///< Vector normal unitario en el punto de intersección
 	double t;                                ///< Valor del parámetro t en la ecuación del rayo
 	double u, v;                             ///< Coordenadas de textura (u,v)
+	double dudx, dvdx, dudy, dvdy;           ///< Variación de (u,v) entre píxeles vecinos (cero si el rayo no tiene diferenciales)
 	bool frontFace;                          ///< true si el rayo golpea la cara frontal, false si es la trasera
 	std::shared_ptr<Material> material_ptr;  ///< Puntero al material del objeto intersectado
 	//std::shared_ptr<Material> mat;           ///< Alias para material_ptr
@@ -53,7 +54,7 @@ public:
 	/**
 	 * @brief Constructor por defecto
 	 */
-	HitRecord() : point(Vec3()), normal(Vec3()), t(0), u(0), v(0), frontFace(true) {}
+	HitRecord() : point(Vec3()), normal(Vec3()), t(0), u(0), v(0), dudx(0), dvdx(0), dudy(0), dvdy(0), frontFace(true) {}
 
 	/**
 	 * @brief Determina si la intersección es en la cara frontal o trasera
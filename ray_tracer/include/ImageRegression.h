@@ -0,0 +1,63 @@
+/**
+ * @file ImageRegression.h
+ * @brief Pruebas de regresión de imagen contra renders de referencia
+ *
+ * Renderiza sin ventana las escenas de referencia con tamaño y muestras fijos. Las
+ * semillas son deterministas porque cada muestra se siembra con su bloque y su número de
+ * muestra, así que el resultado no depende de la cantidad de hilos. Cada imagen se
+ * compara con su referencia en assets/golden (la acumulación guardada como PartialImage,
+ * sin pérdida) y se mide PSNR, SSIM y error máximo sobre los valores que se muestran en
+ * pantalla (con corrección de gamma y saturados).
+ *
+ * Si alguna escena no pasa los umbrales se guardan la imagen obtenida y una imagen de
+ * diferencias en images/ y el proceso termina con error, así la prueba puede correr en
+ * integración continua antes de aceptar un cambio de rendimiento. Con update = true las
+ * referencias se regeneran a partir del render actual.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "Color.h"
+
+class ImageRegression {
+public:
+	/**
+	 * @brief Diferencia entre una imagen y su referencia
+	 */
+	struct Metrics {
+		double psnr = 0.0;        ///< En dB (infinito si son idénticas)
+		double ssim = 1.0;        ///< Promedio del SSIM de la luminancia en ventanas de 8x8
+		double max_error = 0.0;   ///< Mayor diferencia de un canal, entre 0 y 1
+	};
+
+	/// Código de salida de run cuando falta alguna referencia (el que CTest toma como prueba salteada)
+	static const int MISSING_REFERENCES = 77;
+
+	/**
+	 * @brief Renderiza las escenas de referencia y las compara (o regenera) con las referencias
+	 *
+	 * Las referencias no vienen con el repositorio: se generan con update = true en un build
+	 * con FreeImage, porque la decodificación de las texturas forma parte del resultado.
+	 *
+	 * @param golden_directory Directorio de las referencias
+	 * @param update true para reemplazar las referencias en lugar de comparar
+	 * @return 0 si todas las escenas pasan (o se actualizaron), MISSING_REFERENCES si falta
+	 * alguna referencia, 1 si alguna escena no pasa
+	 */
+	static int run(const std::string& golden_directory, bool update);
+
+	/**
+	 * @brief Compara dos imágenes lineales del mismo tamaño en el espacio que se muestra en pantalla
+	 */
+	static Metrics compare(const std::vector<Color>& reference, const std::vector<Color>& image, int width, int height);
+
+	/**
+	 * @brief Guarda la diferencia por píxel (amplificada) como PNG
+	 */
+	static bool saveDifference(const std::string& path, const std::vector<Color>& reference,
+		const std::vector<Color>& image, int width, int height);
+};
@@ -66,6 +66,8 @@ public:
     Color shade(const Ray& r_in, const HitRecord& rec, const class Scene& scene, int depth) const override;
     //double transparency() const;
 
+    Color getAlbedo(const HitRecord&) const override { return diffuse; }
+
 
     virtual Color shadeComponent(ShadeComponent component,
         const Ray& ray,
@@ -0,0 +1,103 @@
+/**
+ * @file LocalSocket.h
+ * @brief Conexión local entre procesos de la misma máquina
+ *
+ * Envuelve un named pipe (\\.\pipe\<nombre>) en Windows y un socket Unix en sistemas
+ * POSIX, con la misma interfaz de flujo de bytes en ambos casos. La usa el servicio de
+ * render para recibir trabajos y devolver imágenes sin pasar por la red.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+class LocalConnection {
+public:
+	LocalConnection();
+	~LocalConnection();
+
+	LocalConnection(const LocalConnection&) = delete;
+	LocalConnection& operator=(const LocalConnection&) = delete;
+	LocalConnection(LocalConnection&& other);
+	LocalConnection& operator=(LocalConnection&& other);
+
+	/**
+	 * @brief Se conecta a un servidor que escucha en el endpoint
+	 * @param endpoint Nombre del pipe (Windows) o ruta del socket (POSIX)
+	 * @return true si se pudo conectar
+	 */
+	bool connect(const std::string& endpoint);
+
+	/**
+	 * @brief Lee una línea terminada en '\n' (sin incluirlo)
+	 * @return false si la conexión se cerró antes de completar la línea
+	 */
+	bool readLine(std::string& line);
+
+	/**
+	 * @brief Lee exactamente size bytes
+	 */
+	bool readBytes(void* data, size_t size);
+
+	/**
+	 * @brief Escribe todos los bytes
+	 * @return false si el otro extremo cerró la conexión
+	 */
+	bool writeBytes(const void* data, size_t size);
+	bool writeLine(const std::string& line);
+
+	void close();
+	bool isOpen() const;
+
+private:
+	friend class LocalServer;
+
+	size_t readSome(char* data, size_t size);
+
+	std::string buffered;         ///< Bytes leídos de más por readLine()
+#ifdef _WIN32
+	void* handle;                 ///< HANDLE del pipe
+	bool server_side;             ///< Del lado del servidor se desconecta en lugar de sólo cerrar
+#else
+	int fd;                       ///< Descriptor del socket
+#endif
+};
+
+class LocalServer {
+public:
+	LocalServer();
+	~LocalServer();
+
+	LocalServer(const LocalServer&) = delete;
+	LocalServer& operator=(const LocalServer&) = delete;
+
+	/**
+	 * @brief Empieza a escuchar en el endpoint
+	 *
+	 * En POSIX un socket que quedó de una ejecución anterior se reemplaza; si en la ruta
+	 * hay otro tipo de archivo no se toca y falla.
+	 *
+	 * @param endpoint Nombre del pipe (Windows) o ruta del socket (POSIX)
+	 * @return true si se pudo crear
+	 */
+	bool listen(const std::string& endpoint);
+
+	/**
+	 * @brief Espera el próximo cliente
+	 * @return false si falló la espera
+	 */
+	bool accept(LocalConnection& connection);
+
+	void close();
+
+private:
+	std::string path;             ///< Endpoint ya resuelto
+#ifdef _WIN32
+	void* pending;                ///< Instancia del pipe que espera al próximo cliente
+#else
+	int fd;                       ///< Socket que escucha
+#endif
+};
@@ -0,0 +1,70 @@
+/**
+ * @file MappedFile.h
+ * @brief Archivo de sólo lectura mapeado en memoria
+ *
+ * Envuelve CreateFileMapping/MapViewOfFile en Windows y mmap en sistemas POSIX,
+ * de modo que los cargadores puedan recorrer el contenido de un archivo como un
+ * único bloque de memoria sin copiarlo.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief Mapea el archivo completo en memoria
+	 * @param path Ruta del archivo
+	 * @return true si el archivo pudo abrirse y mapearse
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * @brief Libera el mapeo (se llama automáticamente en el destructor)
+	 */
+	void close();
+
+	const char* data() const;     ///< Inicio del contenido (nullptr si el archivo está vacío)
+	size_t size() const;          ///< Tamaño en bytes
+	bool isOpen() const;
+
+	/**
+	 * @brief Tamaño y fecha de modificación de un archivo, sin abrirlo
+	 *
+	 * Lo usan las cachés en disco para detectar si el archivo de origen cambió.
+	 *
+	 * @return false si el archivo no existe
+	 */
+	static bool fileInfo(const std::string& path, uint64_t& size, int64_t& mtime);
+
+	/**
+	 * @brief Hash del contenido completo de un archivo (FNV-1a por palabras de 64 bits)
+	 *
+	 * Lo usan las cachés y los checkpoints para comprobar que el archivo de origen es el mismo.
+	 *
+	 * @return false si el archivo no pudo abrirse
+	 */
+	static bool hashContents(const std::string& path, uint64_t& hash);
+
+private:
+	const char* view;             ///< Puntero al contenido mapeado
+	size_t length;                ///< Tamaño del contenido
+	bool opened;                  ///< true mientras haya un archivo abierto
+#ifdef _WIN32
+	void* file_handle;            ///< HANDLE del archivo
+	void* mapping_handle;         ///< HANDLE del mapeo
+#else
+	int fd;                       ///< Descriptor del archivo
+#endif
+};
@@ -92,6 +92,19 @@ public:
      */
     virtual double getTransparency() const { return 0.0; }
 
+    /**
+     * @brief Color base de la superficie en el punto de intersección, sin iluminación
+     *
+     * Lo usa el denoiser como guía (AOV de albedo) para no borrar el detalle de las texturas.
+     *
+     * @param hit_record Información de la intersección
+     * @return Albedo (blanco si el material no define uno)
+     */
+    virtual Color getAlbedo(const HitRecord& hit_record) const {
+        (void)hit_record;
+        return Color(1, 1, 1);
+    }
+
 
     virtual Color shadeComponent(ShadeComponent component,
         const Ray& ray,
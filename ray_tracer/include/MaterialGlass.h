@@ -54,6 +54,7 @@ public:
 
     double getReflectivity() const override;     // Ajustable
     double getTransparency() const override;   // Mayormente transparente
+    Color getAlbedo(const HitRecord& hit_record) const override;
 
     virtual Color shadeComponent(ShadeComponent component,
         const Ray& ray,
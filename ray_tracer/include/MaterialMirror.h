@@ -45,6 +45,7 @@ public:
 
     double getReflectivity() const override;  
     double getTransparency() const override;  
+    Color getAlbedo(const HitRecord& hit_record) const override;
 
     virtual Color shadeComponent(ShadeComponent component,
         const Ray& ray,
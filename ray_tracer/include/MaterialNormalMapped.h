@@ -4,6 +4,7 @@
 #include "Texture.h"
 #include "Color.h"
 #include "Constants.h"
+#include <memory>
 
 /**
  * @brief Material Lambertiano con normal mapping. Usa colores fijos pero modifica la normal con una textura.
@@ -14,7 +15,7 @@ public:
         const Color& diffuse,
         const Color& specular,
         float shininess,
-        const Texture& normalMap);
+        std::shared_ptr<const Texture> normalMap);
 
     Color shade(const Ray& r_in, const HitRecord& rec, const Scene& scene, int depth) const override;
     Color shadeComponent(ShadeComponent component,
@@ -22,13 +23,14 @@ public:
         const HitRecord& rec,
         const Scene& scene) const override;
 
+    Color getAlbedo(const HitRecord&) const override { return diffuse; }
 
 private:
     Color ambient;
     Color diffuse;
     Color specular;
     float shininess;
-    Texture normalMap;
+    std::shared_ptr<const Texture> normalMap; // Compartida con otros materiales a través de TextureCache
 
     Vec3 perturbNormal(const HitRecord& rec) const;
 };
\ No newline at end of file
@@ -4,10 +4,11 @@
 #include "Texture.h"
 #include "Color.h"
 #include "Constants.h" 
+#include <memory>
 
 class MaterialTextured : public Material {
 public:
-    MaterialTextured(const Texture& texture, double shininess);
+    MaterialTextured(std::shared_ptr<const Texture> texture, double shininess);
 
     Color shade(const Ray& r_in, const HitRecord& rec, const Scene& scene, int depth) const override;
     Color shadeComponent(ShadeComponent component,
@@ -15,7 +16,9 @@ public:
         const HitRecord& rec,
         const Scene& scene) const override;
 
+    Color getAlbedo(const HitRecord& rec) const override;
+
 private:
-    Texture texture;
+    std::shared_ptr<const Texture> texture; // Compartida con otros materiales a través de TextureCache
     double shininess;
 };
\ No newline at end of file
@@ -8,9 +8,28 @@
 #include "Material.h"
 #include "AABB.h"
 #include "Triangle.h"
+#include "BVH.h"
+
+/**
+ * @brief Malla indexada tal como se lee de un archivo .obj
+ *
+ * Cada atributo tiene su propio arreglo de índices por triángulo, como en el formato OBJ.
+ * Los índices de normales y coordenadas de textura valen -1 cuando la cara no los define.
+ */
+struct MeshData {
+    std::vector<Vec3> positions;
+    std::vector<Vec3> normals;
+    std::vector<Vec3> tex_coords;                      ///< (u, v, 0)
+    std::vector<std::array<int, 3>> position_indices;
+    std::vector<std::array<int, 3>> normal_indices;
+    std::vector<std::array<int, 3>> tex_coord_indices;
+};
 
 class Mesh : public Entity {
 public:
+    Mesh(const MeshData& data, std::shared_ptr<Material> mat);
+    // Usa un BVH ya construido (p. ej. de MeshCache); si no es válido lo reconstruye
+    Mesh(const MeshData& data, std::shared_ptr<Material> mat, std::vector<BVH::Node> nodes, const std::vector<int>& order);
     Mesh(const std::vector<Vec3>& vertices, const std::vector<std::array<int, 3>>& indices, std::shared_ptr<Material> mat, const Vec3& scale = Vec3(1, 1, 1), const Vec3& translate = Vec3(0, 0, 0));
 
     bool hit(const Ray& r, Interval t, HitRecord& rec) const override;
@@ -18,7 +37,10 @@ public:
 
     void setMaterial(std::shared_ptr<Material> material) override;
 
+    const BVH& getBVH() const;
+
 private:
-    std::vector<std::shared_ptr<Triangle>> triangles;
-    AABB bounding_box;
+    static std::vector<std::shared_ptr<Triangle>> makeTriangles(const MeshData& data, std::shared_ptr<Material> mat);
+
+    BVH bvh;
 };
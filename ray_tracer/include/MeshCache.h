@@ -0,0 +1,63 @@
+/**
+ * @file MeshCache.h
+ * @brief Caché binaria de mallas (.meshcache) junto a cada archivo .obj
+ *
+ * La primera vez que se carga un .obj se escribe a su lado un archivo versionado con
+ * las posiciones, normales, coordenadas de textura, índices y el BVH ya construido.
+ * Las cargas siguientes mapean ese archivo en memoria y lo usan directamente si el
+ * tamaño, la fecha de modificación y el hash del .obj coinciden con los guardados.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+#include "Mesh.h"
+#include "BVH.h"
+#include "BinaryStream.h"
+
+class MeshCache {
+public:
+	/**
+	 * @brief Ruta de la caché asociada a un .obj
+	 */
+	static std::string cachePath(const std::string& obj_path);
+
+	/**
+	 * @brief Intenta leer la caché de un .obj
+	 *
+	 * La caché guarda la malla tal como está en el .obj, sin la escala ni la traslación
+	 * de la escena, así una sola caché sirve a todas las escenas que usan el archivo.
+	 *
+	 * @param obj_path Ruta del .obj de origen
+	 * @param data Malla leída
+	 * @param nodes Nodos del BVH (vacío si la caché no lo incluye)
+	 * @param order Orden de primitivas del BVH
+	 * @return true si la caché existe, es válida y corresponde al .obj actual
+	 */
+	static bool load(const std::string& obj_path, MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order);
+
+	/**
+	 * @brief Escribe la caché de un .obj
+	 * @param obj_path Ruta del .obj de origen
+	 * @param data Malla a guardar, sin transformar
+	 * @param bvh BVH construido para la malla (se guarda si no está vacío)
+	 * @return true si la caché se escribió correctamente
+	 */
+	static bool save(const std::string& obj_path, const MeshData& data, const BVH& bvh);
+
+	/**
+	 * @brief Escribe una malla (y su BVH) como bloque binario, sin encabezado de origen
+	 *
+	 * Es el mismo bloque que usa la caché; otros formatos (p. ej. SceneBundle) lo embeben.
+	 */
+	static void writeMesh(BinaryWriter& out, const MeshData& data, const BVH& bvh);
+
+	/**
+	 * @brief Lee un bloque escrito por writeMesh validando tamaños e índices
+	 * @return false si el bloque está truncado o tiene índices fuera de rango
+	 */
+	static bool readMesh(BinaryReader& in, MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order);
+};
@@ -0,0 +1,47 @@
+/**
+ * @file MicroBenchmark.h
+ * @brief Micro-benchmarks de los núcleos de intersección, muestreo de texturas y sombreado
+ *
+ * Mide cada núcleo aislado (Sphere::hit, Triangle::hit, Quad::hit, Cylinder::hit,
+ * AABB::hit, Texture::sample y el shade de cada material) sobre un conjunto fijo de
+ * entradas aleatorias generadas con una semilla fija, así dos corridas miden exactamente
+ * el mismo trabajo. El tiempo se toma con el contador de ciclos del procesador (rdtsc)
+ * cuando existe y con steady_clock si no.
+ *
+ * Cada núcleo se calienta con unas pasadas sin medir y después se mide por lotes: el
+ * costo de un lote dividido por la cantidad de entradas da una muestra de ciclos por
+ * llamada. Se reportan la mediana y los percentiles de esas muestras, que a diferencia
+ * del promedio no se mueven por una interrupción aislada.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <vector>
+
+class MicroBenchmark {
+public:
+	/**
+	 * @brief Resultado de un núcleo, en ciclos (o nanosegundos sin rdtsc) por llamada
+	 */
+	struct Result {
+		std::string kernel;
+		double min = 0.0;
+		double p05 = 0.0;
+		double median = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double nanoseconds = 0.0;     ///< Mediana convertida a nanosegundos
+	};
+
+	/**
+	 * @brief Mide todos los núcleos, imprime la tabla y guarda el JSON
+	 * @param output_path JSON a escribir (vacío para sólo imprimir)
+	 * @return 0 si se pudo guardar el resultado
+	 */
+	static int run(const std::string& output_path);
+
+	static bool writeJSON(const std::string& path, const std::vector<Result>& results);
+};
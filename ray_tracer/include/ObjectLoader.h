@@ -1,7 +1,9 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <vector>
 #include "Mesh.h"
+#include "BVH.h"
 
 class ObjectLoader {
 public:
@@ -15,4 +17,37 @@ public:
         std::shared_ptr<Material> mat,
         const Vec3& scale = Vec3(1, 1, 1),
         const Vec3& translate = Vec3(0, 0, 0));
+
+    /**
+     * @brief Obtiene los datos de un .obj desde su cach binaria o, si no es vlida, leyendo el texto
+     *
+     * Si se ley el texto construye el BVH y escribe la cach, sin transformar. La escala
+     * y la traslacin se aplican despus a las posiciones, las normales y las cajas del BVH.
+     *
+     * @param filepath Ruta del archivo .obj
+     * @param scale Escala aplicada a cada posicin
+     * @param translate Traslacin aplicada a cada posicin
+     * @param data Malla leda
+     * @param nodes Nodos del BVH de la malla ya transformados
+     * @param order Orden de primitivas del BVH
+     * @param from_cache true si los datos salieron de la cach
+     * @return false si el archivo no existe o est mal formado
+     */
+    static bool loadObjData(const std::string& filepath, const Vec3& scale, const Vec3& translate,
+        MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order, bool& from_cache);
+
+    /**
+     * @brief Interpreta el contenido de un .obj en una sola pasada, sin copiarlo
+     *
+     * Soporta v, vt, vn y caras con ndices p, p/t, p//n y p/t/n (incluidos ndices
+     * negativos relativos). Los polgonos se triangulan en abanico; el resto de las
+     * directivas se ignora.
+     *
+     * @param data Inicio del contenido
+     * @param size Tamao en bytes
+     * @param out Malla resultante, con las coordenadas tal como estn en el archivo
+     * @param source_name Nombre usado en los mensajes de error
+     * @return false si el archivo tiene caras mal formadas o ndices fuera de rango
+     */
+    static bool parseObj(const char* data, size_t size, MeshData& out, const std::string& source_name);
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+/**
+ * @file PartialImage.h
+ * @brief Acumulación parcial de un render, en memoria y en disco
+ *
+ * Guarda la suma de muestras RGB, la suma de cuadrados de la luminancia y la cantidad de
+ * muestras de cada bloque de la imagen. La usan los checkpoints de ProgressiveRenderer y
+ * el render distribuido: cada proceso renderiza un subconjunto de bloques o un rango de
+ * muestras de la misma escena, escribe su PartialImage, y merge() las suma. Como cada
+ * muestra se siembra con su bloque y su número de muestra, la imagen combinada es la
+ * misma que daría un único proceso.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Color.h"
+#include "Sampler.h"
+
+class PartialImage {
+public:
+	int width = 0;
+	int height = 0;
+	int tile_size = 0;
+	uint64_t scene_hash = 0;
+	int first_sample = 0;                 ///< Primera muestra del rango renderizado
+	int sample_count = 1;                 ///< Muestras del rango: [first_sample, first_sample + sample_count)
+	int subset_index = 0;                 ///< Subconjunto de bloques renderizado (índice % cantidad)
+	int subset_count = 1;
+	SamplerType sampler = SamplerType::Random;  ///< Patrón de muestreo de la cámara (las partes deben coincidir)
+	std::vector<int> tile_samples;        ///< Muestras acumuladas en cada bloque
+	std::vector<uint8_t> tile_converged;  ///< Bloques que el muestreo adaptativo dejó de refinar
+	std::vector<float> accumulation;      ///< Suma de muestras RGB por píxel
+	std::vector<float> luminance_squares; ///< Suma de cuadrados de la luminancia por píxel
+
+	/**
+	 * @brief Reserva los buffers (en cero) para una imagen dividida en bloques
+	 */
+	void reset(int width, int height, int tile_size);
+
+	int tilesX() const;
+	int tilesY() const;
+	size_t tileCount() const;
+
+	/**
+	 * @brief Escribe el archivo (a un temporal que luego se renombra)
+	 */
+	bool save(const std::string& path) const;
+
+	/**
+	 * @brief Lee un archivo escrito con save()
+	 * @return false si no existe, está incompleto o es de otra versión
+	 */
+	bool load(const std::string& path);
+
+	/**
+	 * @brief Suma otra acumulación de la misma escena, el mismo tamaño, el mismo patrón de
+	 * muestreo y la misma cantidad de subconjuntos de bloques
+	 *
+	 * No comprueba que las muestras sean distintas; eso lo hace merge().
+	 *
+	 * @return false si no son compatibles
+	 */
+	bool add(const PartialImage& other);
+
+	/**
+	 * @brief Imagen en espacio lineal: promedio de las muestras de cada píxel (negro si no tiene)
+	 */
+	std::vector<Color> resolve() const;
+
+	/**
+	 * @brief Guarda la imagen resuelta como PNG con la corrección de gamma del render en vivo
+	 */
+	bool saveImage(const std::string& path) const;
+
+	/**
+	 * @brief Combina varios archivos parciales en uno
+	 * @param paths Archivos de los procesos
+	 * @param result Acumulación combinada
+	 * @return false si falta alguno, no corresponden a la misma escena o dos partes repiten
+	 * muestras (el mismo subconjunto de bloques con rangos de muestras que se superponen)
+	 */
+	static bool merge(const std::vector<std::string>& paths, PartialImage& result);
+};
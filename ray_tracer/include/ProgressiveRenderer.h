@@ -0,0 +1,317 @@
+/**
+ * @file ProgressiveRenderer.h
+ * @brief Render progresivo por pasadas para la vista previa en vivo
+ *
+ * En lugar de completar cada fila con todas sus muestras, el render recorre la imagen
+ * entera con una muestra por píxel y repite la pasada hasta llegar a las muestras de la
+ * cámara, acumulando en un buffer de floats. Así la primera imagen completa aparece tras
+ * una sola pasada y se va limpiando de ruido mientras se sigue renderizando.
+ *
+ * La imagen se divide en bloques de 32x32 y varios hilos toman pares (bloque, pasada) de
+ * un contador atómico. Al terminar un bloque el hilo escribe sus píxeles ya resueltos en
+ * un buffer de palabras atómicas; el hilo de SDL llama a present() a la frecuencia que
+ * quiera y lee ese buffer sin locks, así que presentar nunca frena el trazado.
+ *
+ * Antes de la primera pasada se muestra una vista previa con píxeles grandes (una muestra
+ * por bloque de NxN). N se elige según lo que tardó el último render para que la vista
+ * previa esté en pantalla en unos pocos cuadros, lo que permite reiniciar el render con
+ * restart() cada vez que se mueve la cámara y ver el resultado enseguida.
+ *
+ * Para trabajos con límite de tiempo se puede fijar un presupuesto en segundos o un
+ * CancellationToken: al vencer (o al cancelarse) los hilos dejan de tomar bloques, pero
+ * siempre después de completar la primera pasada, así la imagen nunca queda con huecos.
+ * Con presupuesto las pasadas siguen hasta agotarlo en lugar de parar en las muestras de
+ * la cámara. El muestreo adaptativo deja de refinar los bloques cuyo error relativo
+ * estimado (a partir de la varianza de la luminancia) baja del umbral, y el tiempo se
+ * va a los bloques que siguen con ruido.
+ *
+ * Con setCheckpoint() un hilo aparte guarda cada cierto tiempo la acumulación, las
+ * muestras de cada bloque y el hash de la escena; resume() la recupera al arrancar de
+ * nuevo y el render sigue desde ahí. El generador aleatorio no necesita guardarse porque
+ * cada muestra se siembra con su bloque y su número de muestra.
+ *
+ * Con setCostMapEnabled() se mide además cuánto tarda cada muestra y se acumula por
+ * píxel; saveCostMap() guarda ese costo como imagen en falso color y como imagen de
+ * floats, para ver qué objetos se llevan el tiempo de render.
+ *
+ * Con setHDROutput() saveImage() guarda además la imagen lineal (sin gamma ni saturación)
+ * en PFM u OpenEXR.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <SDL.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Color.h"
+#include "HDRImage.h"
+
+class CancellationToken;
+class PartialImage;
+class Camera;
+class Scene;
+class WhittedTracer;
+
+class ProgressiveRenderer {
+public:
+	/**
+	 * @brief Prepara el render; no empieza a trazar hasta start()
+	 *
+	 * La escena, la cámara y el trazador deben vivir mientras dure el render.
+	 *
+	 * @param tracer Trazador de Whitted
+	 * @param scene Escena a renderizar
+	 * @param camera Cámara (define tamaño de la imagen y cantidad de pasadas)
+	 * @param threads Hilos de render (0 usa todos los núcleos)
+	 */
+	ProgressiveRenderer(const WhittedTracer& tracer, const Scene& scene, const Camera& camera, unsigned threads = 0);
+	~ProgressiveRenderer();
+
+	ProgressiveRenderer(const ProgressiveRenderer&) = delete;
+	ProgressiveRenderer& operator=(const ProgressiveRenderer&) = delete;
+
+	/**
+	 * @brief Limita el tiempo de render (medido desde start())
+	 * @param seconds Segundos disponibles; 0 renderiza hasta las muestras de la cámara
+	 */
+	void setTimeBudget(double seconds);
+
+	/**
+	 * @brief Asocia un token que permite terminar el render desde otro hilo
+	 * @param token Token a consultar (debe vivir mientras dure el render), o nullptr
+	 */
+	void setCancellationToken(const CancellationToken* token);
+
+	/**
+	 * @brief Activa el muestreo adaptativo
+	 * @param relative_error Error relativo por debajo del cual un bloque deja de refinarse (0 lo desactiva)
+	 */
+	void setAdaptiveThreshold(double relative_error);
+
+	/**
+	 * @brief Activa o desactiva la vista previa de píxeles grandes
+	 *
+	 * Sin ventana la vista previa sólo agrega trabajo; la imagen final no cambia.
+	 */
+	void setPreviewEnabled(bool enabled);
+
+	/**
+	 * @brief Activa los checkpoints periódicos
+	 *
+	 * Al terminar con todas las muestras el checkpoint se borra; si el render se corta por
+	 * presupuesto o cancelación se escribe uno final para continuar después.
+	 *
+	 * @param path Archivo del checkpoint
+	 * @param interval_seconds Segundos entre checkpoints
+	 */
+	void setCheckpoint(const std::string& path, double interval_seconds);
+
+	/**
+	 * @brief Hash de la escena que se guarda en checkpoints y partes; un checkpoint
+	 * de otra escena no se reanuda y partes de escenas distintas no se combinan
+	 */
+	void setSceneHash(uint64_t hash);
+
+	/**
+	 * @brief Hash que identifica la acumulación: el de la escena combinado con la vista y el
+	 * muestreo de la cámara (posición, orientación, tamaño y muestras por píxel)
+	 *
+	 * Se calcula con la cámara actual, así un checkpoint guardado después de mover la cámara
+	 * en modo interactivo no se reanuda sobre la vista original.
+	 */
+	uint64_t viewHash() const;
+
+	/**
+	 * @brief Renderiza sólo los bloques cuyo índice módulo count es index (render distribuido)
+	 */
+	void setTileSubset(int index, int count);
+
+	/**
+	 * @brief Renderiza las muestras [first, first + count) de cada píxel en lugar de las de la cámara
+	 *
+	 * Con count = 0 se usan las muestras de la cámara a partir de first.
+	 */
+	void setSampleRange(int first, int count);
+
+	/**
+	 * @brief Activa la medición del costo de cada píxel (ver saveCostMap)
+	 *
+	 * Agrega dos lecturas del reloj por muestra; debe llamarse antes de start().
+	 */
+	void setCostMapEnabled(bool enabled);
+
+	/**
+	 * @brief Formato de la imagen lineal que saveImage() guarda junto al PNG (HDRFormat::None para no guardarla)
+	 */
+	void setHDROutput(HDRFormat format);
+
+	/**
+	 * @brief Escribe la acumulación actual como PartialImage (checkpoint o parte de un render distribuido)
+	 */
+	bool savePartial(const std::string& path);
+
+	/**
+	 * @brief Recupera el checkpoint configurado, si existe y corresponde a esta escena y a esta parte
+	 *
+	 * Debe llamarse antes de start().
+	 *
+	 * @return true si se reanudó
+	 */
+	bool resume();
+
+	/**
+	 * @brief Lanza los hilos de render
+	 */
+	void start();
+
+	/**
+	 * @brief Espera a que el render termine (por muestras, presupuesto o cancelación)
+	 */
+	void wait();
+
+	/**
+	 * @brief Detiene el render, abandonando los bloques en curso, y espera a los hilos
+	 */
+	void stop();
+
+	/**
+	 * @brief Descarta lo acumulado y vuelve a empezar, por ejemplo tras mover la cámara
+	 *
+	 * La imagen anterior sigue en pantalla hasta que la vista previa la reemplaza.
+	 */
+	void restart();
+
+	/**
+	 * @brief Sube la imagen acumulada a la textura RGB24 y la presenta, si cambió desde la última llamada
+	 *
+	 * Debe llamarse desde el hilo que creó el renderer de SDL.
+	 */
+	void present(SDL_Renderer* renderer, SDL_Texture* texture);
+
+	/**
+	 * @brief Copia la imagen actual (ya con corrección de gamma) como RGB24 por filas
+	 *
+	 * Lee el buffer de presentación, así que puede llamarse desde cualquier hilo mientras se renderiza.
+	 */
+	void copyDisplay(std::vector<uint8_t>& rgb) const;
+
+	/**
+	 * @brief Guarda la imagen actual en images/render_<fecha>.png y, si se pidió, la imagen
+	 * lineal en images/render_<fecha>.pfm o .exr
+	 *
+	 * Puede llamarse mientras se renderiza; cada bloque se copia con su lock.
+	 *
+	 * @return true si se pudo guardar
+	 */
+	bool saveImage() const;
+
+	/**
+	 * @brief Guarda el costo de render de cada píxel en images/cost_map_<fecha>.png (falso color)
+	 * y images/cost_map_<fecha>.pfm (nanosegundos por píxel, sumando todas sus muestras)
+	 *
+	 * Sólo cuenta las muestras trazadas en esta ejecución, no las recuperadas de un checkpoint.
+	 * Debe llamarse con el render detenido.
+	 *
+	 * @return true si se guardaron ambas imágenes
+	 */
+	bool saveCostMap() const;
+
+	/**
+	 * @brief Imagen acumulada en espacio lineal (promedio de las muestras de cada píxel)
+	 *
+	 * Sólo debe llamarse con el render detenido, por ejemplo después de wait().
+	 */
+	std::vector<Color> getImage() const;
+
+	bool isFinished() const;
+	int getCompletedPasses() const;
+
+	/**
+	 * @brief Promedio de muestras por píxel acumuladas hasta ahora
+	 */
+	double getAverageSamples() const;
+
+private:
+	/**
+	 * @brief Región de la imagen que se acumula como una unidad
+	 */
+	struct Tile {
+		int x0, y0, x1, y1;
+		int samples = 0;      ///< Pasadas acumuladas en el bloque
+		int resumed_samples = 0; ///< Pasadas que ya traía el checkpoint (sus trabajos se saltean)
+		bool converged = false;  ///< El muestreo adaptativo dejó de refinarlo
+		mutable std::mutex mutex; ///< Evita que dos hilos acumulen el mismo bloque a la vez
+	};
+
+	void workerLoop();
+	bool shouldStop(uint64_t job, uint64_t first_pass_end) const;
+	double tileError(const Tile& tile) const;
+	void renderPreviewTile(Tile& tile);
+	bool renderTile(Tile& tile, uint64_t pass);
+	int choosePreviewPixelSize() const;
+	void resolveTile(const Tile& tile);
+	bool ownsTile(size_t index) const;
+	int plannedPasses() const;
+	void snapshot(PartialImage& partial) const;
+	void checkpointLoop();
+	void stopCheckpointThread();
+
+	const WhittedTracer& tracer;
+	const Scene& scene;
+	const Camera& camera;
+	int width;
+	int height;
+	int total_passes;                                   ///< Pasadas a acumular en el render actual
+	double time_budget;                                 ///< Segundos disponibles (0 = sin límite)
+	const CancellationToken* token;
+	double adaptive_threshold;                          ///< Error relativo de convergencia (0 = sin muestreo adaptativo)
+	unsigned thread_count;
+	int preview_pixel;                                  ///< Tamaño de píxel de la vista previa (1 = sin vista previa)
+	double seconds_per_ray;                             ///< Costo medido en el último render (0 si no hay medida)
+	HDRFormat hdr_format;                               ///< Imagen lineal que acompaña al PNG
+
+	std::vector<Tile> tiles;
+	std::vector<float> accumulation;                    ///< Suma de muestras RGB por píxel
+	std::vector<float> luminance_squares;               ///< Suma de cuadrados de la luminancia por píxel (para la varianza)
+	std::vector<float> pixel_cost;                      ///< Nanosegundos de trazado por píxel (vacío si no se mide)
+	std::unique_ptr<std::atomic<uint32_t>[]> display;   ///< Píxeles resueltos empaquetados como 0x00RRGGBB
+	std::vector<uint8_t> staging;                       ///< Copia RGB24 que sube present() (sólo la usa el hilo de SDL)
+
+	std::vector<std::thread> workers;
+	std::atomic<uint64_t> next_job;                     ///< Próximo par (pasada, bloque) a renderizar
+	std::atomic<uint64_t> jobs_done;                    ///< Bloques de pasadas completas terminados
+	std::atomic<uint64_t> traced_rays;
+	std::atomic<uint64_t> accumulated_samples;          ///< Muestras sumadas en accumulation (sin la vista previa)
+	std::atomic<size_t> converged_tiles;
+	std::atomic<bool> stopped_early;                    ///< Terminó por presupuesto o cancelación
+	std::atomic<bool> completed;                        ///< Terminó con todas sus pasadas
+	std::atomic<unsigned> active_workers;
+	std::atomic<bool> cancel;
+	std::atomic<bool> finished;
+	std::atomic<bool> dirty;                            ///< display cambió desde el último present()
+	std::chrono::steady_clock::time_point start_time;
+
+	int first_sample;                                   ///< Primera muestra del rango asignado
+	int sample_count;                                   ///< Muestras del rango (0 = las de la cámara)
+	int subset_index;                                   ///< Subconjunto de bloques asignado
+	int subset_count;
+	size_t owned_tiles;                                 ///< Bloques del subconjunto
+
+	std::string checkpoint_path;                        ///< Vacío si no hay checkpoints
+	uint64_t scene_hash;
+	double checkpoint_interval;
+	std::thread checkpoint_thread;
+	std::mutex checkpoint_mutex;                        ///< Protege checkpoint_stop
+	std::mutex checkpoint_write_mutex;                  ///< Serializa las escrituras del archivo
+	std::condition_variable checkpoint_wake;
+	bool checkpoint_stop;
+};
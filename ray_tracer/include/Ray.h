@@ -49,7 +49,40 @@ public:
 	 */
 	Vec3 pointAtParameter(double t) const;
 
+	/**
+	 * @brief Asigna los diferenciales del rayo
+	 *
+	 * Los diferenciales son los rayos desplazados un píxel en x y en y; permiten
+	 * estimar el área que cubre el píxel sobre la superficie intersectada.
+	 *
+	 * @param rx_origin Origen del rayo desplazado en x
+	 * @param rx_direction Dirección del rayo desplazado en x
+	 * @param ry_origin Origen del rayo desplazado en y
+	 * @param ry_direction Dirección del rayo desplazado en y
+	 */
+	void setDifferentials(const Vec3& rx_origin, const Vec3& rx_direction, const Vec3& ry_origin, const Vec3& ry_direction);
+
+	/**
+	 * @brief Indica si el rayo tiene diferenciales (sólo los rayos de cámara)
+	 */
+	bool hasDifferentials() const;
+
+	/**
+	 * @brief Intersecta los rayos desplazados con el plano tangente en un punto de impacto
+	 * @param point Punto de intersección del rayo principal
+	 * @param normal Normal de la superficie en ese punto
+	 * @param px Punto de impacto del rayo desplazado en x
+	 * @param py Punto de impacto del rayo desplazado en y
+	 * @return false si el rayo no tiene diferenciales o son paralelos al plano
+	 */
+	bool differentialPoints(const Vec3& point, const Vec3& normal, Vec3& px, Vec3& py) const;
+
 private:
 	Vec3 origin;      ///< Punto de origen del rayo
 	Vec3 direction;   ///< Vector de dirección del rayo
+	bool has_differentials = false;  ///< true si se asignaron los rayos desplazados
+	Vec3 rx_origin;      ///< Origen del rayo desplazado un píxel en x
+	Vec3 rx_direction;   ///< Dirección del rayo desplazado un píxel en x
+	Vec3 ry_origin;      ///< Origen del rayo desplazado un píxel en y
+	Vec3 ry_direction;   ///< Dirección del rayo desplazado un píxel en y
 };
\ No newline at end of file
@@ -0,0 +1,82 @@
+/**
+ * @file RenderServer.h
+ * @brief Servicio de render que mantiene escenas cargadas entre trabajos
+ *
+ * Cada ejecución normal paga el arranque, el parseo del XML, la decodificación de
+ * texturas y la construcción del BVH antes de trazar el primer rayo. El servicio escucha
+ * en un LocalServer y conserva las escenas ya cargadas (con sus texturas y estructuras
+ * de aceleración), así un nuevo render de la misma escena con otra cámara sólo cuesta
+ * el trazado. Si el archivo de la escena cambia se vuelve a cargar.
+ *
+ * Protocolo (texto por líneas, las imágenes van en binario a continuación del encabezado):
+ * - render scene=<ruta> [eye=x,y,z] [look_at=x,y,z] [up=x,y,z] [width=N] [spp=N]
+ *   [time_budget=segundos] [adaptive=error] [progress=milisegundos]
+ *   Con progress se envía cada tantos milisegundos "FRAME ancho alto muestras" seguido de
+ *   la imagen parcial; al terminar "DONE ancho alto muestras segundos" y la imagen final.
+ *   Las imágenes son RGB24 por filas, de arriba hacia abajo, con corrección de gamma.
+ * - stats: responde "STATS escenas=N aciertos=N cargas=N texturas=N"
+ * - shutdown: responde "BYE" y el servicio termina
+ * Ante cualquier error se responde "ERROR mensaje". Las rutas no pueden tener espacios.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+class Camera;
+class LocalConnection;
+class Scene;
+class WhittedTracer;
+
+class RenderServer {
+public:
+	RenderServer();
+	~RenderServer();
+
+	RenderServer(const RenderServer&) = delete;
+	RenderServer& operator=(const RenderServer&) = delete;
+
+	/**
+	 * @brief Atiende clientes, de a uno, hasta recibir shutdown
+	 * @param endpoint Nombre del pipe (Windows) o ruta del socket (POSIX)
+	 * @return false si no se pudo escuchar en el endpoint
+	 */
+	bool run(const std::string& endpoint);
+
+	/**
+	 * @brief Envía una solicitud a un servicio en ejecución (lado cliente)
+	 *
+	 * Para render guarda la imagen final como PNG en output_path; para las demás
+	 * solicitudes imprime la respuesta.
+	 *
+	 * @return true si el servicio respondió sin error
+	 */
+	static bool submit(const std::string& endpoint, const std::string& request, const std::string& output_path);
+
+private:
+	/**
+	 * @brief Escena cargada junto con la cámara y el trazador que define su archivo
+	 */
+	struct CachedScene {
+		uint64_t file_size = 0;
+		int64_t file_mtime = 0;
+		uint64_t last_use = 0;                  ///< Para descartar la menos usada
+		std::shared_ptr<Scene> scene;
+		std::unique_ptr<Camera> camera;
+		std::unique_ptr<WhittedTracer> tracer;
+	};
+
+	CachedScene* acquireScene(const std::string& path, bool& cache_hit);
+	bool handleConnection(LocalConnection& connection);
+	bool handleRender(LocalConnection& connection, const std::string& request);
+
+	std::map<std::string, CachedScene> scenes;
+	uint64_t use_clock;
+	uint64_t cache_hits;
+	uint64_t cache_loads;
+};
@@ -0,0 +1,161 @@
+/**
+ * @file RenderStats.h
+ * @brief Contadores de instrumentación del trazador, por hilo, sumados al final de un render
+ *
+ * Cuentan rayos por tipo, pruebas de intersección y aciertos por primitiva, visitas a
+ * nodos del BVH, pruebas de cajas, llamadas a transmissionAlong y la profundidad máxima
+ * de recursión alcanzada, para saber en qué se va el presupuesto de rayos de cada escena.
+ *
+ * Cada hilo escribe en su propio bloque de contadores, así contar no genera contención
+ * entre hilos: el dueño del bloque hace load + store relajados (sin instrucciones
+ * atómicas de lectura-modificación-escritura) y snapshot() suma los bloques de todos
+ * los hilos, incluidos los que ya terminaron.
+ *
+ * Compilando con ICG_RENDER_STATS=0 add() y recordMax() quedan vacías y el compilador elimina
+ * la instrumentación por completo; snapshot() devuelve ceros.
+ *
+ * Los contadores de las pruebas de intersección (primitivas, cajas y nodos del BVH) se
+ * cuentan con addKernel() y dependen además de ICG_KERNEL_STATS, que por defecto sólo está
+ * activo sin NDEBUG: así los builds de release, y con ellos --benchmark y --microbench,
+ * miden los kernels sin instrumentar. Para ver esos contadores en un build optimizado se
+ * compila con ICG_KERNEL_STATS=1.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#ifndef ICG_RENDER_STATS
+#define ICG_RENDER_STATS 1
+#endif
+
+#ifndef ICG_KERNEL_STATS
+#ifdef NDEBUG
+#define ICG_KERNEL_STATS 0
+#else
+#define ICG_KERNEL_STATS 1
+#endif
+#endif
+
+/**
+ * @brief Qué se cuenta
+ */
+enum class RenderCounter {
+	PrimaryRays,      ///< Rayos que salen de la cámara
+	SceneRays,        ///< Consultas de intersección más cercana (primarios, reflejados y refractados)
+	SceneHits,        ///< Consultas que encontraron una superficie
+	ReflectionRays,   ///< Rayos reflejados que trazan los materiales
+	RefractionRays,   ///< Rayos refractados que trazan los materiales
+	ShadowRays,       ///< Rayos de sombra (llamadas a Scene::transmissionAlong)
+	SphereTests,
+	SphereHits,
+	TriangleTests,
+	TriangleHits,
+	QuadTests,
+	QuadHits,
+	CylinderTests,
+	CylinderHits,
+	BVHNodeVisits,    ///< Nodos del BVH cuya caja intersectó el rayo
+	AABBTests,        ///< Pruebas rayo-caja (nodos del BVH y cajas de entidades)
+	MaxDepth,         ///< Mayor profundidad de recursión alcanzada (se toma el máximo, no la suma)
+	Count
+};
+
+/**
+ * @brief Valores de todos los contadores
+ */
+struct RenderCounters {
+	uint64_t values[static_cast<int>(RenderCounter::Count)] = {};
+
+	uint64_t operator[](RenderCounter counter) const { return values[static_cast<int>(counter)]; }
+};
+
+class RenderStats {
+public:
+	/**
+	 * @brief Suma n al contador en el bloque del hilo actual
+	 */
+	static void add(RenderCounter counter, uint64_t n = 1) {
+#if ICG_RENDER_STATS
+		std::atomic<uint64_t>& value = local().values[static_cast<int>(counter)];
+		value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+		(void)counter;
+		(void)n;
+#endif
+	}
+
+	/**
+	 * @brief Como add(), para los contadores dentro de las pruebas de intersección
+	 *
+	 * Sólo cuenta si se compiló con ICG_KERNEL_STATS.
+	 */
+	static void addKernel(RenderCounter counter) {
+#if ICG_RENDER_STATS && ICG_KERNEL_STATS
+		add(counter);
+#else
+		(void)counter;
+#endif
+	}
+
+	/**
+	 * @brief Lleva el contador del hilo actual al máximo entre su valor y value
+	 */
+	static void recordMax(RenderCounter counter, uint64_t value) {
+#if ICG_RENDER_STATS
+		std::atomic<uint64_t>& current_value = local().values[static_cast<int>(counter)];
+		if (value > current_value.load(std::memory_order_relaxed)) {
+			current_value.store(value, std::memory_order_relaxed);
+		}
+#else
+		(void)counter;
+		(void)value;
+#endif
+	}
+
+	/**
+	 * @brief Suma de los contadores de todos los hilos desde el último reset()
+	 *
+	 * Puede llamarse mientras se renderiza; el resultado es aproximado hasta que los hilos terminan.
+	 */
+	static RenderCounters snapshot();
+
+	/**
+	 * @brief Pone todos los contadores en cero; debe llamarse sin renders en curso
+	 */
+	static void reset();
+
+	/**
+	 * @brief Nombre del contador en el JSON (por ejemplo "primary_rays")
+	 */
+	static const char* name(RenderCounter counter);
+
+	/**
+	 * @brief Imprime un resumen legible: rayos por tipo, pruebas por primitiva y tasas de acierto
+	 */
+	static void print(std::ostream& os, const RenderCounters& counters);
+
+	/**
+	 * @brief Guarda los contadores como un objeto JSON
+	 */
+	static bool writeJSON(const std::string& path, const RenderCounters& counters);
+
+private:
+	struct Block {
+		std::atomic<uint64_t> values[static_cast<int>(RenderCounter::Count)];
+	};
+
+	static Block& registerThread();
+
+	static Block& local() {
+		return current ? *current : registerThread();
+	}
+
+	static thread_local Block* current;   ///< Bloque del hilo actual (nullptr hasta el primer add)
+	friend struct RenderStatsThreadBlock;
+};
@@ -0,0 +1,62 @@
+/**
+ * @file Sampler.h
+ * @brief Posiciones de las muestras dentro de cada píxel para el antialiasing
+ *
+ * Con dos números aleatorios independientes por muestra los puntos se amontonan y dejan
+ * huecos, y el error de los bordes baja como 1/sqrt(N). Las secuencias estratificadas y
+ * de baja discrepancia reparten las N muestras de cada píxel de forma pareja y llegan a
+ * la misma calidad con bastantes menos muestras.
+ *
+ * Cada muestra se identifica por el píxel y su número de muestra, así que una pasada
+ * progresiva, un render reanudado o una parte de un render distribuido toman siempre los
+ * mismos puntos. Cada píxel usa la secuencia aleatorizada con una semilla propia
+ * (scrambling), para que el error no forme el mismo patrón en todos los píxeles.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Patrón de muestreo del píxel
+ */
+enum class SamplerType {
+	Random,       ///< Dos valores uniformes independientes (el muestreo original)
+	Stratified,   ///< Multi-jittered correlacionado: estratos en una grilla y en cada eje (Kensler, 2013)
+	Halton,       ///< Secuencia de Halton en bases 2 y 3 con una rotación distinta por píxel
+	Sobol,        ///< Primeras dos dimensiones de Sobol con scrambling de Owen por hash (Burley, 2020)
+	BlueNoise     ///< Secuencia R2 desplazada con una máscara de ruido azul aproximado entre píxeles
+};
+
+class Sampler {
+public:
+	/**
+	 * @brief Interpreta "random", "stratified", "halton", "sobol" o "bluenoise"
+	 * @return false si el nombre no es un patrón conocido
+	 */
+	static bool parseType(const std::string& name, SamplerType& type);
+
+	/**
+	 * @brief Nombre del patrón, el mismo que acepta parseType
+	 */
+	static const char* name(SamplerType type);
+
+	/**
+	 * @brief Posición de una muestra dentro del píxel
+	 *
+	 * Random usa random_double(), así que depende de la semilla del hilo; los demás
+	 * patrones dependen sólo de sus parámetros.
+	 *
+	 * @param i Columna del píxel
+	 * @param j Fila del píxel
+	 * @param index Número de muestra del píxel
+	 * @param count Muestras por píxel previstas (define la grilla de Stratified; las
+	 * muestras que la superan empiezan otra grilla con otra permutación)
+	 * @param x Salida en [0, 1)
+	 * @param y Salida en [0, 1)
+	 */
+	static void sample(SamplerType type, int i, int j, uint64_t index, int count, double& x, double& y);
+};
@@ -0,0 +1,46 @@
+/**
+ * @file SceneBundle.h
+ * @brief Escena compilada (.icgscene): un único archivo binario listo para renderizar
+ *
+ * La compilación lee el XML una sola vez y guarda la cámara, los parámetros del tracer,
+ * la tabla de materiales, las entidades, las luces, los píxeles ya decodificados de cada
+ * textura y cada malla con su BVH construido. Al cargar, el archivo se mapea en memoria y
+ * la escena se arma sin parsear texto, decodificar imágenes ni construir BVHs.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <string>
+#include <memory>
+#include "Scene.h"
+#include "Camera.h"
+#include "WhittedTracer.h"
+
+class SceneBundle {
+public:
+	/**
+	 * @brief Compila una escena XML en un bundle binario
+	 * @param xml_path Ruta del XML de origen
+	 * @param bundle_path Ruta del bundle a escribir
+	 * @return true si el bundle se escribió correctamente
+	 */
+	static bool compile(const std::string& xml_path, const std::string& bundle_path);
+
+	/**
+	 * @brief Carga una escena desde un bundle compilado
+	 * @param bundle_path Ruta del bundle
+	 * @param out_camera Cámara construida
+	 * @param out_tracer Trazador construido
+	 * @return Escena construida, o nullptr si el bundle no existe o es inválido
+	 */
+	static std::shared_ptr<Scene> load(const std::string& bundle_path,
+		std::unique_ptr<Camera>& out_camera,
+		std::unique_ptr<WhittedTracer>& out_tracer);
+
+	/**
+	 * @brief Indica si la ruta corresponde a un bundle (extensión .icgscene)
+	 */
+	static bool isBundle(const std::string& path);
+};
@@ -2,9 +2,71 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include "Scene.h"
 #include "Camera.h"
 #include "WhittedTracer.h"
+#include "Texture.h"
+#include "Mesh.h"
+
+/**
+ * @brief Escena tal como se lee del XML, antes de construir materiales y entidades
+ *
+ * Separar la lectura de la construccin permite guardar la escena ya interpretada
+ * (ver SceneBundle) y reconstruirla luego sin volver a leer el XML.
+ */
+struct SceneDescription {
+    enum class MaterialType { Lambertian, Mirror, Glass, Textured, NormalMapped };
+    enum class EntityType { Sphere, Cylinder, Quad, Mesh };
+
+    struct MaterialDesc {
+        MaterialType type = MaterialType::Lambertian;
+        Color ambient, diffuse, specular, albedo;
+        double shininess = 0.0;
+        double ior = 1.0;
+        int texture = -1;           ///< ndice en textures (textured: color, normalmapped: normal map)
+    };
+
+    struct EntityDesc {
+        EntityType type = EntityType::Sphere;
+        Vec3 center, min, max;
+        double radius = 0.0, y0 = 0.0, y1 = 0.0, value = 0.0;
+        int axis = 0;
+        int material = -1;          ///< ndice en materials, -1 si no tiene
+        int mesh = -1;              ///< ndice en meshes (slo EntityType::Mesh)
+    };
+
+    struct TextureDesc {
+        std::string path;
+        TextureFormat format = TextureFormat::RGBA8;   ///< Atributo format del XML; los normal maps usan TextureFormat::Normal
+        TextureLayout layout = TextureLayout::Linear;  ///< Atributo layout del XML
+        bool paged = false;                            ///< Atributo paged del XML: bloques ledos bajo demanda
+    };
+
+    struct MeshDesc {
+        std::string path;
+        Vec3 scale = Vec3(1, 1, 1);
+        Vec3 translate;
+    };
+
+    struct LightDesc {
+        Vec3 position;
+        Color intensity;
+    };
+
+    double aspect = -1.0;
+    int width = -1;
+    int samples = -1;
+    Vec3 eye, look_at, up;
+    int max_depth = -1;
+    double bias = -1.0;
+
+    std::vector<TextureDesc> textures;
+    std::vector<MaterialDesc> materials;
+    std::vector<MeshDesc> meshes;
+    std::vector<EntityDesc> entities;
+    std::vector<LightDesc> lights;
+};
 
 class SceneLoader {
 public:
@@ -20,4 +82,34 @@ public:
         std::unique_ptr<Camera>& out_camera,
         std::unique_ptr<WhittedTracer>& out_tracer
     );
-};
+
+    /**
+     * @brief Lee un archivo XML de escena sin construir ningn objeto
+     * @param filename Nombre del archivo XML a leer
+     * @param out Descripcin resultante
+     * @return false si el archivo no existe o le falta la cmara o el tracer
+     */
+    static bool parseXML(const std::string& filename, SceneDescription& out);
+
+    /**
+     * @brief Construye cmara, tracer, materiales, entidades y luces a partir de una descripcin
+     *
+     * Si textures o meshes estn vacos, las texturas y mallas se cargan desde sus rutas
+     * (las texturas a travs de TextureCache, as que cada imagen se decodifica una sola vez);
+     * si no, se usan los datos ya cargados (en el mismo orden que la descripcin).
+     *
+     * @param desc Descripcin de la escena
+     * @param out_camera Cmara construida
+     * @param out_tracer Trazador construido
+     * @param textures Texturas ya decodificadas (opcional)
+     * @param meshes Mallas ya construidas (opcional)
+     * @return Escena construida
+     */
+    static std::shared_ptr<Scene> buildScene(
+        const SceneDescription& desc,
+        std::unique_ptr<Camera>& out_camera,
+        std::unique_ptr<WhittedTracer>& out_tracer,
+        const std::vector<std::shared_ptr<const Texture>>& textures = std::vector<std::shared_ptr<const Texture>>(),
+        const std::vector<std::shared_ptr<Mesh>>& meshes = std::vector<std::shared_ptr<Mesh>>()
+    );
+};
\ No newline at end of file
@@ -1,25 +1,119 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Color.h"
+#include "Vec3.h"
 
+/**
+ * @brief Formato en que se guardan los texels en memoria
+ */
+enum class TextureFormat {
+    RGBA8,      ///< 8 bits por canal, valores lineales (se decodifica con una tabla i/255)
+    SRGBA8,     ///< 8 bits por canal con curva sRGB (se decodifica a lineal con una tabla)
+    RGBAHalf,   ///< Punto flotante de 16 bits por canal, para imgenes HDR
+    Normal      ///< Normal en espacio tangente ya decodificada, empaquetada en 2 x 16 bits (octadrica)
+};
 
+/**
+ * @brief Orden de los texels en memoria
+ *
+ * Los accesos vecinos en (u,v) caen en la misma lnea de cach con ms probabilidad
+ * en los rdenes por bloques que fila por fila. El orden no cambia el resultado del muestreo.
+ */
+enum class TextureLayout {
+    Linear,     ///< Fila por fila
+    Tiled,      ///< Bloques de 8x8 texels, cada bloque contiguo en memoria
+    Morton      ///< Curva Z (Morton) sobre dimensiones rellenadas a potencias de 2
+};
 
+/**
+ * @brief Textura con pirmide de mipmaps y filtrado bilineal/trilineal
+ *
+ * Al cargar se construyen todos los niveles (cada uno la mitad del anterior, promediando
+ * bloques de 2x2 en espacio lineal). El muestreo elige el nivel segn la huella del
+ * pxel en (u,v) y filtra entre los dos niveles ms cercanos.
+ *
+ * Una textura paginada no guarda los texels en memoria: la primera vez que se carga
+ * escribe junto a la imagen un archivo de bloques (<imagen>.<formato>.tiles) con la pirmide
+ * dividida en bloques de 64x64, y cada bloque se lee recin cuando un rayo lo muestrea,
+ * a travs de la cach LRU global TextureTileCache. Las cargas siguientes slo leen el
+ * encabezado de ese archivo, as que el render empieza sin decodificar la imagen.
+ */
 class Texture {
 public:
+    /**
+     * @brief Un nivel de la pirmide de mipmaps
+     */
+    struct MipLevel {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> texels; ///< Texels codificados segn el formato, ordenados segn el layout (filas de abajo hacia arriba)
+        int log2_width = 0;           ///< Exponente de la potencia de 2 que contiene el ancho (slo TextureLayout::Morton)
+        int log2_height = 0;          ///< Exponente de la potencia de 2 que contiene el alto (slo TextureLayout::Morton)
+    };
+
     Texture();  // Constructor vaco
-    Texture(const std::string& filepath); // Constructor que carga desde archivo
+    Texture(const std::string& filepath, TextureFormat format = TextureFormat::RGBA8, TextureLayout layout = TextureLayout::Linear, bool paged = false); // Constructor que carga desde archivo (paged: bloques bajo demanda, ignora layout)
+    Texture(int width, int height, const std::vector<Color>& pixels, TextureFormat format = TextureFormat::RGBA8, TextureLayout layout = TextureLayout::Linear); // Codifica pxeles ya decodificados (filas de abajo hacia arriba)
+    Texture(int width, int height, TextureFormat format, std::vector<uint32_t> texels); // Adopta texels ya codificados (fila por fila) en el formato dado y genera los mipmaps
+    Texture(TextureFormat format, TextureLayout layout, std::vector<MipLevel> levels); // Adopta una pirmide completa ya construida en el layout dado
 
     bool isLoaded() const;
-    Color sample(double u, double v) const; // Devuelve el color de la textura en (u, v)
+    bool isPaged() const;
+
+    /**
+     * @brief Devuelve el color de la textura en (u, v)
+     *
+     * Las derivadas son la variacin de (u,v) entre pxeles vecinos; con derivadas nulas
+     * se filtra bilinealmente el nivel 0 y si no, trilinealmente entre mipmaps.
+     */
+    Color sample(double u, double v, double dudx = 0.0, double dvdx = 0.0, double dudy = 0.0, double dvdy = 0.0) const;
+
+    /**
+     * @brief Devuelve la normal en espacio tangente en (u, v), con componentes en [-1, 1]
+     */
+    Vec3 sampleNormal(double u, double v, double dudx = 0.0, double dvdx = 0.0, double dudy = 0.0, double dvdy = 0.0) const;
+
+    int getWidth() const;
+    int getHeight() const;
+    TextureFormat getFormat() const;
+    TextureLayout getLayout() const;
+    Color texel(int x, int y, int level = 0) const; // Texel decodificado (y = 0 es la fila inferior)
+    const std::vector<uint32_t>& getTexels() const; // Texels codificados del nivel 0, en el orden del layout (vaco si es paginada)
+    int getLevelCount() const;
+    const MipLevel& getLevel(int level) const;
+    size_t memoryBytes() const; // Memoria de todos los niveles (cero si es paginada: sus bloques los cuenta TextureTileCache)
+
+    static size_t wordsPerTexel(TextureFormat format); // Palabras de 32 bits que ocupa cada texel
+    static const char* formatName(TextureFormat format);
+    static bool parseFormat(const std::string& name, TextureFormat& format); // Acepta "rgba8", "srgb8" y "half"
+    static const char* layoutName(TextureLayout layout);
+    static bool parseLayout(const std::string& name, TextureLayout& layout); // Acepta "linear", "tiled" y "morton"
 
 private:
-    int width = 0;
-    int height = 0;
-    std::vector<Color> data; // Imagen cargada
+    struct PagedSource;
+
+    TextureFormat format = TextureFormat::RGBA8;
+    TextureLayout layout = TextureLayout::Linear;
+    std::vector<MipLevel> levels; // levels[0] es la imagen original
     bool loaded = false;
+    std::shared_ptr<PagedSource> paged_source; // Archivo de bloques (slo texturas paginadas)
 
     void loadFromFile(const std::string& filepath);
+    void loadPaged(const std::string& filepath);
+    bool writeTileFile(const std::string& filepath, const std::string& tile_path) const;
+    bool openTileFile(const std::string& filepath, const std::string& tile_path);
+    void buildMipmaps();
+    void applyLayout();
+    size_t texelIndex(const MipLevel& level, int x, int y) const;
+    static size_t storageTexels(TextureLayout layout, const MipLevel& level);
+    double levelOfDetail(double dudx, double dvdx, double dudy, double dvdy) const;
+    const uint32_t* texelData(int level, int x, int y) const;
+    Vec3 fetch(int level, int x, int y) const;
+    Vec3 bilinear(int level, double u, double v) const;
+    Vec3 filtered(double u, double v, double dudx, double dvdx, double dudy, double dvdy) const;
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+/**
+ * @file TextureCache.h
+ * @brief Caché compartida de texturas indexada por ruta y opciones de carga
+ *
+ * Cada imagen se decodifica una sola vez aunque la referencien varios materiales o
+ * varias escenas; los materiales guardan un puntero compartido a la textura en lugar
+ * de una copia. Las entradas permanecen en la caché hasta que se llama a
+ * releaseUnused() o clear().
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "Texture.h"
+
+class TextureCache {
+public:
+	/**
+	 * @brief Instancia única de la caché
+	 */
+	static TextureCache& getInstance();
+
+	/**
+	 * @brief Devuelve la textura de la ruta dada, cargándola si no está en la caché
+	 *
+	 * Si la carga falla se devuelve igualmente una textura no cargada (que muestrea en
+	 * magenta) y no se guarda, para reintentar en la próxima escena.
+	 *
+	 * @param path Ruta de la imagen
+	 * @param format Formato en que se guardan los texels
+	 * @param layout Orden de los texels en memoria
+	 * @param paged true para leer los bloques bajo demanda (ver Texture)
+	 * @return Textura compartida (nunca nullptr)
+	 */
+	std::shared_ptr<const Texture> get(const std::string& path, TextureFormat format = TextureFormat::RGBA8,
+		TextureLayout layout = TextureLayout::Linear, bool paged = false);
+
+	/**
+	 * @brief Registra una textura ya decodificada (por ejemplo, leída de un SceneBundle)
+	 *
+	 * Si la ruta ya estaba en la caché con las mismas opciones se conserva la existente
+	 * y se descarta la nueva.
+	 *
+	 * @param path Ruta con la que se indexa la textura
+	 * @param texture Textura decodificada
+	 * @return Textura compartida asociada a la ruta
+	 */
+	std::shared_ptr<const Texture> insert(const std::string& path, Texture texture);
+
+	/**
+	 * @brief Libera las texturas que sólo están referenciadas por la caché
+	 * @return Cantidad de texturas liberadas
+	 */
+	size_t releaseUnused();
+
+	/**
+	 * @brief Vacía la caché (los materiales existentes conservan sus texturas)
+	 */
+	void clear();
+
+	size_t size() const;
+	size_t memoryBytes() const;
+
+private:
+	TextureCache() = default;
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	static std::string cacheKey(const std::string& path, TextureFormat format, TextureLayout layout, bool paged);
+
+	mutable std::mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const Texture>> textures;  ///< Texturas por ruta normalizada y opciones
+};
@@ -0,0 +1,86 @@
+/**
+ * @file TextureTileCache.h
+ * @brief Caché LRU global de bloques de texturas paginadas
+ *
+ * Las texturas paginadas no guardan sus texels en memoria: cada bloque se lee del
+ * archivo de bloques la primera vez que un rayo lo muestrea y queda en esta caché,
+ * compartida por todas las texturas, hasta que el presupuesto de memoria obliga a
+ * descartar los bloques usados hace más tiempo.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+class TextureTileCache {
+public:
+	using Tile = std::vector<uint32_t>;
+
+	/**
+	 * @brief Instancia única de la caché
+	 */
+	static TextureTileCache& getInstance();
+
+	/**
+	 * @brief Devuelve un bloque, leyéndolo con load si no está en la caché
+	 *
+	 * La lectura se hace fuera del lock; si dos hilos piden el mismo bloque a la vez
+	 * ambos lo leen pero sólo se guarda uno.
+	 *
+	 * @param texture_id Identificador de la textura paginada
+	 * @param level Nivel de mipmap
+	 * @param tile Índice del bloque dentro del nivel
+	 * @param load Función que lee el bloque; devuelve false si falla
+	 * @return Bloque compartido, o nullptr si no se pudo leer
+	 */
+	std::shared_ptr<const Tile> get(uint64_t texture_id, int level, int tile, const std::function<bool(Tile&)>& load);
+
+	/**
+	 * @brief Descarta todos los bloques de una textura (al destruirla)
+	 */
+	void evictTexture(uint64_t texture_id);
+
+	/**
+	 * @brief Fija el presupuesto de memoria y descarta bloques si se excede
+	 * @param bytes Memoria máxima para bloques
+	 */
+	void setBudget(size_t bytes);
+	size_t getBudget() const;
+	size_t usedBytes() const;
+
+	/**
+	 * @brief Imprime aciertos, lecturas y descartes en el flujo dado
+	 */
+	void printStats(std::ostream& os) const;
+
+private:
+	struct Entry {
+		uint64_t key;
+		std::shared_ptr<const Tile> tile;
+	};
+
+	TextureTileCache() = default;
+	TextureTileCache(const TextureTileCache&) = delete;
+	TextureTileCache& operator=(const TextureTileCache&) = delete;
+
+	static uint64_t makeKey(uint64_t texture_id, int level, int tile);
+	void evictToBudget();
+
+	mutable std::mutex mutex;
+	std::list<Entry> lru;                                                 ///< Bloques del más reciente al más antiguo
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> entries;     ///< Bloques por clave
+	size_t budget = size_t(256) * 1024 * 1024;                            ///< Presupuesto de memoria en bytes
+	size_t used = 0;                                                      ///< Memoria ocupada por los bloques
+	uint64_t hits = 0;                                                    ///< Pedidos resueltos desde la caché
+	uint64_t misses = 0;                                                  ///< Bloques leídos del archivo
+	uint64_t evictions = 0;                                               ///< Bloques descartados por el presupuesto
+};
@@ -0,0 +1,97 @@
+/**
+ * @file Trace.h
+ * @brief Línea de tiempo de las fases del render en formato de eventos de Chrome
+ *
+ * Con Trace::start() cada TraceScope registra cuándo empezó y terminó su bloque y en qué
+ * hilo: carga de la escena, decodificación de texturas, lectura de OBJ, construcción de
+ * BVH, cada bloque de cada pasada del render, resolución (tonemapping) y guardado de
+ * imágenes. Trace::write() genera un JSON de eventos de Chrome que se abre en
+ * chrome://tracing o en https://ui.perfetto.dev con una fila por hilo, donde se ven los
+ * hilos ociosos, el desbalance entre hilos y las partes que corren en serie.
+ *
+ * Sin Trace::start() un TraceScope sólo lee un booleano atómico, así los marcadores
+ * pueden quedar en el código sin costo apreciable.
+ *
+ * @author Benjamin Montenegro
+ * @date 19/10/2026
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class Trace {
+public:
+	/**
+	 * @brief Empieza a registrar eventos; los tiempos se miden desde esta llamada
+	 */
+	static void start();
+
+	static bool isEnabled() {
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Nombre con el que aparece el hilo actual en la línea de tiempo
+	 */
+	static void setThreadName(const std::string& name);
+
+	/**
+	 * @brief Microsegundos desde start()
+	 */
+	static double now();
+
+	/**
+	 * @brief Registra un evento completo del hilo actual
+	 * @param args Contenido del objeto "args" del evento ya en JSON (vacío si no hay)
+	 */
+	static void record(const char* name, const char* category, double begin, double end, const std::string& args);
+
+	/**
+	 * @brief Guarda los eventos registrados hasta ahora como JSON de eventos de Chrome
+	 * @return true si se pudo escribir el archivo
+	 */
+	static bool write(const std::string& path);
+
+private:
+	static std::atomic<bool> enabled;
+};
+
+/**
+ * @brief Marca el bloque en el que vive como un evento de la línea de tiempo
+ *
+ * El nombre y la categoría deben ser literales (o vivir hasta el final del bloque).
+ */
+class TraceScope {
+public:
+	TraceScope(const char* name, const char* category)
+		: name(name), category(category), active(Trace::isEnabled()), begin(active ? Trace::now() : 0.0) {
+	}
+
+	~TraceScope() {
+		if (active) {
+			Trace::record(name, category, begin, Trace::now(), args);
+		}
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+	/**
+	 * @brief Agrega un argumento numérico al evento (por ejemplo el bloque y la pasada)
+	 */
+	void arg(const char* key, int64_t value);
+
+	/**
+	 * @brief Agrega un argumento de texto al evento (por ejemplo el archivo que se carga)
+	 */
+	void arg(const char* key, const std::string& value);
+
+private:
+	const char* name;
+	const char* category;
+	bool active;
+	double begin;
+	std::string args;    ///< Argumentos ya en JSON, separados por comas
+};
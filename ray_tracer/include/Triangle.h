@@ -23,9 +23,17 @@ public:
     std::shared_ptr<Material> getMaterial() const;
     void setMaterial(std::shared_ptr<Material> material) override;
 
+    // Normales por vértice (sombreado suave) y coordenadas de textura (u, v en x, y)
+    void setVertexNormals(const Vec3& a, const Vec3& b, const Vec3& c);
+    void setTexCoords(const Vec3& a, const Vec3& b, const Vec3& c);
+
 private:
     Vec3 v0, v1, v2;
     Vec3 normal;
+    Vec3 n0, n1, n2;
+    Vec3 uv0, uv1, uv2;
+    bool has_vertex_normals = false;
+    bool has_tex_coords = false;
     std::shared_ptr<Material> material_ptr;
     AABB box;
 };
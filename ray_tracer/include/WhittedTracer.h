@@ -5,6 +5,7 @@
 #include "Light.h"
 #include "Material.h"
 #include "Scene.h"
+#include "HDRImage.h"
 #include <SDL.h>
 #include <vector>
 #include <memory>
@@ -83,6 +84,13 @@ public:
 
     int getMaxDepth() const;
 
+    /**
+     * @brief Además de cada PNG de las imágenes en vivo guarda sus valores lineales sin
+     * saturar, con el mismo nombre y la extensión del formato
+     * @param format Formato de punto flotante (HDRFormat::None para sólo PNG)
+     */
+    void setHDROutput(HDRFormat format);
+
 
     Color traceComponent(const Ray& ray, const Scene& scene, ShadeComponent component) const;
 
@@ -115,9 +123,23 @@ public:
 
    void renderLive(const Scene& scene, Camera& camera, SDL_Renderer* renderer, SDL_Texture* texture);
 
+   /**
+    * @brief Renderiza en vivo las imágenes de componentes (difusa, especular, ambiente,
+    * reflexión y transmisión) y los mapas auxiliares, sin la imagen principal
+    *
+    * La imagen principal la genera ProgressiveRenderer cuando se usa la vista previa progresiva.
+    */
+   void renderComponentsLive(const Scene& scene, Camera& camera, SDL_Renderer* renderer, SDL_Texture* texture);
+
 private:
     int max_depth;      ///< Profundidad máxima de recursión
     double shadow_bias; ///< Offset para evitar self-shadowing
+    HDRFormat hdr_format; ///< Salida de punto flotante de las imágenes en vivo
+
+    /**
+     * @brief Guarda los valores lineales de una imagen en vivo junto a su PNG (si hay salida HDR)
+     */
+    void saveHDR(const std::string& png_path, const std::vector<Color>& pixels, int width, int height) const;
 
     /**
      * @brief Color de fondo cuando no hay intersección
@@ -1,4 +1,5 @@
 #include "AABB.h"
+#include "RenderStats.h"
 #include <algorithm>
 #include <cmath>
 
@@ -9,6 +10,9 @@ AABB::AABB(const Vec3& min_point, const Vec3& max_point)
 }
 
 bool AABB::hit(const Ray& r, const Interval& ray_t) const {
+    RenderStats::addKernel(RenderCounter::AABBTests);
+    double t_min = ray_t.getMin();
+    double t_max = ray_t.getMax();
     for (int axis = 0; axis < 3; ++axis) {
         double originComponent, directionComponent, minComponent, maxComponent;
         switch (axis) {
@@ -38,7 +42,9 @@ bool AABB::hit(const Ray& r, const Interval& ray_t) const {
         if (invD < 0.0) {
             std::swap(t0, t1);
         }
-        if (t1 < ray_t.getMin() || t0 > ray_t.getMax()) {
+        t_min = std::fmax(t0, t_min);
+        t_max = std::fmin(t1, t_max);
+        if (t_max < t_min) {
             return false;
         }
     }
@@ -68,6 +74,17 @@ void AABB::expandToInclude(const AABB& other) {
         std::fmax(maximum.getZ(), other.maximum.getZ()));
 }
 
+double AABB::surfaceArea() const
+{
+    Vec3 d = maximum - minimum;
+    return 2.0 * (d.getX() * d.getY() + d.getY() * d.getZ() + d.getZ() * d.getX());
+}
+
+Vec3 AABB::centroid() const
+{
+    return 0.5 * (minimum + maximum);
+}
+
 Vec3 AABB::getMin() const
 {
     return minimum;
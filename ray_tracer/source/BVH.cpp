@@ -0,0 +1,458 @@
+#include "BVH.h"
+#include "RenderStats.h"
+#include "Constants.h"
+#include "Trace.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <cmath>
+
+namespace {
+	const int BIN_COUNT = 16;                    ///< Cantidad de bins por eje
+	const int MAX_LEAF_SIZE = 8;                 ///< Máximo de primitivas antes de forzar una partición
+	const int MAX_DEPTH = 60;                    ///< Límite de profundidad (tamaño de la pila de recorrido)
+	const int PARALLEL_BIN_THRESHOLD = 1 << 16;  ///< Primitivas a partir de las cuales el binning se reparte entre hilos
+	const int PARALLEL_TASK_THRESHOLD = 4096;    ///< Primitivas a partir de las cuales un subárbol se construye en otra tarea
+	const double TRAVERSAL_COST = 1.0;           ///< Costo relativo de visitar un nodo interno
+	const double INTERSECTION_COST = 1.0;        ///< Costo relativo de intersectar un triángulo
+
+	double axisValue(const Vec3& v, int axis) {
+		switch (axis) {
+		case 0: return v.getX();
+		case 1: return v.getY();
+		default: return v.getZ();
+		}
+	}
+
+	AABB emptyBox() {
+		return AABB(Vec3(infinity, infinity, infinity), Vec3(-infinity, -infinity, -infinity));
+	}
+
+	void expandToPoint(AABB& box, const Vec3& p) {
+		box.expandToInclude(AABB(p, p));
+	}
+
+	struct Bin {
+		AABB box = emptyBox();
+		int count = 0;
+	};
+
+	/**
+	 * @brief Cajas de un rango de primitivas: la caja total y la de sus centroides
+	 */
+	struct RangeBounds {
+		AABB box = emptyBox();
+		AABB centroid_box = emptyBox();
+	};
+
+	/**
+	 * @brief Ejecuta fn(chunk_begin, chunk_end, chunk) sobre el rango dividido entre varios hilos
+	 */
+	template <typename Fn>
+	void parallelChunks(int begin, int end, int chunks, Fn fn) {
+		std::vector<std::future<void>> futures;
+		int n = end - begin;
+		for (int c = 1; c < chunks; ++c) {
+			int cb = begin + n * c / chunks;
+			int ce = begin + n * (c + 1) / chunks;
+			futures.push_back(std::async(std::launch::async, fn, cb, ce, c));
+		}
+		fn(begin, begin + n / chunks, 0);
+		for (auto& f : futures) {
+			f.get();
+		}
+	}
+}
+
+struct BVH::BuildNode {
+	AABB box;
+	std::unique_ptr<BuildNode> left;
+	std::unique_ptr<BuildNode> right;
+	int first_prim = 0;
+	int prim_count = 0;
+	int axis = 0;
+};
+
+BVH::BVH() : task_depth(0) {
+}
+
+void BVH::build(std::vector<std::shared_ptr<Triangle>> prims) {
+	TraceScope trace("BVH::build", "aceleracion");
+	trace.arg("triangulos", int64_t(prims.size()));
+	auto start = std::chrono::steady_clock::now();
+
+	nodes.clear();
+	stats = BVHStats();
+	stats.thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+	// Con T hilos, alcanza con lanzar tareas hasta una profundidad ~log2(T) más un margen
+	// para absorber particiones desbalanceadas.
+	task_depth = 2;
+	for (unsigned t = 1; t < stats.thread_count; t <<= 1) {
+		++task_depth;
+	}
+
+	int n = static_cast<int>(prims.size());
+	prim_boxes.resize(n);
+	prim_centroids.resize(n);
+	std::vector<int> order(n);
+
+	auto prepare = [&](int begin, int end, int) {
+		for (int i = begin; i < end; ++i) {
+			prim_boxes[i] = prims[i]->boundingBox();
+			prim_centroids[i] = prim_boxes[i].centroid();
+			order[i] = i;
+		}
+	};
+	if (n >= PARALLEL_BIN_THRESHOLD) {
+		parallelChunks(0, n, static_cast<int>(stats.thread_count), prepare);
+	}
+	else {
+		prepare(0, n, 0);
+	}
+
+	if (n > 0) {
+		std::unique_ptr<BuildNode> root = buildRange(order, 0, n, 0);
+		nodes.reserve(2 * n);
+		flatten(*root);
+	}
+
+	primitives.resize(n);
+	for (int i = 0; i < n; ++i) {
+		primitives[i] = std::move(prims[order[i]]);
+	}
+	prim_order = std::move(order);
+
+	prim_boxes.clear();
+	prim_boxes.shrink_to_fit();
+	prim_centroids.clear();
+	prim_centroids.shrink_to_fit();
+
+	auto end = std::chrono::steady_clock::now();
+	stats.build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+	computeStats();
+}
+
+bool BVH::assign(std::vector<std::shared_ptr<Triangle>> prims, std::vector<Node> prebuilt_nodes, const std::vector<int>& order) {
+	TraceScope trace("BVH::assign", "aceleracion");
+	trace.arg("triangulos", int64_t(prims.size()));
+	auto start = std::chrono::steady_clock::now();
+	int n = static_cast<int>(prims.size());
+	int node_count = static_cast<int>(prebuilt_nodes.size());
+	if (static_cast<int>(order.size()) != n || (n > 0) != (node_count > 0)) {
+		return false;
+	}
+	for (int i = 0; i < node_count; ++i) {
+		const Node& node = prebuilt_nodes[i];
+		bool valid = node.prim_count > 0
+			? node.first_prim >= 0 && node.first_prim + node.prim_count <= n
+			: node.right_child > i + 1 && node.right_child < node_count;
+		if (!valid || node.axis < 0 || node.axis > 2) {
+			return false;
+		}
+	}
+
+	std::vector<std::shared_ptr<Triangle>> sorted(n);
+	for (int i = 0; i < n; ++i) {
+		if (order[i] < 0 || order[i] >= n || !prims[order[i]]) {
+			return false;
+		}
+		sorted[i] = std::move(prims[order[i]]);
+	}
+
+	primitives = std::move(sorted);
+	nodes = std::move(prebuilt_nodes);
+	prim_order = order;
+	stats = BVHStats();
+	stats.thread_count = 1;
+	stats.build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	computeStats();
+	if (stats.max_depth > MAX_DEPTH) {
+		// El recorrido usa una pila fija de MAX_DEPTH niveles
+		primitives.clear();
+		nodes.clear();
+		prim_order.clear();
+		stats = BVHStats();
+		return false;
+	}
+	return true;
+}
+
+std::unique_ptr<BVH::BuildNode> BVH::buildRange(std::vector<int>& order, int begin, int end, int depth) {
+	std::unique_ptr<BuildNode> node(new BuildNode());
+	int n = end - begin;
+	bool parallel = n >= PARALLEL_BIN_THRESHOLD && depth < task_depth && stats.thread_count > 1;
+	int chunks = parallel ? static_cast<int>(stats.thread_count) : 1;
+
+	// Cajas del rango (total y de centroides)
+	std::vector<RangeBounds> partial_bounds(chunks);
+	auto bound = [&](int cb, int ce, int c) {
+		RangeBounds& rb = partial_bounds[c];
+		for (int i = cb; i < ce; ++i) {
+			rb.box.expandToInclude(prim_boxes[order[i]]);
+			expandToPoint(rb.centroid_box, prim_centroids[order[i]]);
+		}
+	};
+	if (parallel) {
+		parallelChunks(begin, end, chunks, bound);
+	}
+	else {
+		bound(begin, end, 0);
+	}
+	RangeBounds bounds;
+	for (const auto& rb : partial_bounds) {
+		bounds.box.expandToInclude(rb.box);
+		bounds.centroid_box.expandToInclude(rb.centroid_box);
+	}
+	node->box = bounds.box;
+
+	auto makeLeaf = [&]() {
+		node->first_prim = begin;
+		node->prim_count = n;
+		return std::move(node);
+	};
+
+	if (n == 1 || depth >= MAX_DEPTH) {
+		return makeLeaf();
+	}
+
+	// Eje de mayor extensión de los centroides
+	Vec3 extent = bounds.centroid_box.getMax() - bounds.centroid_box.getMin();
+	int axis = 0;
+	if (extent.getY() > axisValue(extent, axis)) axis = 1;
+	if (extent.getZ() > axisValue(extent, axis)) axis = 2;
+	double axis_min = axisValue(bounds.centroid_box.getMin(), axis);
+	double axis_extent = axisValue(extent, axis);
+	node->axis = axis;
+
+	if (axis_extent <= 1e-12) {
+		// Todos los centroides coinciden: no hay partición útil
+		return makeLeaf();
+	}
+
+	double bin_scale = BIN_COUNT / axis_extent;
+	auto binOf = [&](int prim) {
+		int b = static_cast<int>((axisValue(prim_centroids[prim], axis) - axis_min) * bin_scale);
+		return std::min(std::max(b, 0), BIN_COUNT - 1);
+	};
+
+	// Binning, repartido entre hilos en los niveles superiores
+	std::vector<std::array<Bin, BIN_COUNT>> partial_bins(chunks);
+	auto fill = [&](int cb, int ce, int c) {
+		std::array<Bin, BIN_COUNT>& bins = partial_bins[c];
+		for (int i = cb; i < ce; ++i) {
+			Bin& bin = bins[binOf(order[i])];
+			bin.box.expandToInclude(prim_boxes[order[i]]);
+			++bin.count;
+		}
+	};
+	if (parallel) {
+		parallelChunks(begin, end, chunks, fill);
+	}
+	else {
+		fill(begin, end, 0);
+	}
+	std::array<Bin, BIN_COUNT> bins;
+	for (const auto& part : partial_bins) {
+		for (int b = 0; b < BIN_COUNT; ++b) {
+			bins[b].box.expandToInclude(part[b].box);
+			bins[b].count += part[b].count;
+		}
+	}
+
+	// Barrido de ambos lados para evaluar el costo SAH de cada plano entre bins
+	double left_area[BIN_COUNT - 1];
+	int left_count[BIN_COUNT - 1];
+	AABB acc = emptyBox();
+	int count = 0;
+	for (int b = 0; b < BIN_COUNT - 1; ++b) {
+		acc.expandToInclude(bins[b].box);
+		count += bins[b].count;
+		left_count[b] = count;
+		left_area[b] = count > 0 ? acc.surfaceArea() : 0.0;
+	}
+
+	double parent_area = node->box.surfaceArea();
+	double best_cost = infinity;
+	int best_split = -1;
+	acc = emptyBox();
+	count = 0;
+	for (int b = BIN_COUNT - 1; b > 0; --b) {
+		acc.expandToInclude(bins[b].box);
+		count += bins[b].count;
+		int lc = left_count[b - 1];
+		if (lc == 0 || count == 0) continue;
+		double cost = TRAVERSAL_COST + INTERSECTION_COST *
+			(lc * left_area[b - 1] + count * acc.surfaceArea()) / parent_area;
+		if (cost < best_cost) {
+			best_cost = cost;
+			best_split = b - 1;
+		}
+	}
+
+	double leaf_cost = INTERSECTION_COST * n;
+	if (n <= MAX_LEAF_SIZE && (best_split < 0 || best_cost >= leaf_cost)) {
+		return makeLeaf();
+	}
+
+	int mid;
+	if (best_split >= 0) {
+		auto it = std::partition(order.begin() + begin, order.begin() + end,
+			[&](int prim) { return binOf(prim) <= best_split; });
+		mid = static_cast<int>(it - order.begin());
+	}
+	else {
+		mid = begin;
+	}
+	if (mid == begin || mid == end) {
+		// Partición degenerada: se cae a la mediana de los centroides
+		mid = begin + n / 2;
+		std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+			[&](int a, int b) { return axisValue(prim_centroids[a], axis) < axisValue(prim_centroids[b], axis); });
+	}
+
+	if (depth < task_depth && n >= PARALLEL_TASK_THRESHOLD && stats.thread_count > 1) {
+		auto left_task = std::async(std::launch::async,
+			[&]() { return buildRange(order, begin, mid, depth + 1); });
+		node->right = buildRange(order, mid, end, depth + 1);
+		node->left = left_task.get();
+	}
+	else {
+		node->left = buildRange(order, begin, mid, depth + 1);
+		node->right = buildRange(order, mid, end, depth + 1);
+	}
+	return node;
+}
+
+int BVH::flatten(const BuildNode& build_node) {
+	int index = static_cast<int>(nodes.size());
+	Node flat;
+	flat.box = build_node.box;
+	flat.right_child = -1;
+	flat.first_prim = build_node.first_prim;
+	flat.prim_count = build_node.prim_count;
+	flat.axis = build_node.axis;
+	nodes.push_back(flat);
+
+	if (!build_node.left) {
+		return index;
+	}
+	flatten(*build_node.left);
+	int right = flatten(*build_node.right);
+	nodes[index].right_child = right;
+	return index;
+}
+
+void BVH::computeStats() {
+	stats.node_count = nodes.size();
+	stats.primitive_count = primitives.size();
+	stats.leaf_count = 0;
+	stats.sah_cost = 0.0;
+	stats.leaf_size_histogram.clear();
+	stats.max_depth = 0;
+	if (nodes.empty()) return;
+
+	std::vector<std::pair<int, int>> pending = { { 0, 0 } };
+	while (!pending.empty()) {
+		int index = pending.back().first;
+		int depth = pending.back().second;
+		pending.pop_back();
+		stats.max_depth = std::max(stats.max_depth, depth);
+		if (nodes[index].prim_count == 0) {
+			pending.push_back({ index + 1, depth + 1 });
+			pending.push_back({ nodes[index].right_child, depth + 1 });
+		}
+	}
+
+	double root_area = nodes[0].box.surfaceArea();
+	for (const auto& node : nodes) {
+		double rel_area = root_area > 0.0 ? node.box.surfaceArea() / root_area : 1.0;
+		if (node.prim_count > 0) {
+			++stats.leaf_count;
+			stats.sah_cost += INTERSECTION_COST * node.prim_count * rel_area;
+			if (stats.leaf_size_histogram.size() <= static_cast<size_t>(node.prim_count)) {
+				stats.leaf_size_histogram.resize(node.prim_count + 1, 0);
+			}
+			++stats.leaf_size_histogram[node.prim_count];
+		}
+		else {
+			stats.sah_cost += TRAVERSAL_COST * rel_area;
+		}
+	}
+}
+
+bool BVH::hit(const Ray& r, Interval t, HitRecord& rec) const {
+	if (nodes.empty()) return false;
+
+	int stack[MAX_DEPTH + 2];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	bool hit_anything = false;
+	double closest_so_far = t.getMax();
+	HitRecord temp_rec;
+	const Vec3& dir = r.getDirection();
+
+	while (stack_size > 0) {
+		int index = stack[--stack_size];
+		const Node& node = nodes[index];
+		if (!node.box.hit(r, Interval(t.getMin(), closest_so_far))) continue;
+		RenderStats::addKernel(RenderCounter::BVHNodeVisits);
+
+		if (node.prim_count > 0) {
+			for (int i = node.first_prim; i < node.first_prim + node.prim_count; ++i) {
+				if (primitives[i]->hit(r, Interval(t.getMin(), closest_so_far), temp_rec)) {
+					hit_anything = true;
+					closest_so_far = temp_rec.t;
+					rec = temp_rec;
+				}
+			}
+		}
+		else if (axisValue(dir, node.axis) < 0.0) {
+			// Se apila primero el hijo lejano para visitar antes el cercano
+			stack[stack_size++] = index + 1;
+			stack[stack_size++] = node.right_child;
+		}
+		else {
+			stack[stack_size++] = node.right_child;
+			stack[stack_size++] = index + 1;
+		}
+	}
+	return hit_anything;
+}
+
+AABB BVH::boundingBox() const {
+	return nodes.empty() ? AABB() : nodes[0].box;
+}
+
+const std::vector<std::shared_ptr<Triangle>>& BVH::getPrimitives() const {
+	return primitives;
+}
+
+const std::vector<BVH::Node>& BVH::getNodes() const {
+	return nodes;
+}
+
+const std::vector<int>& BVH::getPrimitiveOrder() const {
+	return prim_order;
+}
+
+const BVHStats& BVH::getStats() const {
+	return stats;
+}
+
+void BVH::printStats(std::ostream& os) const {
+	os << "BVH: " << stats.primitive_count << " triangulos, " << stats.node_count << " nodos ("
+		<< stats.leaf_count << " hojas), profundidad maxima " << stats.max_depth << std::endl;
+	os << "  Construccion: " << stats.build_ms << " ms con " << stats.thread_count
+		<< " hilos, costo SAH: " << stats.sah_cost << std::endl;
+	os << "  Hojas por cantidad de primitivas:";
+	for (size_t i = 1; i < stats.leaf_size_histogram.size(); ++i) {
+		if (stats.leaf_size_histogram[i] > 0) {
+			os << " [" << i << "]=" << stats.leaf_size_histogram[i];
+		}
+	}
+	os << std::endl;
+}
@@ -0,0 +1,236 @@
+#include "Benchmark.h"
+#include "Camera.h"
+#include "ProgressiveRenderer.h"
+#include "RenderStats.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+#include "TextureCache.h"
+#include "WhittedTracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+	const char* const BENCHMARK_SCENES[] = { "XMLscene", "artisticStudio", "earthScene", "normalMapped", "planetaTierra" };
+	const char* const SCENE_DIRECTORY = "assets/scenes/";
+	const int BENCHMARK_WIDTH = 320;
+	const int BENCHMARK_SAMPLES = 4;
+	const int BENCHMARK_RUNS = 3;
+	const int JSON_VERSION = 2;   // 2: el pico de memoria es del proceso, no de cada escena
+
+	double perSecond(uint64_t count, double seconds) {
+		return seconds > 0.0 ? double(count) / seconds : 0.0;
+	}
+
+	// Busca "key": valor en una línea escrita por writeJSON
+	bool findField(const std::string& line, const std::string& key, std::string& value) {
+		std::string quoted = "\"" + key + "\":";
+		size_t start = line.find(quoted);
+		if (start == std::string::npos) return false;
+		start += quoted.size();
+		while (start < line.size() && line[start] == ' ') ++start;
+		if (start < line.size() && line[start] == '"') {
+			size_t end = line.find('"', start + 1);
+			if (end == std::string::npos) return false;
+			value = line.substr(start + 1, end - start - 1);
+			return true;
+		}
+		size_t end = line.find_first_of(",}", start);
+		value = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+		return true;
+	}
+
+	double numberField(const std::string& line, const std::string& key) {
+		std::string value;
+		return findField(line, key, value) ? std::atof(value.c_str()) : 0.0;
+	}
+
+	uint64_t countField(const std::string& line, const std::string& key) {
+		std::string value;
+		return findField(line, key, value) ? std::strtoull(value.c_str(), nullptr, 10) : 0;
+	}
+
+	bool benchmarkScene(const std::string& name, Benchmark::Result& result) {
+		std::string path = std::string(SCENE_DIRECTORY) + name + ".xml";
+		std::unique_ptr<Camera> scene_camera;
+		std::unique_ptr<WhittedTracer> tracer;
+		auto load_begin = std::chrono::steady_clock::now();
+		auto scene = SceneLoader::loadFromXML(path, scene_camera, tracer);
+		if (!scene || !scene_camera || !tracer) {
+			std::cerr << "Error al cargar la escena: " << path << std::endl;
+			return false;
+		}
+		result.load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - load_begin).count();
+
+		// Misma vista que la escena pero con tamaño y muestras fijos, así las escenas son comparables entre corridas
+		Camera camera(scene_camera->getEye(), scene_camera->getLookAt(), scene_camera->getUp(),
+			scene_camera->getAspectRatio(), BENCHMARK_WIDTH, BENCHMARK_SAMPLES);
+		result.scene = name;
+		result.width = camera.getImageWidth();
+		result.height = camera.getImageHeight();
+		result.samples = BENCHMARK_SAMPLES;
+
+		std::vector<double> times;
+		for (int run = 0; run < BENCHMARK_RUNS; ++run) {
+			RenderStats::reset();
+			ProgressiveRenderer renderer(*tracer, *scene, camera);
+			renderer.setPreviewEnabled(false);
+			auto begin = std::chrono::steady_clock::now();
+			renderer.start();
+			renderer.wait();
+			times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+			// Las semillas son fijas, así que los conteos son los mismos en todas las corridas
+			RenderCounters counters = RenderStats::snapshot();
+			result.primary_rays = counters[RenderCounter::PrimaryRays];
+			result.shadow_rays = counters[RenderCounter::ShadowRays];
+			result.total_rays = counters[RenderCounter::SceneRays] + result.shadow_rays;
+		}
+		std::sort(times.begin(), times.end());
+		result.best_seconds = times.front();
+		result.median_seconds = times[times.size() / 2];
+		return true;
+	}
+}
+
+int Benchmark::run(const std::string& output_path, const std::string& baseline_path, double tolerance_percent) {
+	unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<Result> results;
+	for (const char* name : BENCHMARK_SCENES) {
+		Result result;
+		if (!benchmarkScene(name, result)) return 1;
+		std::cout << "Benchmark " << name << ": " << result.best_seconds << " s, "
+			<< perSecond(result.total_rays, result.best_seconds) / 1e6 << " Mrayos/s" << std::endl;
+		results.push_back(result);
+		// La escena ya se liberó; sus texturas no deben contar en la memoria de la siguiente
+		TextureCache::getInstance().releaseUnused();
+	}
+
+	uint64_t peak_rss_bytes = peakResidentBytes();
+	std::cout << "Pico de memoria residente del proceso: " << peak_rss_bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+	if (!writeJSON(output_path, results, threads, peak_rss_bytes)) return 1;
+	std::cout << "Resultados guardados: " << output_path << std::endl;
+
+	if (baseline_path.empty()) return 0;
+	std::vector<Result> baseline;
+	if (!readJSON(baseline_path, baseline)) {
+		std::cerr << "No se pudo leer la línea base: " << baseline_path << std::endl;
+		return 1;
+	}
+	return compare(baseline, results, tolerance_percent) ? 0 : 1;
+}
+
+bool Benchmark::writeJSON(const std::string& path, const std::vector<Result>& results, unsigned threads, uint64_t peak_rss_bytes) {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		std::cerr << "No se pudo escribir: " << path << std::endl;
+		return false;
+	}
+	file << std::setprecision(9);
+	file << "{\n";
+	file << "  \"version\": " << JSON_VERSION << ",\n";
+	file << "  \"threads\": " << threads << ",\n";
+	file << "  \"runs\": " << BENCHMARK_RUNS << ",\n";
+	file << "  \"peak_rss_bytes\": " << peak_rss_bytes << ",\n";
+	file << "  \"scenes\": [\n";
+	for (size_t k = 0; k < results.size(); ++k) {
+		const Result& r = results[k];
+		file << "    {\"name\": \"" << r.scene << "\", \"width\": " << r.width << ", \"height\": " << r.height
+			<< ", \"samples\": " << r.samples << ", \"load_seconds\": " << r.load_seconds
+			<< ", \"wall_seconds\": " << r.best_seconds << ", \"wall_seconds_median\": " << r.median_seconds
+			<< ", \"primary_rays\": " << r.primary_rays << ", \"total_rays\": " << r.total_rays
+			<< ", \"shadow_rays\": " << r.shadow_rays
+			<< ", \"primary_rays_per_second\": " << perSecond(r.primary_rays, r.best_seconds)
+			<< ", \"total_rays_per_second\": " << perSecond(r.total_rays, r.best_seconds)
+			<< ", \"shadow_rays_per_second\": " << perSecond(r.shadow_rays, r.best_seconds) << "}"
+			<< (k + 1 < results.size() ? "," : "") << "\n";
+	}
+	file << "  ]\n";
+	file << "}\n";
+	return bool(file);
+}
+
+bool Benchmark::readJSON(const std::string& path, std::vector<Result>& results) {
+	std::ifstream file(path);
+	if (!file) return false;
+	results.clear();
+	std::string line;
+	while (std::getline(file, line)) {
+		Result r;
+		if (!findField(line, "name", r.scene)) continue;
+		r.width = int(numberField(line, "width"));
+		r.height = int(numberField(line, "height"));
+		r.samples = int(numberField(line, "samples"));
+		r.load_seconds = numberField(line, "load_seconds");
+		r.best_seconds = numberField(line, "wall_seconds");
+		r.median_seconds = numberField(line, "wall_seconds_median");
+		r.primary_rays = countField(line, "primary_rays");
+		r.total_rays = countField(line, "total_rays");
+		r.shadow_rays = countField(line, "shadow_rays");
+		results.push_back(r);
+	}
+	return !results.empty();
+}
+
+bool Benchmark::compare(const std::vector<Result>& baseline, const std::vector<Result>& current, double tolerance_percent) {
+	bool accepted = true;
+	std::cout << std::fixed << std::setprecision(3);
+	for (const Result& now : current) {
+		auto before = std::find_if(baseline.begin(), baseline.end(), [&](const Result& r) { return r.scene == now.scene; });
+		if (before == baseline.end()) {
+			std::cout << now.scene << ": sin línea base" << std::endl;
+			continue;
+		}
+		if (before->width != now.width || before->samples != now.samples) {
+			std::cout << now.scene << ": la línea base usa otra resolución o cantidad de muestras, no se compara" << std::endl;
+			continue;
+		}
+		// Positivo es más rápido que la línea base
+		double change = before->best_seconds > 0.0 ? (before->best_seconds / now.best_seconds - 1.0) * 100.0 : 0.0;
+		bool regressed = now.best_seconds > before->best_seconds * (1.0 + tolerance_percent / 100.0);
+		std::cout << now.scene << ": " << before->best_seconds << " s -> " << now.best_seconds << " s ("
+			<< std::showpos << change << std::noshowpos << "%)" << (regressed ? " REGRESIÓN" : "") << std::endl;
+		if (before->total_rays != now.total_rays) {
+			std::cout << "  los rayos trazados cambiaron: " << before->total_rays << " -> " << now.total_rays << std::endl;
+		}
+		accepted = accepted && !regressed;
+	}
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << std::setprecision(6);
+	std::cout << (accepted ? "Sin regresiones" : "Hay regresiones") << " (tolerancia " << tolerance_percent << "%)" << std::endl;
+	return accepted;
+}
+
+uint64_t Benchmark::peakResidentBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return uint64_t(counters.PeakWorkingSetSize);
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return uint64_t(usage.ru_maxrss);
+#else
+	// En Linux ru_maxrss está en KiB
+	return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
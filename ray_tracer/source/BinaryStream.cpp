@@ -0,0 +1,81 @@
+#include "BinaryStream.h"
+
+BinaryWriter::BinaryWriter(std::ostream& out) : out(out) {
+}
+
+void BinaryWriter::writeBytes(const void* data, size_t size) {
+	if (size > 0) {
+		out.write(static_cast<const char*>(data), size);
+	}
+}
+
+void BinaryWriter::writeString(const std::string& value) {
+	write(static_cast<uint32_t>(value.size()));
+	writeBytes(value.data(), value.size());
+}
+
+void BinaryWriter::writeVec3(const Vec3& value) {
+	double xyz[3] = { value.getX(), value.getY(), value.getZ() };
+	write(xyz);
+}
+
+void BinaryWriter::writeColor(const Color& value) {
+	double rgb[3] = { value.getR(), value.getG(), value.getB() };
+	write(rgb);
+}
+
+bool BinaryWriter::good() const {
+	return static_cast<bool>(out);
+}
+
+BinaryReader::BinaryReader(const char* data, size_t size) : cursor(data), left(size) {
+}
+
+bool BinaryReader::readBytes(void* dst, size_t size) {
+	if (size > left) {
+		return false;
+	}
+	if (size > 0) {
+		std::memcpy(dst, cursor, size);
+	}
+	cursor += size;
+	left -= size;
+	return true;
+}
+
+bool BinaryReader::readString(std::string& value) {
+	uint32_t size;
+	if (!read(size) || size > left) {
+		return false;
+	}
+	value.assign(cursor, size);
+	cursor += size;
+	left -= size;
+	return true;
+}
+
+bool BinaryReader::readVec3(Vec3& value) {
+	double xyz[3];
+	if (!read(xyz)) {
+		return false;
+	}
+	value = Vec3(xyz[0], xyz[1], xyz[2]);
+	return true;
+}
+
+bool BinaryReader::readColor(Color& value) {
+	double rgb[3];
+	if (!read(rgb)) {
+		return false;
+	}
+	value = Color(rgb[0], rgb[1], rgb[2]);
+	return true;
+}
+
+bool BinaryReader::canRead(uint64_t count, size_t element_size) const {
+	return element_size == 0 || count <= left / element_size;
+}
+
+size_t BinaryReader::remaining() const {
+	return left;
+}
@@ -21,10 +21,13 @@
 #include "Camera.h"
 #include "FreeImage.h"
 #include "Constants.h"
+#include "RenderStats.h"
 #include <iostream>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <Scene.h>
 #include <WhittedTracer.h>
@@ -61,6 +64,8 @@ void Camera::initialize() {
 	image_height = static_cast<int>(image_width / aspect_ratio);
 	image_height = image_height < 1 ? 1 : image_height;
 	pixel_sample_scale = 1.0 / static_cast<double>(samples_per_pixel);
+	// Con varias muestras por píxel cada una cubre una fracción del píxel
+	differential_scale = std::max(0.125, 1.0 / std::sqrt(static_cast<double>(samples_per_pixel)));
 
 	double focal_length = 1.0;
 	double viewport_height = 2.5;
@@ -83,6 +88,13 @@ void Camera::initialize() {
 	center = eye;
 }
 
+void Camera::setView(const Vec3& eye, const Vec3& lookAt, const Vec3& up) {
+	this->eye = eye;
+	this->lookAt = lookAt;
+	this->up = up;
+	initialize();
+}
+
 /**
  * @brief Renderiza la escena utilizando el algoritmo de ray tracing
  * 
@@ -109,7 +121,7 @@ void Camera::render(const Entity& world) const {
 			// Set the pixel color in the bitmap
 			Color pixel_color(0, 0, 0); // Initialize pixel color
 			for (int s = 0; s < samples_per_pixel; ++s) {
-				Ray r = getRandomRay(i, j);
+				Ray r = getRandomRay(i, j, s);
 				pixel_color += ray_color(r, world);
 			}
 			pixel_color = pixel_color * pixel_sample_scale; // Scale the color by the number of samples
@@ -144,8 +156,7 @@ std::string Camera::getTimestampedFilename() const {
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
 
-	// localtime_s(destination, source)
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return "images/output_error.png";
 	}
@@ -183,21 +194,25 @@ Color Camera::ray_color(const Ray& r, const Entity& world) const {
 /**
  * @brief Obtiene un rayo para un píxel específico con antialiasing
  * 
- * Genera un rayo desde el origen de la cámara hasta un punto aleatorio
+ * Genera un rayo desde el origen de la cámara hasta un punto
  * dentro del píxel especificado para crear el efecto de antialiasing
  * 
  * @param i Coordenada x del píxel en la imagen
  * @param j Coordenada y del píxel en la imagen
+ * @param sample Número de muestra del píxel
  * @return Rayo generado con origen en la cámara y dirección hacia el píxel
  */
-Ray Camera::getRandomRay(int i, int j) const {
-	Vec3 offset = this->sample_square();
+Ray Camera::getRandomRay(int i, int j, uint64_t sample) const {
+	Vec3 offset = this->sample_square(i, j, sample);
 
 	Vec3 pixel_sample = pixel00_loc + ((i + offset.getX()) * pixel_delta_u) + ((j + offset.getY()) * pixel_delta_v);
 	
 	Vec3 ray_origin = center;
 	Vec3 ray_direction = pixel_sample - ray_origin;
-	return Ray(ray_origin, ray_direction);
+	Ray r(ray_origin, ray_direction);
+	r.setDifferentials(ray_origin, ray_direction + differential_scale * pixel_delta_u,
+		ray_origin, ray_direction + differential_scale * pixel_delta_v);
+	return r;
 
 }
 
@@ -206,19 +221,23 @@ Ray Camera::getRay(int i, int j) const
 	auto pixel_center = pixel00_loc + (i * pixel_delta_u) + (j * pixel_delta_v);
 	auto ray_direction = pixel_center - center;
 	Vec3 ray_origin = center;
-	return Ray(ray_origin, ray_direction);
+	Ray r(ray_origin, ray_direction);
+	r.setDifferentials(ray_origin, ray_direction + pixel_delta_u, ray_origin, ray_direction + pixel_delta_v);
+	return r;
 }
 
 /**
- * @brief Genera un punto de muestreo aleatorio dentro de un cuadrado unitario
+ * @brief Genera un punto de muestreo dentro de un cuadrado unitario
  * 
- * Utilizado para antialiasing, genera un offset aleatorio dentro del píxel
- * para distribuir las muestras y suavizar los bordes
+ * Utilizado para antialiasing, genera un offset dentro del píxel con el patrón de
+ * la cámara para distribuir las muestras y suavizar los bordes
  * 
- * @return Vector con coordenadas aleatorias en el rango [-0.5, 0.5] para x e y, y 0 para z
+ * @return Vector con coordenadas en el rango [-0.5, 0.5] para x e y, y 0 para z
  */
-Vec3 Camera::sample_square() const{
-	return Vec3(random_double() - 0.5, random_double() - 0.5, 0.0);
+Vec3 Camera::sample_square(int i, int j, uint64_t sample) const{
+	double x, y;
+	Sampler::sample(sampler, i, j, sample, samples_per_pixel, x, y);
+	return Vec3(x - 0.5, y - 0.5, 0.0);
 }
 
 /**
@@ -245,15 +264,24 @@ int Camera::getSamplesPerPixel() const {
 	return samples_per_pixel;
 }
 
+/**
+ * @brief Obtiene la relación de aspecto de la imagen
+ * @return Ancho sobre alto
+ */
+double Camera::getAspectRatio() const {
+	return aspect_ratio;
+}
+
 void Camera::renderRow(int j, const Scene& scene, const WhittedTracer& tracer, std::vector<Color>& buffer) const {
 	for (int i = 0; i < image_width; ++i) {
 		Color pixel_color(0, 0, 0);
 		for (int s = 0; s < samples_per_pixel; ++s) {
-			Ray r = getRandomRay(i, j);
+			Ray r = getRandomRay(i, j, s);
 			pixel_color += tracer.trace(r, scene);
 		}
 		pixel_color = pixel_color * pixel_sample_scale;
 		buffer[j * image_width + i] = pixel_color;
 	}
+	RenderStats::add(RenderCounter::PrimaryRays, uint64_t(image_width) * samples_per_pixel);
 }
 
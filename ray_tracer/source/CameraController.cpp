@@ -0,0 +1,86 @@
+#include "CameraController.h"
+#include "Camera.h"
+#include <cmath>
+
+namespace {
+	const double KEY_ROTATION = 0.05;      ///< Radianes por pulsación de flecha
+	const double MOUSE_ROTATION = 0.005;   ///< Radianes por píxel arrastrado
+	const double MAX_PITCH_COS = 0.99;     ///< Límite para no quedar mirando paralelo a up
+
+	// Rota v alrededor del eje unitario k (fórmula de Rodrigues)
+	Vec3 rotateAround(const Vec3& v, const Vec3& k, double angle) {
+		double c = std::cos(angle);
+		double s = std::sin(angle);
+		return v * c + crossProduct(k, v) * s + k * (dotProduct(k, v) * (1.0 - c));
+	}
+}
+
+CameraController::CameraController(Camera& camera)
+	: eye(camera.getEye()), look_at(camera.getLookAt()), up(camera.getUp()), dragging(false) {
+	move_step = 0.05 * (look_at - eye).length();
+	if (move_step <= 0.0) {
+		move_step = 0.1;
+	}
+}
+
+bool CameraController::handleEvent(const SDL_Event& event) {
+	Vec3 forward = unitVector(look_at - eye);
+	Vec3 right = unitVector(crossProduct(forward, up));
+
+	switch (event.type) {
+	case SDL_KEYDOWN:
+		switch (event.key.keysym.sym) {
+		case SDLK_w: move(forward, move_step); return true;
+		case SDLK_s: move(forward, -move_step); return true;
+		case SDLK_d: move(right, move_step); return true;
+		case SDLK_a: move(right, -move_step); return true;
+		case SDLK_e: move(unitVector(up), move_step); return true;
+		case SDLK_q: move(unitVector(up), -move_step); return true;
+		case SDLK_LEFT: rotate(KEY_ROTATION, 0.0); return true;
+		case SDLK_RIGHT: rotate(-KEY_ROTATION, 0.0); return true;
+		case SDLK_UP: rotate(0.0, KEY_ROTATION); return true;
+		case SDLK_DOWN: rotate(0.0, -KEY_ROTATION); return true;
+		default: return false;
+		}
+	case SDL_MOUSEBUTTONDOWN:
+		if (event.button.button == SDL_BUTTON_LEFT) dragging = true;
+		return false;
+	case SDL_MOUSEBUTTONUP:
+		if (event.button.button == SDL_BUTTON_LEFT) dragging = false;
+		return false;
+	case SDL_MOUSEMOTION:
+		if (!dragging || (event.motion.xrel == 0 && event.motion.yrel == 0)) return false;
+		rotate(-event.motion.xrel * MOUSE_ROTATION, -event.motion.yrel * MOUSE_ROTATION);
+		return true;
+	case SDL_MOUSEWHEEL:
+		if (event.wheel.y == 0) return false;
+		move(forward, event.wheel.y * move_step);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void CameraController::apply(Camera& camera) const {
+	camera.setView(eye, look_at, up);
+}
+
+void CameraController::move(const Vec3& direction, double amount) {
+	// Se mueven juntos el ojo y el punto mirado, así la orientación no cambia
+	eye += direction * amount;
+	look_at += direction * amount;
+}
+
+void CameraController::rotate(double yaw, double pitch) {
+	Vec3 offset = look_at - eye;
+	double distance = offset.length();
+	Vec3 forward = offset / distance;
+	Vec3 axis_up = unitVector(up);
+
+	forward = rotateAround(forward, axis_up, yaw);
+	Vec3 pitched = rotateAround(forward, unitVector(crossProduct(forward, axis_up)), pitch);
+	if (std::fabs(dotProduct(pitched, axis_up)) < MAX_PITCH_COS) {
+		forward = pitched;
+	}
+	look_at = eye + forward * distance;
+}
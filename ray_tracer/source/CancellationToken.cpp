@@ -0,0 +1,16 @@
+#include "CancellationToken.h"
+
+CancellationToken::CancellationToken() : cancelled(false) {
+}
+
+void CancellationToken::cancel() {
+	cancelled.store(true, std::memory_order_release);
+}
+
+void CancellationToken::reset() {
+	cancelled.store(false, std::memory_order_release);
+}
+
+bool CancellationToken::isCancelled() const {
+	return cancelled.load(std::memory_order_acquire);
+}
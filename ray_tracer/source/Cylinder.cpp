@@ -1,9 +1,12 @@
 #include "Cylinder.h"
+#include "RenderStats.h"
+#include <cmath>
 
 Cylinder::Cylinder(const Vec3& center, double y0, double y1, double radius) : center(center), y0(y0), y1(y1), radius(radius) {}
 
 bool Cylinder::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const
 {
+    RenderStats::addKernel(RenderCounter::CylinderTests);
     Vec3 origin = ray.getOrigin() - center;
     Vec3 dir = ray.getDirection();
 
@@ -34,6 +37,7 @@ bool Cylinder::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const
         Vec3 outward_normal =unitVector(Vec3(point.getX() - center.getX(), 0, point.getZ() - center.getZ()));
         rec.setFaceNormal(ray, outward_normal);
         rec.material_ptr = material_ptr;
+        RenderStats::addKernel(RenderCounter::CylinderHits);
         return true;
     }
 
@@ -52,6 +56,7 @@ bool Cylinder::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const
         Vec3 normal = Vec3(0, (y == y1) ? 1 : -1, 0);
         rec.setFaceNormal(ray, normal);
         rec.material_ptr = material_ptr;
+        RenderStats::addKernel(RenderCounter::CylinderHits);
         return true;
     }
 
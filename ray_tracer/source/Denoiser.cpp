@@ -0,0 +1,248 @@
+#include "Denoiser.h"
+#include "Camera.h"
+#include "Constants.h"
+#include "HitRecord.h"
+#include "Interval.h"
+#include "Material.h"
+#include "Scene.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+	const float KERNEL[5] = { 1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f };  ///< B3-spline
+	const float ALBEDO_EPSILON = 0.01f;    ///< Albedo mínimo al dividir, para no amplificar el ruido de superficies casi negras
+	const float DEPTH_EPSILON = 1e-4f;
+	const uint64_t FEATURE_SEED = 0xA0A0A0A0ull;
+
+	/**
+	 * @brief Reparte las filas entre todos los núcleos; cada hilo toma la siguiente fila libre
+	 */
+	template <typename Body>
+	void parallelRows(int height, const Body& body) {
+		unsigned threads = std::min(unsigned(std::max(1, height)), std::max(1u, std::thread::hardware_concurrency()));
+		std::atomic<int> next_row(0);
+		auto worker = [&]() {
+			for (int y = next_row.fetch_add(1); y < height; y = next_row.fetch_add(1)) {
+				body(y);
+			}
+		};
+		std::vector<std::thread> workers;
+		for (unsigned t = 1; t < threads; ++t) {
+			workers.emplace_back(worker);
+		}
+		worker();
+		for (auto& w : workers) {
+			w.join();
+		}
+	}
+
+	float luminance(float r, float g, float b) {
+		return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+	}
+
+	/**
+	 * @brief Una pasada del filtro à-trous con separación step entre muestras
+	 */
+	void filterPass(const std::vector<float> (&input)[3], std::vector<float> (&output)[3], const Denoiser::Features& f,
+		int step, float sigma_color, const Denoiser::Settings& settings) {
+		const int width = f.width;
+		const int height = f.height;
+		// La luminancia en escala logarítmica hace que la tolerancia sea relativa al brillo
+		std::vector<float> log_luminance(size_t(width) * height);
+		for (size_t p = 0; p < log_luminance.size(); ++p) {
+			log_luminance[p] = std::log1p(std::max(0.0f, luminance(input[0][p], input[1][p], input[2][p])));
+		}
+		const float inv_color = 1.0f / (sigma_color * sigma_color);
+		const float inv_normal = 1.0f / (settings.sigma_normal * settings.sigma_normal);
+		const float inv_albedo = 1.0f / (settings.sigma_albedo * settings.sigma_albedo);
+		const float depth_scale = settings.sigma_depth * step;
+
+		parallelRows(height, [&](int y) {
+			std::vector<float> sum_w(width, 0.0f), sum_r(width, 0.0f), sum_g(width, 0.0f), sum_b(width, 0.0f);
+			const size_t row = size_t(y) * width;
+			for (int ky = -2; ky <= 2; ++ky) {
+				int yy = y + ky * step;
+				if (yy < 0 || yy >= height) continue;
+				for (int kx = -2; kx <= 2; ++kx) {
+					const int dx = kx * step;
+					const int x0 = std::max(0, -dx);
+					const int x1 = std::min(width, width - dx);
+					const float k = KERNEL[ky + 2] * KERNEL[kx + 2];
+					const size_t tap_row = size_t(yy) * width + dx;
+					// Bucle contiguo en x para una muestra fija del núcleo: sin saltos ni índices saturados
+					for (int x = x0; x < x1; ++x) {
+						const size_t p = row + x;
+						const size_t q = tap_row + x;
+						float dl = log_luminance[p] - log_luminance[q];
+						float dn0 = f.normal[0][p] - f.normal[0][q];
+						float dn1 = f.normal[1][p] - f.normal[1][q];
+						float dn2 = f.normal[2][p] - f.normal[2][q];
+						float da0 = f.albedo[0][p] - f.albedo[0][q];
+						float da1 = f.albedo[1][p] - f.albedo[1][q];
+						float da2 = f.albedo[2][p] - f.albedo[2][q];
+						float dd = std::abs(f.depth[p] - f.depth[q]) / (depth_scale * f.depth[p] + DEPTH_EPSILON);
+						float w = k * std::exp(-(dl * dl * inv_color
+							+ (dn0 * dn0 + dn1 * dn1 + dn2 * dn2) * inv_normal
+							+ (da0 * da0 + da1 * da1 + da2 * da2) * inv_albedo
+							+ dd));
+						sum_w[x] += w;
+						sum_r[x] += w * input[0][q];
+						sum_g[x] += w * input[1][q];
+						sum_b[x] += w * input[2][q];
+					}
+				}
+			}
+			// La muestra central siempre pesa, así que sum_w nunca es cero
+			for (int x = 0; x < width; ++x) {
+				float inv = 1.0f / sum_w[x];
+				output[0][row + x] = sum_r[x] * inv;
+				output[1][row + x] = sum_g[x] * inv;
+				output[2][row + x] = sum_b[x] * inv;
+			}
+		});
+	}
+
+	std::vector<Color> toColors(const std::vector<float> (&planes)[3]) {
+		std::vector<Color> colors(planes[0].size());
+		for (size_t p = 0; p < colors.size(); ++p) {
+			colors[p] = Color(planes[0][p], planes[1][p], planes[2][p]);
+		}
+		return colors;
+	}
+}
+
+Denoiser::Features Denoiser::gatherFeatures(const Scene& scene, const Camera& camera, int samples) {
+	TraceScope trace("Denoiser::gatherFeatures", "render");
+	Features f;
+	f.width = camera.getImageWidth();
+	f.height = camera.getImageHeight();
+	size_t pixels = size_t(f.width) * f.height;
+	for (int c = 0; c < 3; ++c) {
+		f.albedo[c].assign(pixels, 0.0f);
+		f.normal[c].assign(pixels, 0.0f);
+	}
+	f.depth.assign(pixels, 0.0f);
+	samples = std::max(1, samples);
+
+	parallelRows(f.height, [&](int j) {
+		seed_random(FEATURE_SEED + uint64_t(j));
+		for (int i = 0; i < f.width; ++i) {
+			double albedo[3] = { 0.0, 0.0, 0.0 };
+			double normal[3] = { 0.0, 0.0, 0.0 };
+			double depth = 0.0;
+			for (int s = 0; s < samples; ++s) {
+				Ray ray = camera.getRandomRay(i, j, s);
+				HitRecord rec;
+				if (!scene.hit(ray, Interval(0.001, infinity), rec)) continue;
+				Color a = rec.material_ptr ? rec.material_ptr->getAlbedo(rec) : Color(1, 1, 1);
+				albedo[0] += a.getR();
+				albedo[1] += a.getG();
+				albedo[2] += a.getB();
+				normal[0] += rec.normal.getX();
+				normal[1] += rec.normal.getY();
+				normal[2] += rec.normal.getZ();
+				depth += rec.t * ray.getDirection().length();
+			}
+			size_t p = size_t(j) * f.width + i;
+			for (int c = 0; c < 3; ++c) {
+				f.albedo[c][p] = float(albedo[c] / samples);
+				f.normal[c][p] = float(normal[c] / samples);
+			}
+			f.depth[p] = float(depth / samples);
+		}
+	});
+	return f;
+}
+
+std::vector<Color> Denoiser::denoise(const std::vector<Color>& image, const Features& features, const Settings& settings) {
+	TraceScope trace("Denoiser::denoise", "render");
+	size_t pixels = size_t(features.width) * features.height;
+	std::vector<float> current[3], next[3], albedo[3];
+	for (int c = 0; c < 3; ++c) {
+		current[c].resize(pixels);
+		next[c].resize(pixels);
+		albedo[c].resize(pixels);
+	}
+
+	// Se filtra la iluminación: la imagen dividida por el albedo (1 donde no hay superficie)
+	for (size_t p = 0; p < pixels; ++p) {
+		const Color& color = image[p];
+		double value[3] = { color.getR(), color.getG(), color.getB() };
+		bool has_surface = features.depth[p] > 0.0f;
+		for (int c = 0; c < 3; ++c) {
+			albedo[c][p] = has_surface ? std::max(ALBEDO_EPSILON, features.albedo[c][p]) : 1.0f;
+			current[c][p] = float(value[c]) / albedo[c][p];
+		}
+	}
+
+	for (int i = 0; i < settings.iterations; ++i) {
+		// Como en el artículo la tolerancia de color se achica en cada pasada: las pasadas
+		// anchas sólo mezclan valores que ya quedaron parecidos
+		filterPass(current, next, features, 1 << i, settings.sigma_color / float(1 << i), settings);
+		for (int c = 0; c < 3; ++c) {
+			current[c].swap(next[c]);
+		}
+	}
+
+	for (int c = 0; c < 3; ++c) {
+		for (size_t p = 0; p < pixels; ++p) {
+			current[c][p] *= albedo[c][p];
+		}
+	}
+	return toColors(current);
+}
+
+bool Denoiser::run(const std::vector<Color>& image, const Scene& scene, const Camera& camera, HDRFormat hdr_format) {
+	auto begin = std::chrono::steady_clock::now();
+	Features features = gatherFeatures(scene, camera, 4);
+	auto gathered = std::chrono::steady_clock::now();
+	std::vector<Color> result = denoise(image, features, Settings());
+	auto end = std::chrono::steady_clock::now();
+	std::cout << "Denoising: guías en " << std::chrono::duration<double, std::milli>(gathered - begin).count()
+		<< " ms, filtro en " << std::chrono::duration<double, std::milli>(end - gathered).count() << " ms" << std::endl;
+
+	std::time_t now = std::time(nullptr);
+	std::tm tm_info{};
+	if (!localTime(now, tm_info)) {
+		std::cerr << "Error al obtener la hora local.\n";
+		return false;
+	}
+	std::ostringstream oss;
+	oss << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S");
+	std::string stamp = oss.str();
+
+	std::string png_path = "images/denoised_" + stamp + ".png";
+	bool saved = HDRImage::savePNG(png_path, result, features.width, features.height);
+	if (saved) {
+		std::cout << "Imagen filtrada guardada: " << png_path << std::endl;
+	}
+	if (hdr_format == HDRFormat::None) return saved;
+
+	std::string extension = HDRImage::extension(hdr_format);
+	std::vector<Color> albedo = toColors(features.albedo);
+	std::vector<Color> normal = toColors(features.normal);
+	std::vector<Color> depth(result.size());
+	for (size_t p = 0; p < depth.size(); ++p) {
+		depth[p] = Color(features.depth[p], features.depth[p], features.depth[p]);
+	}
+	const std::vector<Color>* images[] = { &result, &albedo, &normal, &depth };
+	const char* const names[] = { "denoised_", "albedo_", "normal_", "depth_" };
+	for (int k = 0; k < 4; ++k) {
+		std::string path = std::string("images/") + names[k] + stamp + extension;
+		if (HDRImage::save(path, *images[k], features.width, features.height, hdr_format)) {
+			std::cout << "Imagen lineal guardada: " << path << std::endl;
+		}
+		else {
+			saved = false;
+		}
+	}
+	return saved;
+}
@@ -0,0 +1,73 @@
+#include "HDRImage.h"
+#include "FreeImage.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool HDRImage::parseFormat(const std::string& name, HDRFormat& format) {
+	if (name == "pfm") {
+		format = HDRFormat::PFM;
+		return true;
+	}
+	if (name == "exr") {
+		format = HDRFormat::EXR;
+		return true;
+	}
+	return false;
+}
+
+const char* HDRImage::extension(HDRFormat format) {
+	return format == HDRFormat::EXR ? ".exr" : ".pfm";
+}
+
+bool HDRImage::save(const std::string& path, const std::vector<Color>& pixels, int width, int height, HDRFormat format) {
+	if (format == HDRFormat::None) return false;
+	FIBITMAP* bitmap = FreeImage_AllocateT(FIT_RGBF, width, height);
+	if (!bitmap) {
+		std::cerr << "Error creando imagen de punto flotante.\n";
+		return false;
+	}
+	for (int j = 0; j < height; ++j) {
+		// FreeImage guarda las filas de abajo hacia arriba
+		FIRGBF* row = reinterpret_cast<FIRGBF*>(FreeImage_GetScanLine(bitmap, height - 1 - j));
+		for (int i = 0; i < width; ++i) {
+			const Color& c = pixels[size_t(j) * width + i];
+			row[i].red = float(c.getR());
+			row[i].green = float(c.getG());
+			row[i].blue = float(c.getB());
+		}
+	}
+	FREE_IMAGE_FORMAT file_format = format == HDRFormat::EXR ? FIF_EXR : FIF_PFM;
+	bool saved = FreeImage_Save(file_format, bitmap, path.c_str(), format == HDRFormat::EXR ? EXR_DEFAULT : 0) != 0;
+	if (!saved) {
+		std::cerr << "Error guardando la imagen: " << path << std::endl;
+	}
+	FreeImage_Unload(bitmap);
+	return saved;
+}
+
+bool HDRImage::savePNG(const std::string& path, const std::vector<Color>& pixels, int width, int height) {
+	FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+	if (!bitmap) {
+		std::cerr << "Error creando imagen.\n";
+		return false;
+	}
+	for (int j = 0; j < height; ++j) {
+		for (int i = 0; i < width; ++i) {
+			const Color& c = pixels[size_t(j) * width + i];
+			Color pixel(std::sqrt(std::max(0.0, c.getR())), std::sqrt(std::max(0.0, c.getG())), std::sqrt(std::max(0.0, c.getB())));
+			RGBQUAD color;
+			color.rgbRed = BYTE(pixel.getRbyte());
+			color.rgbGreen = BYTE(pixel.getGbyte());
+			color.rgbBlue = BYTE(pixel.getBbyte());
+			color.rgbReserved = 0;
+			FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+		}
+	}
+	bool saved = FreeImage_Save(FIF_PNG, bitmap, path.c_str(), 0) != 0;
+	if (!saved) {
+		std::cerr << "Error guardando la imagen: " << path << std::endl;
+	}
+	FreeImage_Unload(bitmap);
+	return saved;
+}
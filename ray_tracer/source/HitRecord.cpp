@@ -21,7 +21,7 @@
  * @param n Vector normal en el punto de intersección
  * @param t_val Parámetro t del rayo en el punto de intersección
  */
-HitRecord::HitRecord(const Vec3& p_val, const Vec3& n, double t_val): point(p_val), normal(n), t(t_val), u(0), v(0), frontFace(true) {}
+HitRecord::HitRecord(const Vec3& p_val, const Vec3& n, double t_val): point(p_val), normal(n), t(t_val), u(0), v(0), dudx(0), dvdx(0), dudy(0), dvdy(0), frontFace(true) {}
 
 /**
  * @brief Configura la normal de la cara según la dirección del rayo
@@ -0,0 +1,285 @@
+#include "ImageRegression.h"
+#include "Camera.h"
+#include "Constants.h"
+#include "FreeImage.h"
+#include "MappedFile.h"
+#include "PartialImage.h"
+#include "ProgressiveRenderer.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+#include "TextureCache.h"
+#include "WhittedTracer.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+	const char* const REGRESSION_SCENES[] = { "XMLscene", "artisticStudio", "earthScene", "normalMapped", "planetaTierra" };
+	const char* const SCENE_DIRECTORY = "assets/scenes/";
+	const int REGRESSION_WIDTH = 160;
+	const int REGRESSION_SAMPLES = 8;
+
+	// Umbrales de aceptación. Un cambio que sólo altera el redondeo mueve unos pocos píxeles
+	// en bordes y refracciones; uno que cambia la secuencia de muestras o la geometría baja
+	// el PSNR y el SSIM de toda la imagen
+	const double MIN_PSNR = 40.0;
+	const double MIN_SSIM = 0.98;
+	const double MAX_ERROR = 0.35;
+
+	const int SSIM_WINDOW = 8;
+	const int SSIM_STEP = 4;
+	const double DIFFERENCE_GAIN = 8.0;     ///< Amplificación de la imagen de diferencias
+
+	// Valor de un canal como se muestra: corrección de gamma (raíz cuadrada) y saturado en [0, 1]
+	double display(double value) {
+		return std::min(1.0, std::sqrt(std::max(0.0, value)));
+	}
+
+	double displayLuminance(const Color& c) {
+		return 0.2126 * display(c.getR()) + 0.7152 * display(c.getG()) + 0.0722 * display(c.getB());
+	}
+
+	bool savePNG(const std::string& path, int width, int height, const std::function<RGBQUAD(size_t)>& pixel) {
+		FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+		if (!bitmap) {
+			std::cerr << "Error creando imagen.\n";
+			return false;
+		}
+		for (int j = 0; j < height; ++j) {
+			for (int i = 0; i < width; ++i) {
+				RGBQUAD color = pixel(size_t(j) * width + i);
+				FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+			}
+		}
+		bool saved = FreeImage_Save(FIF_PNG, bitmap, path.c_str(), 0) != 0;
+		if (!saved) {
+			std::cerr << "Error guardando la imagen: " << path << std::endl;
+		}
+		FreeImage_Unload(bitmap);
+		return saved;
+	}
+
+	// Crea el directorio de las referencias si no existe, por ejemplo al apuntar a otro directorio
+	void createDirectory(const std::string& path) {
+#ifdef _WIN32
+		_mkdir(path.c_str());
+#else
+		mkdir(path.c_str(), 0755);
+#endif
+	}
+
+	BYTE toByte(double value) {
+		return BYTE(clamp(value, 0.0, 1.0) * 255.0 + 0.5);
+	}
+
+	/**
+	 * @brief Renderiza una escena con el tamaño y las muestras de la regresión
+	 * @param partial_path Si no está vacío guarda ahí la acumulación (para actualizar la referencia)
+	 * @param scene_hash Hash de la escena y la cámara con que se renderizó (ver ProgressiveRenderer::viewHash)
+	 */
+	bool renderScene(const std::string& name, const std::string& partial_path,
+		std::vector<Color>& image, int& width, int& height, uint64_t& scene_hash) {
+		std::string path = std::string(SCENE_DIRECTORY) + name + ".xml";
+		std::unique_ptr<Camera> scene_camera;
+		std::unique_ptr<WhittedTracer> tracer;
+		auto scene = SceneLoader::loadFromXML(path, scene_camera, tracer);
+		if (!scene || !scene_camera || !tracer) {
+			std::cerr << "Error al cargar la escena: " << path << std::endl;
+			return false;
+		}
+		if (!MappedFile::hashContents(path, scene_hash)) {
+			scene_hash = 0;
+		}
+
+		Camera camera(scene_camera->getEye(), scene_camera->getLookAt(), scene_camera->getUp(),
+			scene_camera->getAspectRatio(), REGRESSION_WIDTH, REGRESSION_SAMPLES);
+		width = camera.getImageWidth();
+		height = camera.getImageHeight();
+		ProgressiveRenderer renderer(*tracer, *scene, camera);
+		renderer.setPreviewEnabled(false);
+		renderer.setSceneHash(scene_hash);
+		renderer.start();
+		renderer.wait();
+		scene_hash = renderer.viewHash();
+		image = renderer.getImage();
+		return partial_path.empty() || renderer.savePartial(partial_path);
+	}
+}
+
+int ImageRegression::run(const std::string& golden_directory, bool update) {
+	int failures = 0;
+	if (update) {
+		createDirectory(golden_directory);
+	}
+	else {
+		// Sin referencias no hay nada contra qué comparar: se avisa en lugar de renderizar
+		// y se devuelve un código propio para no confundirlo con una regresión
+		int missing = 0;
+		for (const char* name : REGRESSION_SCENES) {
+			std::string golden_path = golden_directory + "/" + name + ".partial";
+			if (!std::ifstream(golden_path, std::ios::binary)) {
+				std::cout << name << ": no hay referencia en " << golden_path << std::endl;
+				++missing;
+			}
+		}
+		if (missing > 0) {
+			std::cout << "Faltan referencias: generarlas con --update-golden en un build enlazado con FreeImage" << std::endl;
+			return MISSING_REFERENCES;
+		}
+	}
+	std::cout << std::fixed << std::setprecision(4);
+	for (const char* name : REGRESSION_SCENES) {
+		std::string golden_path = golden_directory + "/" + name + ".partial";
+		std::vector<Color> image;
+		int width = 0, height = 0;
+		uint64_t scene_hash = 0;
+		if (!renderScene(name, update ? golden_path : std::string(), image, width, height, scene_hash)) {
+			std::cerr << name << ": no se pudo renderizar" << (update ? " o guardar la referencia" : "") << std::endl;
+			++failures;
+			continue;
+		}
+		TextureCache::getInstance().releaseUnused();
+
+		if (update) {
+			// Copia en PNG sólo para poder mirar la referencia; la comparación usa la acumulación
+			PartialImage golden;
+			if (golden.load(golden_path)) {
+				golden.saveImage(golden_directory + "/" + name + ".png");
+			}
+			std::cout << name << ": referencia actualizada (" << golden_path << ")" << std::endl;
+			continue;
+		}
+
+		PartialImage golden;
+		if (!golden.load(golden_path)) {
+			std::cout << name << ": FALLA, no hay referencia en " << golden_path << " (generarla con --update-golden)" << std::endl;
+			++failures;
+			continue;
+		}
+		if (golden.width != width || golden.height != height) {
+			std::cout << name << ": FALLA, la referencia es de " << golden.width << "x" << golden.height
+				<< " y el render de " << width << "x" << height << std::endl;
+			++failures;
+			continue;
+		}
+		if (golden.scene_hash != scene_hash) {
+			std::cout << name << ": la escena cambió desde que se generó la referencia" << std::endl;
+		}
+
+		std::vector<Color> reference = golden.resolve();
+		Metrics metrics = compare(reference, image, width, height);
+		bool passed = metrics.psnr >= MIN_PSNR && metrics.ssim >= MIN_SSIM && metrics.max_error <= MAX_ERROR;
+		std::cout << name << ": PSNR ";
+		if (std::isinf(metrics.psnr)) {
+			std::cout << "inf";
+		}
+		else {
+			std::cout << metrics.psnr;
+		}
+		std::cout << " dB, SSIM " << metrics.ssim << ", error máximo " << metrics.max_error
+			<< (passed ? " - OK" : " - FALLA") << std::endl;
+		if (!passed) {
+			++failures;
+			std::string prefix = std::string("images/regression_") + name;
+			savePNG(prefix + ".png", width, height, [&](size_t p) {
+				RGBQUAD color;
+				color.rgbRed = toByte(display(image[p].getR()));
+				color.rgbGreen = toByte(display(image[p].getG()));
+				color.rgbBlue = toByte(display(image[p].getB()));
+				color.rgbReserved = 0;
+				return color;
+			});
+			if (saveDifference(prefix + "_diff.png", reference, image, width, height)) {
+				std::cout << "  Imagen obtenida y diferencias guardadas: " << prefix << ".png, " << prefix << "_diff.png" << std::endl;
+			}
+		}
+	}
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << std::setprecision(6);
+
+	if (!update) {
+		std::cout << (failures == 0 ? "Sin diferencias fuera de tolerancia" : "Hay escenas que no pasan") << " (PSNR >= "
+			<< MIN_PSNR << " dB, SSIM >= " << MIN_SSIM << ", error máximo <= " << MAX_ERROR << ")" << std::endl;
+	}
+	return failures == 0 ? 0 : 1;
+}
+
+ImageRegression::Metrics ImageRegression::compare(const std::vector<Color>& reference, const std::vector<Color>& image, int width, int height) {
+	Metrics metrics;
+	size_t pixels = size_t(width) * height;
+	double squared_error = 0.0;
+	for (size_t p = 0; p < pixels; ++p) {
+		const Color& a = reference[p];
+		const Color& b = image[p];
+		double diffs[3] = {
+			display(a.getR()) - display(b.getR()),
+			display(a.getG()) - display(b.getG()),
+			display(a.getB()) - display(b.getB())
+		};
+		for (double d : diffs) {
+			squared_error += d * d;
+			metrics.max_error = std::max(metrics.max_error, std::abs(d));
+		}
+	}
+	double mse = pixels > 0 ? squared_error / (3.0 * pixels) : 0.0;
+	metrics.psnr = mse > 0.0 ? 10.0 * std::log10(1.0 / mse) : std::numeric_limits<double>::infinity();
+
+	// SSIM de la luminancia en ventanas de 8x8 que se solapan a la mitad (Wang et al., 2004)
+	const double c1 = 0.01 * 0.01;
+	const double c2 = 0.03 * 0.03;
+	std::vector<double> la(pixels), lb(pixels);
+	for (size_t p = 0; p < pixels; ++p) {
+		la[p] = displayLuminance(reference[p]);
+		lb[p] = displayLuminance(image[p]);
+	}
+	double ssim_sum = 0.0;
+	int windows = 0;
+	const double n = double(SSIM_WINDOW) * SSIM_WINDOW;
+	for (int y0 = 0; y0 + SSIM_WINDOW <= height; y0 += SSIM_STEP) {
+		for (int x0 = 0; x0 + SSIM_WINDOW <= width; x0 += SSIM_STEP) {
+			double sa = 0.0, sb = 0.0, saa = 0.0, sbb = 0.0, sab = 0.0;
+			for (int j = y0; j < y0 + SSIM_WINDOW; ++j) {
+				for (int i = x0; i < x0 + SSIM_WINDOW; ++i) {
+					double va = la[size_t(j) * width + i];
+					double vb = lb[size_t(j) * width + i];
+					sa += va;
+					sb += vb;
+					saa += va * va;
+					sbb += vb * vb;
+					sab += va * vb;
+				}
+			}
+			double ma = sa / n, mb = sb / n;
+			double var_a = saa / n - ma * ma;
+			double var_b = sbb / n - mb * mb;
+			double cov = sab / n - ma * mb;
+			ssim_sum += ((2.0 * ma * mb + c1) * (2.0 * cov + c2)) / ((ma * ma + mb * mb + c1) * (var_a + var_b + c2));
+			++windows;
+		}
+	}
+	metrics.ssim = windows > 0 ? ssim_sum / windows : 1.0;
+	return metrics;
+}
+
+bool ImageRegression::saveDifference(const std::string& path, const std::vector<Color>& reference,
+	const std::vector<Color>& image, int width, int height) {
+	return savePNG(path, width, height, [&](size_t p) {
+		RGBQUAD color;
+		color.rgbRed = toByte(std::abs(display(reference[p].getR()) - display(image[p].getR())) * DIFFERENCE_GAIN);
+		color.rgbGreen = toByte(std::abs(display(reference[p].getG()) - display(image[p].getG())) * DIFFERENCE_GAIN);
+		color.rgbBlue = toByte(std::abs(display(reference[p].getB()) - display(image[p].getB())) * DIFFERENCE_GAIN);
+		color.rgbReserved = 0;
+		return color;
+	});
+}
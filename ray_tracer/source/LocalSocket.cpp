@@ -0,0 +1,314 @@
+#include "LocalSocket.h"
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+	const size_t PIPE_BUFFER_SIZE = 1 << 16;
+
+#ifdef _WIN32
+	// Los named pipes viven en \\.\pipe\; se acepta el nombre solo o la ruta completa
+	std::string pipePath(const std::string& endpoint) {
+		return endpoint.compare(0, 2, "\\\\") == 0 ? endpoint : "\\\\.\\pipe\\" + endpoint;
+	}
+#else
+	bool socketAddress(const std::string& endpoint, sockaddr_un& address) {
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (endpoint.empty() || endpoint.size() >= sizeof(address.sun_path)) return false;
+		std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+		return true;
+	}
+#endif
+}
+
+#ifdef _WIN32
+
+LocalConnection::LocalConnection()
+	: handle(INVALID_HANDLE_VALUE), server_side(false) {
+}
+
+LocalConnection::LocalConnection(LocalConnection&& other)
+	: buffered(std::move(other.buffered)), handle(other.handle), server_side(other.server_side) {
+	other.handle = INVALID_HANDLE_VALUE;
+}
+
+LocalConnection& LocalConnection::operator=(LocalConnection&& other) {
+	if (this != &other) {
+		close();
+		buffered = std::move(other.buffered);
+		handle = other.handle;
+		server_side = other.server_side;
+		other.handle = INVALID_HANDLE_VALUE;
+	}
+	return *this;
+}
+
+bool LocalConnection::connect(const std::string& endpoint) {
+	close();
+	std::string path = pipePath(endpoint);
+	HANDLE pipe = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+	if (pipe == INVALID_HANDLE_VALUE && GetLastError() == ERROR_PIPE_BUSY) {
+		// El servidor está atendiendo a otro cliente; se espera a que cree la próxima instancia
+		if (WaitNamedPipeA(path.c_str(), NMPWAIT_WAIT_FOREVER)) {
+			pipe = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+		}
+	}
+	if (pipe == INVALID_HANDLE_VALUE) return false;
+	handle = pipe;
+	server_side = false;
+	return true;
+}
+
+size_t LocalConnection::readSome(char* data, size_t size) {
+	DWORD read = 0;
+	if (!ReadFile(static_cast<HANDLE>(handle), data, static_cast<DWORD>(size), &read, nullptr)) return 0;
+	return read;
+}
+
+bool LocalConnection::writeBytes(const void* data, size_t size) {
+	const char* bytes = static_cast<const char*>(data);
+	while (size > 0) {
+		DWORD written = 0;
+		DWORD chunk = static_cast<DWORD>(size < PIPE_BUFFER_SIZE ? size : PIPE_BUFFER_SIZE);
+		if (!WriteFile(static_cast<HANDLE>(handle), bytes, chunk, &written, nullptr) || written == 0) return false;
+		bytes += written;
+		size -= written;
+	}
+	return true;
+}
+
+void LocalConnection::close() {
+	if (handle != INVALID_HANDLE_VALUE) {
+		if (server_side) {
+			FlushFileBuffers(static_cast<HANDLE>(handle));
+			DisconnectNamedPipe(static_cast<HANDLE>(handle));
+		}
+		CloseHandle(static_cast<HANDLE>(handle));
+		handle = INVALID_HANDLE_VALUE;
+	}
+	buffered.clear();
+}
+
+bool LocalConnection::isOpen() const {
+	return handle != INVALID_HANDLE_VALUE;
+}
+
+LocalServer::LocalServer()
+	: pending(INVALID_HANDLE_VALUE) {
+}
+
+bool LocalServer::listen(const std::string& endpoint) {
+	close();
+	path = pipePath(endpoint);
+	// Se crea la primera instancia ya, así un nombre ocupado falla al arrancar
+	pending = CreateNamedPipeA(path.c_str(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+		PIPE_UNLIMITED_INSTANCES, PIPE_BUFFER_SIZE, PIPE_BUFFER_SIZE, 0, nullptr);
+	return pending != INVALID_HANDLE_VALUE;
+}
+
+bool LocalServer::accept(LocalConnection& connection) {
+	if (pending == INVALID_HANDLE_VALUE) {
+		pending = CreateNamedPipeA(path.c_str(), PIPE_ACCESS_DUPLEX, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT,
+			PIPE_UNLIMITED_INSTANCES, PIPE_BUFFER_SIZE, PIPE_BUFFER_SIZE, 0, nullptr);
+		if (pending == INVALID_HANDLE_VALUE) return false;
+	}
+	HANDLE pipe = static_cast<HANDLE>(pending);
+	// ERROR_PIPE_CONNECTED: el cliente se conectó entre CreateNamedPipe y ConnectNamedPipe
+	if (!ConnectNamedPipe(pipe, nullptr) && GetLastError() != ERROR_PIPE_CONNECTED) {
+		return false;
+	}
+	connection.close();
+	connection.handle = pipe;
+	connection.server_side = true;
+	pending = INVALID_HANDLE_VALUE;
+	return true;
+}
+
+void LocalServer::close() {
+	if (pending != INVALID_HANDLE_VALUE) {
+		CloseHandle(static_cast<HANDLE>(pending));
+		pending = INVALID_HANDLE_VALUE;
+	}
+}
+
+#else
+
+LocalConnection::LocalConnection()
+	: fd(-1) {
+}
+
+LocalConnection::LocalConnection(LocalConnection&& other)
+	: buffered(std::move(other.buffered)), fd(other.fd) {
+	other.fd = -1;
+}
+
+LocalConnection& LocalConnection::operator=(LocalConnection&& other) {
+	if (this != &other) {
+		close();
+		buffered = std::move(other.buffered);
+		fd = other.fd;
+		other.fd = -1;
+	}
+	return *this;
+}
+
+bool LocalConnection::connect(const std::string& endpoint) {
+	close();
+	sockaddr_un address;
+	if (!socketAddress(endpoint, address)) return false;
+	int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) return false;
+	if (::connect(sock, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+		::close(sock);
+		return false;
+	}
+	fd = sock;
+	return true;
+}
+
+size_t LocalConnection::readSome(char* data, size_t size) {
+	for (;;) {
+		ssize_t read = ::recv(fd, data, size, 0);
+		if (read >= 0) return static_cast<size_t>(read);
+		if (errno != EINTR) return 0;
+	}
+}
+
+bool LocalConnection::writeBytes(const void* data, size_t size) {
+	const char* bytes = static_cast<const char*>(data);
+	// Sin MSG_NOSIGNAL un cliente que se desconecta mataría al servidor con SIGPIPE
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	while (size > 0) {
+		ssize_t written = ::send(fd, bytes, size, flags);
+		if (written < 0 && errno == EINTR) continue;
+		if (written <= 0) return false;
+		bytes += written;
+		size -= static_cast<size_t>(written);
+	}
+	return true;
+}
+
+void LocalConnection::close() {
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+	}
+	buffered.clear();
+}
+
+bool LocalConnection::isOpen() const {
+	return fd >= 0;
+}
+
+LocalServer::LocalServer()
+	: fd(-1) {
+}
+
+bool LocalServer::listen(const std::string& endpoint) {
+	close();
+	sockaddr_un address;
+	if (!socketAddress(endpoint, address)) return false;
+	// Sólo se borra un socket que quedó de otra ejecución; cualquier otro archivo en esa
+	// ruta (una escena, por ejemplo) se deja como está
+	struct stat info;
+	if (::lstat(endpoint.c_str(), &info) == 0) {
+		if (!S_ISSOCK(info.st_mode)) {
+			std::cerr << "La ruta ya existe y no es un socket, no se reemplaza: " << endpoint << std::endl;
+			return false;
+		}
+		::unlink(endpoint.c_str());
+	}
+	int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) return false;
+	if (::bind(sock, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(sock, 8) != 0) {
+		::close(sock);
+		return false;
+	}
+	fd = sock;
+	path = endpoint;
+	return true;
+}
+
+bool LocalServer::accept(LocalConnection& connection) {
+	for (;;) {
+		int client = ::accept(fd, nullptr, nullptr);
+		if (client >= 0) {
+			connection.close();
+			connection.fd = client;
+			return true;
+		}
+		if (errno != EINTR) return false;
+	}
+}
+
+void LocalServer::close() {
+	if (fd >= 0) {
+		::close(fd);
+		fd = -1;
+		::unlink(path.c_str());
+	}
+}
+
+#endif
+
+LocalServer::~LocalServer() {
+	close();
+}
+
+LocalConnection::~LocalConnection() {
+	close();
+}
+
+bool LocalConnection::readLine(std::string& line) {
+	for (;;) {
+		size_t end = buffered.find('\n');
+		if (end != std::string::npos) {
+			line.assign(buffered, 0, end);
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			buffered.erase(0, end + 1);
+			return true;
+		}
+		char chunk[4096];
+		size_t read = readSome(chunk, sizeof(chunk));
+		if (read == 0) return false;
+		buffered.append(chunk, read);
+	}
+}
+
+bool LocalConnection::readBytes(void* data, size_t size) {
+	char* bytes = static_cast<char*>(data);
+	size_t from_buffer = size < buffered.size() ? size : buffered.size();
+	std::memcpy(bytes, buffered.data(), from_buffer);
+	buffered.erase(0, from_buffer);
+	bytes += from_buffer;
+	size -= from_buffer;
+	while (size > 0) {
+		size_t read = readSome(bytes, size);
+		if (read == 0) return false;
+		bytes += read;
+		size -= read;
+	}
+	return true;
+}
+
+bool LocalConnection::writeLine(const std::string& line) {
+	std::string terminated = line + "\n";
+	return writeBytes(terminated.data(), terminated.size());
+}
@@ -0,0 +1,175 @@
+#include "MappedFile.h"
+#include <cstring>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+	: view(nullptr), length(0), opened(false)
+#ifdef _WIN32
+	, file_handle(nullptr), mapping_handle(nullptr)
+#else
+	, fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)) {
+		CloseHandle(file);
+		return false;
+	}
+	file_handle = file;
+	length = static_cast<size_t>(file_size.QuadPart);
+	opened = true;
+
+	// No se puede mapear un archivo de tamaño cero
+	if (length == 0) {
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		close();
+		return false;
+	}
+	mapping_handle = mapping;
+	view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (view == nullptr) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (view) {
+		UnmapViewOfFile(view);
+	}
+	if (mapping_handle) {
+		CloseHandle(static_cast<HANDLE>(mapping_handle));
+	}
+	if (file_handle) {
+		CloseHandle(static_cast<HANDLE>(file_handle));
+	}
+	view = nullptr;
+	mapping_handle = nullptr;
+	file_handle = nullptr;
+	length = 0;
+	opened = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+	close();
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close();
+		return false;
+	}
+	length = static_cast<size_t>(st.st_size);
+	opened = true;
+
+	if (length == 0) {
+		return true;
+	}
+
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped == MAP_FAILED) {
+		close();
+		return false;
+	}
+	madvise(mapped, length, MADV_SEQUENTIAL);
+	view = static_cast<const char*>(mapped);
+	return true;
+}
+
+void MappedFile::close() {
+	if (view) {
+		munmap(const_cast<char*>(view), length);
+	}
+	if (fd >= 0) {
+		::close(fd);
+	}
+	view = nullptr;
+	fd = -1;
+	length = 0;
+	opened = false;
+}
+
+#endif
+
+const char* MappedFile::data() const {
+	return view;
+}
+
+size_t MappedFile::size() const {
+	return length;
+}
+
+bool MappedFile::isOpen() const {
+	return opened;
+}
+
+bool MappedFile::fileInfo(const std::string& path, uint64_t& size, int64_t& mtime) {
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_stat64(path.c_str(), &st) != 0) return false;
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return false;
+#endif
+	size = static_cast<uint64_t>(st.st_size);
+	mtime = static_cast<int64_t>(st.st_mtime);
+	return true;
+}
+
+bool MappedFile::hashContents(const std::string& path, uint64_t& hash) {
+	MappedFile file;
+	if (!file.open(path)) return false;
+
+	// FNV-1a aplicado a palabras de 64 bits (y byte a byte en la cola) para no
+	// dominar el tiempo de carga en archivos grandes
+	const char* data = file.data();
+	size_t size = file.size();
+	const uint64_t prime = 1099511628211ULL;
+	hash = 14695981039346656037ULL;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = (hash ^ word) * prime;
+	}
+	for (; i < size; ++i) {
+		hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+	}
+	return true;
+}
@@ -10,6 +10,7 @@
  * @date 08/06/2025
  */
 #include "MaterialGlass.h"
+#include "RenderStats.h"
 #include "Scene.h"
 #include "Ray.h"
 #include <cmath>
@@ -43,6 +44,7 @@ Color MaterialGlass::shade(const Ray& incident_ray, const HitRecord& hit_record,
     // Calcular reflexin
     Vec3 reflected = reflect(unit_dir, normal);
     Ray reflected_ray(hit_record.point + reflected * 1e-4, reflected);
+    RenderStats::add(RenderCounter::ReflectionRays);
     Color reflection_color = tracer.trace(reflected_ray, scene, depth + 1);
 
     // Calcular refraccin solo si no hay reflexin total
@@ -50,6 +52,7 @@ Color MaterialGlass::shade(const Ray& incident_ray, const HitRecord& hit_record,
     if (!total_internal_reflection) {
         Vec3 refracted = refract(unit_dir, normal, eta_ratio);
         Ray refracted_ray(hit_record.point + refracted * 1e-4, refracted);
+        RenderStats::add(RenderCounter::RefractionRays);
         transmission_color = tracer.trace(refracted_ray, scene, depth + 1);
     }
 
@@ -65,11 +68,16 @@ double MaterialGlass::getTransparency() const {
     return transparency;
 }
 
+Color MaterialGlass::getAlbedo(const HitRecord&) const {
+    return albedo;
+}
+
 Color MaterialGlass::shadeComponent(ShadeComponent component, const Ray& ray, const HitRecord& hit, const Scene& scene) const
 {
     if (component == ShadeComponent::Reflection) {
         Vec3 reflected = reflect(unitVector(ray.getDirection()), hit.normal);
         Ray reflected_ray(hit.point + reflected * 1e-4, reflected);
+        RenderStats::add(RenderCounter::ReflectionRays);
         return tracer.trace(reflected_ray, scene, tracer.getMaxDepth()-1); // solo primer rebote
     }
 
@@ -85,6 +93,7 @@ Color MaterialGlass::shadeComponent(ShadeComponent component, const Ray& ray, co
 
         Vec3 refracted = refract(unit_dir, normal, eta);
         Ray refracted_ray(hit.point + refracted * 1e-4, refracted);
+        RenderStats::add(RenderCounter::RefractionRays);
         return tracer.trace(refracted_ray, scene, tracer.getMaxDepth() - 1); // solo primer rebote
     }
 
@@ -11,6 +11,7 @@
 
 #include "MaterialMirror.h"
 #include "Scene.h"
+#include "RenderStats.h"
 #include "Ray.h"
 #include <cmath>
 
@@ -33,6 +34,7 @@ Color MaterialMirror::shade(const Ray& incident_ray, const HitRecord& hit_record
     Vec3 reflected = reflect(unit_direction, hit_record.normal);
 
     Ray reflected_ray(hit_record.point + reflected * 1e-4, reflected);
+    RenderStats::add(RenderCounter::ReflectionRays);
     Color reflected_color = tracer.trace(reflected_ray, scene, depth + 1);
 
     return albedo * reflected_color * getReflectivity();
@@ -48,11 +50,17 @@ double MaterialMirror::getTransparency() const
     return transparency;
 }
 
+Color MaterialMirror::getAlbedo(const HitRecord&) const
+{
+    return albedo;
+}
+
 Color MaterialMirror::shadeComponent(ShadeComponent component, const Ray& ray, const HitRecord& hit, const Scene& scene) const
 {
     if (component == ShadeComponent::Reflection) {
         Vec3 reflected = reflect(unitVector(ray.getDirection()), hit.normal);
         Ray reflected_ray(hit.point + reflected * 1e-4, reflected);
+        RenderStats::add(RenderCounter::ReflectionRays);
         return tracer.trace(reflected_ray, scene, tracer.getMaxDepth() - 1); // solo primer rebote
     }
     return Color(0, 0, 0);
@@ -1,8 +1,10 @@
 #include "MaterialNormalMapped.h"
 #include "Scene.h"
+#include <cmath>
+#include <utility>
 
-MaterialNormalMapped::MaterialNormalMapped(const Color& ambient, const Color& diffuse, const Color& specular, float shininess, const Texture& normalMap)
-	: ambient(ambient), diffuse(diffuse), specular(specular), shininess(shininess), normalMap(normalMap) {
+MaterialNormalMapped::MaterialNormalMapped(const Color& ambient, const Color& diffuse, const Color& specular, float shininess, std::shared_ptr<const Texture> normalMap)
+	: ambient(ambient), diffuse(diffuse), specular(specular), shininess(shininess), normalMap(std::move(normalMap)) {
 }
 
 Color MaterialNormalMapped::shade(const Ray& r_in, const HitRecord& rec, const Scene& scene, int depth) const
@@ -68,10 +70,7 @@ Color MaterialNormalMapped::shadeComponent(ShadeComponent component, const Ray&
 
 Vec3 MaterialNormalMapped::perturbNormal(const HitRecord& rec) const
 {
-    Color map = normalMap.sample(rec.u, rec.v); //  [0, 1]
-    Vec3 n_map(map.getR() * 2.0 - 1.0,
-        map.getG() * 2.0 - 1.0,
-        map.getB() * 2.0 - 1.0); //[-1, 1]
+    Vec3 n_map = normalMap->sampleNormal(rec.u, rec.v, rec.dudx, rec.dvdx, rec.dudy, rec.dvdy); //[-1, 1]
 
     Vec3 N = unitVector(rec.normal);
     Vec3 T = unitVector(std::abs(N.getX()) > 0.9 ? Vec3(0, 1, 0) : crossProduct(Vec3(1, 0, 0), N));
@@ -1,13 +1,14 @@
 #include "MaterialTextured.h"
 #include "Scene.h"
 #include <cmath>
+#include <utility>
 
-MaterialTextured::MaterialTextured(const Texture& tex, double shin)
-    : texture(tex), shininess(shin) {
+MaterialTextured::MaterialTextured(std::shared_ptr<const Texture> tex, double shin)
+    : texture(std::move(tex)), shininess(shin) {
 }
 
 Color MaterialTextured::shade(const Ray& r_in, const HitRecord& rec, const Scene& scene, int depth) const {
-    Color tex_color = texture.sample(rec.u, rec.v);
+    Color tex_color = texture->sample(rec.u, rec.v, rec.dudx, rec.dvdx, rec.dudy, rec.dvdy);
 
     // Componente ambiente (basada en la textura)
     Color result = tex_color; // ambiente global
@@ -34,11 +35,15 @@ Color MaterialTextured::shade(const Ray& r_in, const HitRecord& rec, const Scene
     return result;
 }
 
+Color MaterialTextured::getAlbedo(const HitRecord& rec) const {
+    return texture->sample(rec.u, rec.v, rec.dudx, rec.dvdx, rec.dudy, rec.dvdy);
+}
+
 Color MaterialTextured::shadeComponent(ShadeComponent component,
     const Ray& r_in,
     const HitRecord& rec,
     const Scene& scene) const {
-    Color tex_color = texture.sample(rec.u, rec.v);
+    Color tex_color = texture->sample(rec.u, rec.v, rec.dudx, rec.dvdx, rec.dudy, rec.dvdy);
 
     if (component == ShadeComponent::Ambient) {
         return tex_color;
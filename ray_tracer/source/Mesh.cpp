@@ -1,55 +1,68 @@
 #include "Mesh.h"
 
 Mesh::Mesh(const std::vector<Vec3>& vertices_raw, const std::vector<std::array<int, 3>>& indices, std::shared_ptr<Material> mat, const Vec3& scale, const Vec3& translate) {
-    std::vector<Vec3> vertices;
-    vertices.reserve(vertices_raw.size());
+    MeshData data;
+    data.positions.reserve(vertices_raw.size());
 
     for (const auto& v : vertices_raw) {
-        vertices.emplace_back(v.getX() * scale.getX() + translate.getX(),
+        data.positions.emplace_back(v.getX() * scale.getX() + translate.getX(),
             v.getY() * scale.getY() + translate.getY(),
             v.getZ() * scale.getZ() + translate.getZ());
     }
+    data.position_indices = indices;
+    bvh.build(makeTriangles(data, mat));
+}
 
-    bool first = true;
-    for (const auto& idx : indices) {
-        auto tri = std::make_shared<Triangle>(vertices[idx[0]], vertices[idx[1]], vertices[idx[2]], mat);
-        triangles.push_back(tri);
+Mesh::Mesh(const MeshData& data, std::shared_ptr<Material> mat) {
+    bvh.build(makeTriangles(data, mat));
+}
 
-        AABB tri_box = tri->boundingBox();
-        if (first) {
-            bounding_box = tri_box;
-            first = false;
-        }
-        else {
-            bounding_box.expandToInclude(tri_box);
-        }
+Mesh::Mesh(const MeshData& data, std::shared_ptr<Material> mat, std::vector<BVH::Node> nodes, const std::vector<int>& order) {
+    auto triangles = makeTriangles(data, mat);
+    if (!bvh.assign(triangles, std::move(nodes), order)) {
+        bvh.build(std::move(triangles));
     }
 }
 
-bool Mesh::hit(const Ray& r, Interval t, HitRecord& rec) const {
-    if (!bounding_box.hit(r, t)) return false;
-
-    bool hit_anything = false;
-    auto closest_so_far = t.getMax();
+std::vector<std::shared_ptr<Triangle>> Mesh::makeTriangles(const MeshData& data, std::shared_ptr<Material> mat) {
+    const auto& vertices = data.positions;
+    bool with_normals = data.normal_indices.size() == data.position_indices.size();
+    bool with_uvs = data.tex_coord_indices.size() == data.position_indices.size();
 
-    HitRecord temp_rec;
-    for (const auto& tri : triangles) {
-        if (tri->hit(r, Interval(t.getMin(), closest_so_far), temp_rec)) {
-            hit_anything = true;
-            closest_so_far = temp_rec.t;
-            rec = temp_rec;
+    std::vector<std::shared_ptr<Triangle>> triangles;
+    triangles.reserve(data.position_indices.size());
+    for (size_t i = 0; i < data.position_indices.size(); ++i) {
+        const auto& idx = data.position_indices[i];
+        auto tri = std::make_shared<Triangle>(vertices[idx[0]], vertices[idx[1]], vertices[idx[2]], mat);
+        if (with_normals && data.normal_indices[i][0] >= 0) {
+            const auto& n = data.normal_indices[i];
+            tri->setVertexNormals(data.normals[n[0]], data.normals[n[1]], data.normals[n[2]]);
         }
+        if (with_uvs && data.tex_coord_indices[i][0] >= 0) {
+            const auto& t = data.tex_coord_indices[i];
+            tri->setTexCoords(data.tex_coords[t[0]], data.tex_coords[t[1]], data.tex_coords[t[2]]);
+        }
+        triangles.push_back(tri);
     }
-    return hit_anything;
+    return triangles;
+}
+
+bool Mesh::hit(const Ray& r, Interval t, HitRecord& rec) const {
+    return bvh.hit(r, t, rec);
 }
 
 AABB Mesh::boundingBox() const {
-    return bounding_box;
+    return bvh.boundingBox();
 }
 
 void Mesh::setMaterial(std::shared_ptr<Material> material)
 {
-	for (auto& tri : triangles) {
+	for (const auto& tri : bvh.getPrimitives()) {
 		tri->setMaterial(material);
 	}
 }
+
+const BVH& Mesh::getBVH() const
+{
+    return bvh;
+}
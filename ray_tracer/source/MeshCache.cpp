@@ -0,0 +1,238 @@
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const char CACHE_MAGIC[8] = { 'I', 'C', 'G', 'M', 'E', 'S', 'H', '\0' };
+	const uint32_t CACHE_VERSION = 4;   // 4: malla sin transformar, sin escala ni traslación en el encabezado
+	const uint32_t FLAG_HAS_BVH = 1;
+
+	/**
+	 * @brief Encabezado del archivo de caché; a continuación va el bloque de MeshCache::writeMesh
+	 */
+	struct CacheHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+		uint64_t source_size;
+		int64_t source_mtime;
+		uint64_t source_hash;
+	};
+	static_assert(sizeof(CacheHeader) == 40, "CacheHeader debe tener un layout fijo");
+
+	/**
+	 * @brief Encabezado del bloque de malla
+	 */
+	struct MeshBlockHeader {
+		uint32_t flags;
+		uint32_t reserved;
+		uint64_t position_count;
+		uint64_t normal_count;
+		uint64_t tex_coord_count;
+		uint64_t triangle_count;
+		uint64_t normal_index_count;
+		uint64_t tex_coord_index_count;
+		uint64_t node_count;
+	};
+	static_assert(sizeof(MeshBlockHeader) == 64, "MeshBlockHeader debe tener un layout fijo");
+
+	/**
+	 * @brief Nodo de BVH tal como se guarda en disco
+	 */
+	struct CacheNode {
+		double min[3];
+		double max[3];
+		int32_t right_child;
+		int32_t first_prim;
+		int32_t prim_count;
+		int32_t axis;
+	};
+	static_assert(sizeof(CacheNode) == 64, "CacheNode debe tener un layout fijo");
+	static_assert(sizeof(std::array<int, 3>) == 3 * sizeof(int32_t), "Los índices se guardan como int32 contiguos");
+
+	bool readVecs(BinaryReader& in, std::vector<Vec3>& out, uint64_t count) {
+		if (!in.canRead(count, 3 * sizeof(double))) return false;
+		out.resize(static_cast<size_t>(count));
+		for (auto& v : out) {
+			in.readVec3(v);
+		}
+		return true;
+	}
+
+	bool readIndices(BinaryReader& in, std::vector<std::array<int, 3>>& out, uint64_t count, size_t limit, bool allow_missing) {
+		if (!in.canRead(count, sizeof(std::array<int, 3>))) return false;
+		out.resize(static_cast<size_t>(count));
+		in.readBytes(out.data(), out.size() * sizeof(out[0]));
+		int lowest = allow_missing ? -1 : 0;
+		for (const auto& tri : out) {
+			for (int k = 0; k < 3; ++k) {
+				if (tri[k] < lowest || tri[k] >= static_cast<int>(limit)) return false;
+			}
+		}
+		return true;
+	}
+
+	void writeVecs(BinaryWriter& out, const std::vector<Vec3>& values) {
+		for (const auto& v : values) {
+			out.writeVec3(v);
+		}
+	}
+
+	void writeIndices(BinaryWriter& out, const std::vector<std::array<int, 3>>& values) {
+		out.writeBytes(values.data(), values.size() * sizeof(values[0]));
+	}
+}
+
+std::string MeshCache::cachePath(const std::string& obj_path) {
+	return obj_path + ".meshcache";
+}
+
+void MeshCache::writeMesh(BinaryWriter& out, const MeshData& data, const BVH& bvh) {
+	const auto& nodes = bvh.getNodes();
+	const auto& order = bvh.getPrimitiveOrder();
+	bool with_bvh = !nodes.empty() && order.size() == data.position_indices.size();
+
+	MeshBlockHeader header;
+	std::memset(&header, 0, sizeof(header));
+	header.flags = with_bvh ? FLAG_HAS_BVH : 0;
+	header.position_count = data.positions.size();
+	header.normal_count = data.normals.size();
+	header.tex_coord_count = data.tex_coords.size();
+	header.triangle_count = data.position_indices.size();
+	header.normal_index_count = data.normal_indices.size();
+	header.tex_coord_index_count = data.tex_coord_indices.size();
+	header.node_count = with_bvh ? nodes.size() : 0;
+	out.write(header);
+
+	writeVecs(out, data.positions);
+	writeVecs(out, data.normals);
+	writeVecs(out, data.tex_coords);
+	writeIndices(out, data.position_indices);
+	writeIndices(out, data.normal_indices);
+	writeIndices(out, data.tex_coord_indices);
+	if (with_bvh) {
+		for (const auto& node : nodes) {
+			CacheNode stored;
+			Vec3 min = node.box.getMin();
+			Vec3 max = node.box.getMax();
+			stored.min[0] = min.getX();
+			stored.min[1] = min.getY();
+			stored.min[2] = min.getZ();
+			stored.max[0] = max.getX();
+			stored.max[1] = max.getY();
+			stored.max[2] = max.getZ();
+			stored.right_child = node.right_child;
+			stored.first_prim = node.first_prim;
+			stored.prim_count = node.prim_count;
+			stored.axis = node.axis;
+			out.write(stored);
+		}
+		out.writeBytes(order.data(), order.size() * sizeof(int));
+	}
+}
+
+bool MeshCache::readMesh(BinaryReader& in, MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order) {
+	MeshBlockHeader header;
+	if (!in.read(header)) return false;
+
+	MeshData loaded;
+	bool ok = readVecs(in, loaded.positions, header.position_count)
+		&& readVecs(in, loaded.normals, header.normal_count)
+		&& readVecs(in, loaded.tex_coords, header.tex_coord_count)
+		&& readIndices(in, loaded.position_indices, header.triangle_count, loaded.positions.size(), false)
+		&& readIndices(in, loaded.normal_indices, header.normal_index_count, loaded.normals.size(), true)
+		&& readIndices(in, loaded.tex_coord_indices, header.tex_coord_index_count, loaded.tex_coords.size(), true);
+	if (!ok) return false;
+
+	std::vector<BVH::Node> loaded_nodes;
+	std::vector<int> loaded_order;
+	if (header.flags & FLAG_HAS_BVH) {
+		if (!in.canRead(header.node_count, sizeof(CacheNode))) return false;
+		loaded_nodes.resize(static_cast<size_t>(header.node_count));
+		for (auto& node : loaded_nodes) {
+			CacheNode stored;
+			in.read(stored);
+			node.box = AABB(Vec3(stored.min[0], stored.min[1], stored.min[2]),
+				Vec3(stored.max[0], stored.max[1], stored.max[2]));
+			node.right_child = stored.right_child;
+			node.first_prim = stored.first_prim;
+			node.prim_count = stored.prim_count;
+			node.axis = stored.axis;
+		}
+		loaded_order.resize(static_cast<size_t>(header.triangle_count));
+		if (!in.readBytes(loaded_order.data(), loaded_order.size() * sizeof(int))) return false;
+	}
+
+	data = std::move(loaded);
+	nodes = std::move(loaded_nodes);
+	order = std::move(loaded_order);
+	return true;
+}
+
+bool MeshCache::load(const std::string& obj_path, MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order) {
+	uint64_t source_size;
+	int64_t source_mtime;
+	if (!MappedFile::fileInfo(obj_path, source_size, source_mtime)) return false;
+
+	MappedFile file;
+	if (!file.open(cachePath(obj_path))) return false;
+
+	BinaryReader in(file.data(), file.size());
+	CacheHeader header;
+	if (!in.read(header)
+		|| std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0
+		|| header.version != CACHE_VERSION) {
+		return false;
+	}
+	if (header.source_size != source_size || header.source_mtime != source_mtime) {
+		return false;
+	}
+	uint64_t source_hash;
+	if (!MappedFile::hashContents(obj_path, source_hash) || source_hash != header.source_hash) return false;
+
+	if (!readMesh(in, data, nodes, order)) {
+		std::cerr << "Caché de malla corrupta, se ignora: " << cachePath(obj_path) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::save(const std::string& obj_path, const MeshData& data, const BVH& bvh) {
+	CacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	if (!MappedFile::fileInfo(obj_path, header.source_size, header.source_mtime)
+		|| !MappedFile::hashContents(obj_path, header.source_hash)) {
+		return false;
+	}
+
+	// Se escribe a un archivo temporal y se renombra para no dejar cachés a medio escribir
+	std::string path = cachePath(obj_path);
+	std::string temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return false;
+		}
+		BinaryWriter out(file);
+		out.write(header);
+		writeMesh(out, data, bvh);
+		if (!out.good()) {
+			file.close();
+			std::remove(temp_path.c_str());
+			return false;
+		}
+	}
+
+	std::remove(path.c_str());
+	if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
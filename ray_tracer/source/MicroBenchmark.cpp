@@ -0,0 +1,288 @@
+#include "MicroBenchmark.h"
+#include "AABB.h"
+#include "Constants.h"
+#include "Cylinder.h"
+#include "EntityList.h"
+#include "HitRecord.h"
+#include "Interval.h"
+#include "LambertianMaterial.h"
+#include "MaterialGlass.h"
+#include "MaterialMirror.h"
+#include "MaterialNormalMapped.h"
+#include "MaterialTextured.h"
+#include "PointLight.h"
+#include "Quad.h"
+#include "Scene.h"
+#include "Sphere.h"
+#include "Texture.h"
+#include "Triangle.h"
+#include "WhittedTracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ICG_HAS_RDTSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define ICG_HAS_RDTSC 1
+#else
+#define ICG_HAS_RDTSC 0
+#endif
+
+namespace {
+	const int INPUT_COUNT = 4096;         ///< Entradas por lote
+	const int WARMUP_BATCHES = 5;
+	const int MEASURED_BATCHES = 201;
+	const uint64_t INPUT_SEED = 0x1c6b3e7dULL;
+	const int TEXTURE_SIZE = 256;
+
+	/**
+	 * @brief Lectura del contador de tiempo; lfence evita que el procesador la adelante
+	 * o la atrase respecto del código medido
+	 */
+	inline uint64_t readTimer() {
+#if ICG_HAS_RDTSC
+		_mm_lfence();
+		uint64_t ticks = __rdtsc();
+		_mm_lfence();
+		return ticks;
+#else
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	// Nanosegundos por tick del contador, medidos contra steady_clock
+	double calibrateTimer() {
+#if ICG_HAS_RDTSC
+		auto begin = std::chrono::steady_clock::now();
+		uint64_t ticks_begin = readTimer();
+		while (std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(50)) {
+		}
+		uint64_t ticks = readTimer() - ticks_begin;
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		return ticks > 0 ? seconds * 1e9 / double(ticks) : 0.0;
+#else
+		return 1.0;
+#endif
+	}
+
+	// Evita que el compilador descarte los resultados de los núcleos
+	volatile double sink = 0.0;
+
+	double percentile(const std::vector<double>& sorted, double p) {
+		return sorted[size_t(p * double(sorted.size() - 1) + 0.5)];
+	}
+
+	/**
+	 * @brief Calienta y mide un núcleo; kernel recorre todas las entradas una vez
+	 */
+	MicroBenchmark::Result measure(const std::string& name, const std::function<double()>& kernel, double ns_per_tick) {
+		for (int b = 0; b < WARMUP_BATCHES; ++b) {
+			sink = sink + kernel();
+		}
+		std::vector<double> samples;
+		samples.reserve(MEASURED_BATCHES);
+		for (int b = 0; b < MEASURED_BATCHES; ++b) {
+			uint64_t begin = readTimer();
+			double value = kernel();
+			uint64_t end = readTimer();
+			sink = sink + value;
+			samples.push_back(double(end - begin) / INPUT_COUNT);
+		}
+		std::sort(samples.begin(), samples.end());
+
+		MicroBenchmark::Result result;
+		result.kernel = name;
+		result.min = samples.front();
+		result.p05 = percentile(samples, 0.05);
+		result.median = percentile(samples, 0.5);
+		result.p95 = percentile(samples, 0.95);
+		result.p99 = percentile(samples, 0.99);
+		result.nanoseconds = result.median * ns_per_tick;
+		return result;
+	}
+
+	Vec3 randomInCube(double half_size) {
+		return Vec3(random_double(-half_size, half_size), random_double(-half_size, half_size), random_double(-half_size, half_size));
+	}
+
+	Vec3 randomUnitVector() {
+		for (;;) {
+			Vec3 v = randomInCube(1.0);
+			double length = v.length();
+			if (length > 1e-3 && length <= 1.0) return v / length;
+		}
+	}
+
+	/**
+	 * @brief Rayos desde una esfera de radio 4 hacia puntos cerca del origen: una mezcla de aciertos y fallos
+	 */
+	std::vector<Ray> makeRays() {
+		std::vector<Ray> rays;
+		rays.reserve(INPUT_COUNT);
+		for (int k = 0; k < INPUT_COUNT; ++k) {
+			Vec3 origin = randomUnitVector() * 4.0;
+			rays.emplace_back(origin, randomInCube(1.5) - origin);
+		}
+		return rays;
+	}
+
+	template <typename Shape>
+	double hitKernel(const Shape& shape, const std::vector<Ray>& rays) {
+		double total = 0.0;
+		for (const Ray& ray : rays) {
+			HitRecord rec;
+			if (shape.hit(ray, Interval(0.001, infinity), rec)) total += rec.t;
+		}
+		return total;
+	}
+
+	std::shared_ptr<const Texture> makeTexture(TextureFormat format, bool normals) {
+		std::vector<Color> pixels(size_t(TEXTURE_SIZE) * TEXTURE_SIZE);
+		for (Color& pixel : pixels) {
+			// Un mapa de normales tiene que apuntar hacia +Z en espacio tangente
+			pixel = normals
+				? Color(0.5 + random_double(-0.2, 0.2), 0.5 + random_double(-0.2, 0.2), 1.0)
+				: Color(random_double(), random_double(), random_double());
+		}
+		return std::make_shared<const Texture>(TEXTURE_SIZE, TEXTURE_SIZE, pixels, format);
+	}
+}
+
+int MicroBenchmark::run(const std::string& output_path) {
+	seed_random(INPUT_SEED);
+	double ns_per_tick = calibrateTimer();
+	std::vector<Ray> rays = makeRays();
+	std::vector<Result> results;
+
+	Sphere sphere(Vec3(0, 0, 0), 1.0);
+	Triangle triangle(Vec3(-1, -1, 0), Vec3(1, -1, 0), Vec3(0, 1, 0), nullptr);
+	Quad quad(Vec3(-1, -1, 0), Vec3(1, 1, 0), 2, 0.0);
+	Cylinder cylinder(Vec3(0, 0, 0), -1.0, 1.0, 1.0);
+	AABB box(Vec3(-1, -1, -1), Vec3(1, 1, 1));
+	results.push_back(measure("Sphere::hit", [&] { return hitKernel(sphere, rays); }, ns_per_tick));
+	results.push_back(measure("Triangle::hit", [&] { return hitKernel(triangle, rays); }, ns_per_tick));
+	results.push_back(measure("Quad::hit", [&] { return hitKernel(quad, rays); }, ns_per_tick));
+	results.push_back(measure("Cylinder::hit", [&] { return hitKernel(cylinder, rays); }, ns_per_tick));
+	results.push_back(measure("AABB::hit", [&] {
+		double total = 0.0;
+		for (const Ray& ray : rays) {
+			total += box.hit(ray, Interval(0.001, infinity)) ? 1.0 : 0.0;
+		}
+		return total;
+	}, ns_per_tick));
+
+	// Coordenadas y derivadas fijas; sin derivadas se lee el nivel 0, con derivadas el
+	// filtrado trilineal recorre los niveles de la pirámide
+	std::vector<Vec3> uvs(INPUT_COUNT);
+	for (Vec3& uv : uvs) {
+		uv = Vec3(random_double(), random_double(), random_double(0.0, 1.0 / 32.0));
+	}
+	auto texture = makeTexture(TextureFormat::RGBA8, false);
+	auto normal_map = makeTexture(TextureFormat::Normal, true);
+	results.push_back(measure("Texture::sample", [&] {
+		double total = 0.0;
+		for (const Vec3& uv : uvs) {
+			total += texture->sample(uv.getX(), uv.getY()).getR();
+		}
+		return total;
+	}, ns_per_tick));
+	results.push_back(measure("Texture::sample (mip)", [&] {
+		double total = 0.0;
+		for (const Vec3& uv : uvs) {
+			total += texture->sample(uv.getX(), uv.getY(), uv.getZ(), 0.0, 0.0, uv.getZ()).getR();
+		}
+		return total;
+	}, ns_per_tick));
+
+	// Los materiales se sombrean sobre puntos de una esfera unitaria en una escena vacía con
+	// una luz: los rayos de sombra no encuentran nada y los reflejados y refractados van al fondo
+	WhittedTracer tracer(4);
+	Scene scene(std::make_shared<EntityList>());
+	scene.addLight(std::make_shared<PointLight>(Vec3(2, 4, 3), Color(1, 1, 1)));
+	std::vector<Ray> incident;
+	std::vector<HitRecord> records(INPUT_COUNT);
+	incident.reserve(INPUT_COUNT);
+	Vec3 eye(0, 0, 4);
+	for (HitRecord& rec : records) {
+		Vec3 normal = randomUnitVector();
+		if (normal.getZ() < 0.0) normal = -normal;
+		rec.point = normal;
+		rec.normal = normal;
+		rec.t = (normal - eye).length();
+		rec.u = random_double();
+		rec.v = random_double();
+		rec.frontFace = true;
+		incident.emplace_back(eye, normal - eye);
+	}
+
+	std::vector<std::pair<std::string, std::shared_ptr<Material>>> materials = {
+		{ "LambertianMaterial::shade", std::make_shared<LambertianMaterial>(Color(0.1, 0.1, 0.1), Color(0.7, 0.5, 0.3), Color(0.3, 0.3, 0.3), 32.0) },
+		{ "MaterialMirror::shade", std::make_shared<MaterialMirror>(Color(0.9, 0.9, 0.9), tracer) },
+		{ "MaterialGlass::shade", std::make_shared<MaterialGlass>(Color(1, 1, 1), 1.5, tracer) },
+		{ "MaterialTextured::shade", std::make_shared<MaterialTextured>(texture, 32.0) },
+		{ "MaterialNormalMapped::shade", std::make_shared<MaterialNormalMapped>(Color(0.1, 0.1, 0.1), Color(0.7, 0.5, 0.3), Color(0.3, 0.3, 0.3), 32.0f, normal_map) },
+	};
+	for (const auto& entry : materials) {
+		const Material& material = *entry.second;
+		for (HitRecord& rec : records) {
+			rec.material_ptr = entry.second;
+		}
+		results.push_back(measure(entry.first, [&] {
+			double total = 0.0;
+			for (int k = 0; k < INPUT_COUNT; ++k) {
+				total += material.shade(incident[k], records[k], scene, 0).getR();
+			}
+			return total;
+		}, ns_per_tick));
+	}
+
+	const char* unit = ICG_HAS_RDTSC ? "ciclos" : "ns";
+	std::cout << std::left << std::setw(30) << "Núcleo" << std::right
+		<< std::setw(10) << "mín" << std::setw(10) << "p5" << std::setw(10) << "mediana"
+		<< std::setw(10) << "p95" << std::setw(10) << "p99" << std::setw(10) << "ns" << "  (" << unit << " por llamada)" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (const Result& r : results) {
+		std::cout << std::left << std::setw(30) << r.kernel << std::right
+			<< std::setw(10) << r.min << std::setw(10) << r.p05 << std::setw(10) << r.median
+			<< std::setw(10) << r.p95 << std::setw(10) << r.p99 << std::setw(10) << r.nanoseconds << std::endl;
+	}
+	std::cout.unsetf(std::ios::fixed);
+	std::cout << std::setprecision(6);
+
+	if (output_path.empty()) return 0;
+	if (!writeJSON(output_path, results)) return 1;
+	std::cout << "Resultados guardados: " << output_path << std::endl;
+	return 0;
+}
+
+bool MicroBenchmark::writeJSON(const std::string& path, const std::vector<Result>& results) {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		std::cerr << "No se pudo escribir: " << path << std::endl;
+		return false;
+	}
+	file << std::setprecision(6);
+	file << "{\n";
+	file << "  \"unit\": \"" << (ICG_HAS_RDTSC ? "cycles" : "nanoseconds") << "\",\n";
+	file << "  \"inputs\": " << INPUT_COUNT << ",\n";
+	file << "  \"batches\": " << MEASURED_BATCHES << ",\n";
+	file << "  \"kernels\": [\n";
+	for (size_t k = 0; k < results.size(); ++k) {
+		const Result& r = results[k];
+		file << "    {\"name\": \"" << r.kernel << "\", \"min\": " << r.min << ", \"p05\": " << r.p05
+			<< ", \"median\": " << r.median << ", \"p95\": " << r.p95 << ", \"p99\": " << r.p99
+			<< ", \"median_ns\": " << r.nanoseconds << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+	}
+	file << "  ]\n";
+	file << "}\n";
+	return bool(file);
+}
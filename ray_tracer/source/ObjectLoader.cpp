@@ -1,53 +1,345 @@
 #include "ObjectLoader.h"
-#include <fstream>
-#include <sstream>
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 
+namespace {
+    const double POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
 
-std::shared_ptr<Mesh> ObjectLoader::loadObj(const std::string& filepath,
-    std::shared_ptr<Material> mat,
-    const Vec3& scale,
-    const Vec3& translate) {
-    std::ifstream file(filepath);
-    if (!file) {
-        std::cerr << "No se pudo abrir el archivo: " << filepath << std::endl;
-        return nullptr;
+    inline bool isBlank(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline void skipBlanks(const char*& p, const char* end) {
+        while (p < end && isBlank(*p)) ++p;
     }
 
-    std::vector<Vec3> vertices;
-    std::vector<std::array<int, 3>> indices;
-
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string prefix;
-        iss >> prefix;
-
-        if (prefix == "v") {
-            double x, y, z;
-            iss >> x >> y >> z;
-            vertices.emplace_back(
-                x * scale.getX() + translate.getX(),
-                y * scale.getY() + translate.getY(),
-                z * scale.getZ() + translate.getZ()
-            );
-        }
-        else if (prefix == "f") {
-            std::vector<int> face_indices;
-            std::string token;
-            while (iss >> token) {
-                size_t pos = token.find('/');
-                if (pos != std::string::npos) {
-                    token = token.substr(0, pos);
+    inline void skipLine(const char*& p, const char* end) {
+        while (p < end && *p != '\n') ++p;
+        if (p < end) ++p;
+    }
+
+    bool parseInt(const char*& p, const char* end, int& out) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+        if (p >= end || !isDigit(*p)) return false;
+        int value = 0;
+        while (p < end && isDigit(*p)) {
+            int digit = *p - '0';
+            if (value > (INT_MAX - digit) / 10) return false;  // No entra en un int: mal formado
+            value = value * 10 + digit;
+            ++p;
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // Los primeros 19 dgitos significativos se acumulan en un entero y se escalan una sola vez
+    // por una potencia de 10 exacta, lo que da el resultado correctamente redondeado en los
+    // casos habituales de un .obj.
+    bool parseDouble(const char*& p, const char* end, double& out) {
+        skipBlanks(p, end);
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            ++p;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+        while (p < end && isDigit(*p)) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) ++digits;
+            }
+            else {
+                ++exponent;
+            }
+            any = true;
+            ++p;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            while (p < end && isDigit(*p)) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    if (mantissa) ++digits;
+                    --exponent;
                 }
-                face_indices.push_back(std::stoi(token) - 1);
+                any = true;
+                ++p;
+            }
+        }
+        if (!any) return false;
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* save = p;
+            ++p;
+            int exp_value;
+            if (parseInt(p, end, exp_value)) {
+                exponent += exp_value;
+            }
+            else {
+                p = save;
+            }
+        }
+
+        double value = static_cast<double>(mantissa);
+        if (exponent < 0) {
+            value = exponent >= -22 ? value / POW10[-exponent] : value * std::pow(10.0, exponent);
+        }
+        else if (exponent > 0) {
+            value = exponent <= 22 ? value * POW10[exponent] : value * std::pow(10.0, exponent);
+        }
+        out = negative ? -value : value;
+        return true;
+    }
+
+    // Convierte un ndice OBJ (base 1, o negativo relativo al final) a base 0; -1 si es invlido
+    inline int resolveIndex(int index, size_t count) {
+        int resolved = index > 0 ? index - 1 : static_cast<int>(count) + index;
+        return (index != 0 && resolved >= 0 && resolved < static_cast<int>(count)) ? resolved : -1;
+    }
+
+    struct Corner {
+        int position;
+        int tex_coord;
+        int normal;
+    };
+
+    // Lee un vrtice de cara: p, p/t, p//n o p/t/n
+    bool parseCorner(const char*& p, const char* end, const MeshData& out, Corner& corner) {
+        int value;
+        if (!parseInt(p, end, value)) return false;
+        corner.position = resolveIndex(value, out.positions.size());
+        corner.tex_coord = -1;
+        corner.normal = -1;
+        if (corner.position < 0) return false;
+
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p != '/') {
+                if (!parseInt(p, end, value)) return false;
+                corner.tex_coord = resolveIndex(value, out.tex_coords.size());
+                if (corner.tex_coord < 0) return false;
             }
-            // triangulacin fan
-            for (size_t i = 1; i + 1 < face_indices.size(); ++i) {
-                indices.push_back({ face_indices[0], face_indices[i], face_indices[i + 1] });
+            if (p < end && *p == '/') {
+                ++p;
+                if (!parseInt(p, end, value)) return false;
+                corner.normal = resolveIndex(value, out.normals.size());
+                if (corner.normal < 0) return false;
             }
         }
+        return true;
+    }
+
+    /**
+     * @brief Lleva una normal del .obj al espacio de la escena
+     *
+     * Las normales se transforman con la inversa traspuesta de la escala (cada componente
+     * dividida por la suya), as siguen perpendiculares a la superficie con escalas no
+     * uniformes. Si la escala refleja la malla el orden de los vrtices se invierte, y con
+     * l la normal geomtrica del tringulo; la normal se invierte tambin para seguir del
+     * mismo lado.
+     */
+    Vec3 transformNormal(const Vec3& n, const Vec3& scale) {
+        if (scale.getX() == 0.0 || scale.getY() == 0.0 || scale.getZ() == 0.0) return n;
+        Vec3 transformed(n.getX() / scale.getX(), n.getY() / scale.getY(), n.getZ() / scale.getZ());
+        if (transformed.length() == 0.0) return n;
+        transformed = unitVector(transformed);
+        return scale.getX() * scale.getY() * scale.getZ() < 0.0 ? -transformed : transformed;
     }
 
-    return std::make_shared<Mesh>(vertices, indices, mat);
-}
\ No newline at end of file
+    /**
+     * @brief Aplica la escala y la traslacin de la escena a una malla leda tal como est en el .obj
+     *
+     * Las cajas del BVH se transforman tambin: una escala por eje y una traslacin llevan
+     * cada caja alineada a los ejes a otra caja alineada y ajustada, as que la jerarqua
+     * sigue siendo vlida sin reconstruirla.
+     */
+    void transformMesh(MeshData& data, std::vector<BVH::Node>& nodes, const Vec3& scale, const Vec3& translate) {
+        if (scale.getX() == 1.0 && scale.getY() == 1.0 && scale.getZ() == 1.0
+            && translate.getX() == 0.0 && translate.getY() == 0.0 && translate.getZ() == 0.0) {
+            return;
+        }
+        auto transformPoint = [&](const Vec3& v) {
+            return Vec3(v.getX() * scale.getX() + translate.getX(),
+                v.getY() * scale.getY() + translate.getY(),
+                v.getZ() * scale.getZ() + translate.getZ());
+        };
+        for (auto& position : data.positions) {
+            position = transformPoint(position);
+        }
+        for (auto& normal : data.normals) {
+            normal = transformNormal(normal, scale);
+        }
+        for (auto& node : nodes) {
+            Vec3 a = transformPoint(node.box.getMin());
+            Vec3 b = transformPoint(node.box.getMax());
+            node.box = AABB(Vec3(std::min(a.getX(), b.getX()), std::min(a.getY(), b.getY()), std::min(a.getZ(), b.getZ())),
+                Vec3(std::max(a.getX(), b.getX()), std::max(a.getY(), b.getY()), std::max(a.getZ(), b.getZ())));
+        }
+    }
+
+    bool parseVec3(const char*& p, const char* end, Vec3& v) {
+        double x, y, z;
+        if (!parseDouble(p, end, x) || !parseDouble(p, end, y) || !parseDouble(p, end, z)) return false;
+        v = Vec3(x, y, z);
+        return true;
+    }
+}
+
+bool ObjectLoader::parseObj(const char* data, size_t size, MeshData& out, const std::string& source_name) {
+    const char* p = data;
+    const char* end = data + size;
+    size_t line = 1;
+
+    auto fail = [&](const char* what) {
+        std::cerr << "Error en " << source_name << ":" << line << ": " << what << std::endl;
+        return false;
+    };
+
+    while (p < end) {
+        skipBlanks(p, end);
+        if (p >= end) break;
+
+        if (*p == 'v' && p + 1 < end) {
+            char kind = p[1];
+            // Un "v" o "vt" solo en la lnea no debe consumir el salto de lnea, o skipLine se
+            // come la lnea siguiente
+            p += (kind == '\n' || kind == '\r') ? 1 : 2;
+            if (isBlank(kind)) {
+                Vec3 v;
+                if (!parseVec3(p, end, v)) return fail("vrtice mal formado");
+                out.positions.push_back(v);
+            }
+            else if (kind == 'n') {
+                Vec3 n;
+                if (!parseVec3(p, end, n)) return fail("normal mal formada");
+                out.normals.push_back(n);
+            }
+            else if (kind == 't') {
+                double u, v = 0.0;
+                if (!parseDouble(p, end, u)) return fail("coordenada de textura mal formada");
+                parseDouble(p, end, v);
+                out.tex_coords.emplace_back(u, v, 0.0);
+            }
+        }
+        else if (*p == 'f' && p + 1 < end && isBlank(p[1])) {
+            ++p;
+            Corner first = { -1, -1, -1 };
+            Corner previous = first;
+            Corner current = first;
+            int corners = 0;
+            while (true) {
+                skipBlanks(p, end);
+                if (p >= end || *p == '\n' || *p == '\r' || *p == '#') break;
+                if (!parseCorner(p, end, out, current)) return fail("cara mal formada o ndice fuera de rango");
+
+                // Triangulacin en abanico alrededor del primer vrtice
+                if (corners >= 2) {
+                    out.position_indices.push_back({ first.position, previous.position, current.position });
+                    bool normals = first.normal >= 0 && previous.normal >= 0 && current.normal >= 0;
+                    out.normal_indices.push_back(normals
+                        ? std::array<int, 3>{ { first.normal, previous.normal, current.normal } }
+                        : std::array<int, 3>{ { -1, -1, -1 } });
+                    bool uvs = first.tex_coord >= 0 && previous.tex_coord >= 0 && current.tex_coord >= 0;
+                    out.tex_coord_indices.push_back(uvs
+                        ? std::array<int, 3>{ { first.tex_coord, previous.tex_coord, current.tex_coord } }
+                        : std::array<int, 3>{ { -1, -1, -1 } });
+                }
+                if (corners == 0) first = current;
+                previous = current;
+                ++corners;
+            }
+        }
+
+        skipLine(p, end);
+        ++line;
+    }
+
+    if (out.normals.empty()) out.normal_indices.clear();
+    if (out.tex_coords.empty()) out.tex_coord_indices.clear();
+    return true;
+}
+
+bool ObjectLoader::loadObjData(const std::string& filepath, const Vec3& scale, const Vec3& translate,
+    MeshData& data, std::vector<BVH::Node>& nodes, std::vector<int>& order, bool& from_cache) {
+    TraceScope trace("ObjectLoader::loadObjData", "carga");
+    trace.arg("archivo", filepath);
+    auto start = std::chrono::steady_clock::now();
+
+    from_cache = MeshCache::load(filepath, data, nodes, order);
+    if (from_cache) {
+        double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Malla leda de cach: " << MeshCache::cachePath(filepath) << " (" << data.position_indices.size()
+            << " tringulos) en " << elapsed_ms << " ms" << std::endl;
+        transformMesh(data, nodes, scale, translate);
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(filepath)) {
+        std::cerr << "No se pudo abrir el archivo: " << filepath << std::endl;
+        return false;
+    }
+
+    if (!parseObj(file.data(), file.size(), data, filepath)) {
+        return false;
+    }
+    size_t bytes = file.size();
+    file.close();
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = bytes / (1024.0 * 1024.0);
+    std::cout << "OBJ ledo: " << filepath << " (" << megabytes << " MB, " << data.positions.size() << " vrtices, "
+        << data.position_indices.size() << " tringulos) en " << elapsed_ms << " ms";
+    if (elapsed_ms > 0.0) {
+        std::cout << " - " << megabytes / (elapsed_ms / 1000.0) << " MB/s";
+    }
+    std::cout << std::endl;
+
+    // La cach guarda la malla sin transformar, as la comparten todas las escenas que usan
+    // el mismo .obj con distinta escala o traslacin
+    Mesh untransformed(data, nullptr);
+    untransformed.getBVH().printStats(std::cout);
+    if (!MeshCache::save(filepath, data, untransformed.getBVH())) {
+        std::cerr << "No se pudo guardar la cach de malla para: " << filepath << std::endl;
+    }
+    nodes = untransformed.getBVH().getNodes();
+    order = untransformed.getBVH().getPrimitiveOrder();
+    transformMesh(data, nodes, scale, translate);
+    return true;
+}
+
+std::shared_ptr<Mesh> ObjectLoader::loadObj(const std::string& filepath,
+    std::shared_ptr<Material> mat,
+    const Vec3& scale,
+    const Vec3& translate) {
+    MeshData data;
+    std::vector<BVH::Node> nodes;
+    std::vector<int> order;
+    bool from_cache;
+    if (!loadObjData(filepath, scale, translate, data, nodes, order, from_cache)) {
+        return nullptr;
+    }
+    return std::make_shared<Mesh>(data, mat, std::move(nodes), order);
+}
@@ -0,0 +1,280 @@
+#include "PartialImage.h"
+#include "BinaryStream.h"
+#include "FreeImage.h"
+#include "MappedFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const char PARTIAL_MAGIC[8] = { 'I', 'C', 'G', 'C', 'K', 'P', 'T', '\0' };
+	const uint32_t PARTIAL_VERSION = 4;   // 3: patrón de muestreo en el encabezado; 4: cantidad de muestras del rango
+
+	/**
+	 * @brief Encabezado del archivo; siguen las muestras y el estado de cada bloque,
+	 * la acumulación RGB y la suma de cuadrados de la luminancia
+	 */
+	struct PartialHeader {
+		char magic[8];
+		uint32_t version;
+		int32_t width;
+		int32_t height;
+		int32_t tile_size;
+		uint64_t tile_count;
+		uint64_t scene_hash;
+		int32_t first_sample;
+		int32_t subset_index;
+		int32_t subset_count;
+		int32_t sampler;
+		int32_t sample_count;
+		int32_t reserved;
+	};
+	static_assert(sizeof(PartialHeader) == 64, "PartialHeader debe tener un layout fijo");
+
+	/**
+	 * @brief Estado de un bloque en el archivo
+	 */
+	struct PartialTile {
+		int32_t samples;
+		int32_t converged;
+	};
+}
+
+void PartialImage::reset(int width, int height, int tile_size) {
+	this->width = width;
+	this->height = height;
+	this->tile_size = tile_size;
+	tile_samples.assign(tileCount(), 0);
+	tile_converged.assign(tileCount(), 0);
+	accumulation.assign(size_t(width) * height * 3, 0.0f);
+	luminance_squares.assign(size_t(width) * height, 0.0f);
+}
+
+int PartialImage::tilesX() const {
+	return tile_size > 0 ? int((int64_t(width) + tile_size - 1) / tile_size) : 0;
+}
+
+int PartialImage::tilesY() const {
+	return tile_size > 0 ? int((int64_t(height) + tile_size - 1) / tile_size) : 0;
+}
+
+size_t PartialImage::tileCount() const {
+	return size_t(tilesX()) * tilesY();
+}
+
+bool PartialImage::save(const std::string& path) const {
+	TraceScope trace("PartialImage::save", "salida");
+	PartialHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, PARTIAL_MAGIC, sizeof(PARTIAL_MAGIC));
+	header.version = PARTIAL_VERSION;
+	header.width = width;
+	header.height = height;
+	header.tile_size = tile_size;
+	header.tile_count = tileCount();
+	header.scene_hash = scene_hash;
+	header.first_sample = first_sample;
+	header.subset_index = subset_index;
+	header.subset_count = subset_count;
+	header.sampler = int32_t(sampler);
+	header.sample_count = sample_count;
+
+	std::vector<PartialTile> tiles(tileCount());
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		tiles[t].samples = tile_samples[t];
+		tiles[t].converged = tile_converged[t];
+	}
+
+	// Se escribe a un archivo temporal y se renombra para que un corte no deje el archivo a medias
+	std::string temp_path = path + ".tmp";
+	{
+		std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			std::cerr << "No se pudo escribir: " << temp_path << std::endl;
+			return false;
+		}
+		BinaryWriter out(file);
+		out.write(header);
+		out.writeBytes(tiles.data(), tiles.size() * sizeof(PartialTile));
+		out.writeBytes(accumulation.data(), accumulation.size() * sizeof(float));
+		out.writeBytes(luminance_squares.data(), luminance_squares.size() * sizeof(float));
+		if (!out.good()) {
+			file.close();
+			std::remove(temp_path.c_str());
+			std::cerr << "No se pudo escribir: " << temp_path << std::endl;
+			return false;
+		}
+	}
+	std::remove(path.c_str());
+	if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool PartialImage::load(const std::string& path) {
+	MappedFile file;
+	if (!file.open(path)) return false;
+
+	BinaryReader in(file.data(), file.size());
+	PartialHeader header;
+	if (!in.read(header)
+		|| std::memcmp(header.magic, PARTIAL_MAGIC, sizeof(PARTIAL_MAGIC)) != 0
+		|| header.version != PARTIAL_VERSION
+		|| header.width <= 0 || header.height <= 0 || header.tile_size <= 0
+		|| header.first_sample < 0 || header.sample_count <= 0
+		|| header.subset_count <= 0 || header.subset_index < 0 || header.subset_index >= header.subset_count
+		|| header.sampler < int32_t(SamplerType::Random) || header.sampler > int32_t(SamplerType::BlueNoise)) {
+		return false;
+	}
+
+	// Los tamaños del encabezado no son confiables: antes de reservar memoria se comprueba
+	// que el archivo tenga los bloques y los píxeles que anuncia
+	uint64_t tiles_x = (uint64_t(header.width) + header.tile_size - 1) / header.tile_size;
+	uint64_t tiles_y = (uint64_t(header.height) + header.tile_size - 1) / header.tile_size;
+	uint64_t pixels = uint64_t(header.width) * uint64_t(header.height);
+	const size_t pixel_size = 4 * sizeof(float);  // acumulación RGB y suma de cuadrados
+	if (header.tile_count != tiles_x * tiles_y
+		|| !in.canRead(header.tile_count, sizeof(PartialTile))
+		|| !in.canRead(pixels, pixel_size)
+		|| in.remaining() - header.tile_count * sizeof(PartialTile) < pixels * pixel_size) {
+		return false;
+	}
+
+	PartialImage loaded;
+	loaded.reset(header.width, header.height, header.tile_size);
+	loaded.scene_hash = header.scene_hash;
+	loaded.first_sample = header.first_sample;
+	loaded.sample_count = header.sample_count;
+	loaded.subset_index = header.subset_index;
+	loaded.subset_count = header.subset_count;
+	loaded.sampler = SamplerType(header.sampler);
+
+	std::vector<PartialTile> tiles(loaded.tileCount());
+	in.readBytes(tiles.data(), tiles.size() * sizeof(PartialTile));
+	in.readBytes(loaded.accumulation.data(), loaded.accumulation.size() * sizeof(float));
+	in.readBytes(loaded.luminance_squares.data(), loaded.luminance_squares.size() * sizeof(float));
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		loaded.tile_samples[t] = std::max(0, tiles[t].samples);
+		loaded.tile_converged[t] = tiles[t].converged != 0 ? 1 : 0;
+	}
+
+	*this = std::move(loaded);
+	return true;
+}
+
+bool PartialImage::add(const PartialImage& other) {
+	if (other.width != width || other.height != height || other.tile_size != tile_size
+		|| other.scene_hash != scene_hash || other.sampler != sampler || other.subset_count != subset_count) {
+		return false;
+	}
+	for (size_t t = 0; t < tile_samples.size(); ++t) {
+		tile_samples[t] += other.tile_samples[t];
+		tile_converged[t] = tile_converged[t] | other.tile_converged[t];
+	}
+	for (size_t k = 0; k < accumulation.size(); ++k) {
+		accumulation[k] += other.accumulation[k];
+	}
+	for (size_t k = 0; k < luminance_squares.size(); ++k) {
+		luminance_squares[k] += other.luminance_squares[k];
+	}
+	return true;
+}
+
+std::vector<Color> PartialImage::resolve() const {
+	std::vector<Color> image(size_t(width) * height);
+	int tiles_x = tilesX();
+	for (int j = 0; j < height; ++j) {
+		for (int i = 0; i < width; ++i) {
+			int samples = tile_samples[size_t(j / tile_size) * tiles_x + i / tile_size];
+			double scale = samples > 0 ? 1.0 / samples : 0.0;
+			size_t p = size_t(j) * width + i;
+			image[p] = Color(accumulation[p * 3 + 0] * scale, accumulation[p * 3 + 1] * scale, accumulation[p * 3 + 2] * scale);
+		}
+	}
+	return image;
+}
+
+bool PartialImage::saveImage(const std::string& path) const {
+	TraceScope trace("PartialImage::saveImage", "salida");
+	FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+	if (!bitmap) {
+		std::cerr << "Error creando imagen.\n";
+		return false;
+	}
+	int tiles_x = tilesX();
+	for (int j = 0; j < height; ++j) {
+		for (int i = 0; i < width; ++i) {
+			int samples = tile_samples[size_t(j / tile_size) * tiles_x + i / tile_size];
+			float scale = samples > 0 ? 1.0f / samples : 0.0f;
+			const float* rgb = &accumulation[(size_t(j) * width + i) * 3];
+			// Mismas cuentas en float y corrección de gamma (raíz cuadrada) que el render en
+			// vivo, así la imagen combinada es idéntica a la de un único proceso
+			Color pixel(std::sqrt(std::max(0.0f, rgb[0] * scale)),
+				std::sqrt(std::max(0.0f, rgb[1] * scale)),
+				std::sqrt(std::max(0.0f, rgb[2] * scale)));
+			RGBQUAD color;
+			color.rgbRed = BYTE(pixel.getRbyte());
+			color.rgbGreen = BYTE(pixel.getGbyte());
+			color.rgbBlue = BYTE(pixel.getBbyte());
+			FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+		}
+	}
+	bool saved = FreeImage_Save(FIF_PNG, bitmap, path.c_str(), 0) != 0;
+	if (saved) {
+		std::cout << "Imagen guardada: " << path << std::endl;
+	}
+	else {
+		std::cerr << "Error guardando la imagen: " << path << std::endl;
+	}
+	FreeImage_Unload(bitmap);
+	return saved;
+}
+
+bool PartialImage::merge(const std::vector<std::string>& paths, PartialImage& result) {
+	if (paths.empty()) return false;
+	// Subconjunto y rango de muestras de cada parte ya sumada
+	struct Range {
+		int subset_index;
+		int64_t begin, end;
+	};
+	std::vector<Range> ranges;
+	for (size_t k = 0; k < paths.size(); ++k) {
+		PartialImage part;
+		if (!part.load(paths[k])) {
+			std::cerr << "No se pudo leer la parte: " << paths[k] << std::endl;
+			return false;
+		}
+		// Dos partes con el mismo subconjunto y muestras en común tienen las mismas semillas:
+		// sumarlas contaría dos veces las mismas muestras
+		Range range = { part.subset_index, int64_t(part.first_sample), int64_t(part.first_sample) + part.sample_count };
+		for (size_t r = 0; r < ranges.size() && part.subset_count == result.subset_count; ++r) {
+			if (ranges[r].subset_index == range.subset_index && range.begin < ranges[r].end && ranges[r].begin < range.end) {
+				std::cerr << "La parte " << paths[k] << " repite muestras de " << paths[r] << " (bloques "
+					<< part.subset_index << "/" << part.subset_count << ", muestras " << range.begin << ":" << range.end - range.begin
+					<< " y " << ranges[r].begin << ":" << ranges[r].end - ranges[r].begin << ")" << std::endl;
+				return false;
+			}
+		}
+		ranges.push_back(range);
+		if (k == 0) {
+			result = std::move(part);
+		}
+		else if (!result.add(part)) {
+			std::cerr << "La parte " << paths[k] << " es de otra escena, de otro tamaño, de otro patrón de muestreo"
+				" o de otro reparto de bloques" << std::endl;
+			return false;
+		}
+	}
+
+	size_t empty_tiles = static_cast<size_t>(std::count(result.tile_samples.begin(), result.tile_samples.end(), 0));
+	if (empty_tiles > 0) {
+		std::cerr << "Advertencia: " << empty_tiles << " bloques sin muestras (faltan partes)" << std::endl;
+	}
+	return true;
+}
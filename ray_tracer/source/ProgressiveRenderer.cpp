@@ -0,0 +1,671 @@
+#include "ProgressiveRenderer.h"
+#include "CancellationToken.h"
+#include "Camera.h"
+#include "Constants.h"
+#include "FreeImage.h"
+#include "PartialImage.h"
+#include "RenderStats.h"
+#include "Scene.h"
+#include "Trace.h"
+#include "WhittedTracer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+	const int TILE_SIZE = 32;
+	const int DEFAULT_PREVIEW_PIXEL = 8;           ///< Vista previa del primer render, antes de tener una medida de costo
+	const int MAX_PREVIEW_PIXEL = 16;               ///< Divide a TILE_SIZE, así los bloques de la vista previa no cruzan bloques
+	const double PREVIEW_BUDGET_SECONDS = 1.0 / 30.0;
+	const int BUDGET_MAX_PASSES = 1 << 16;         ///< Tope de pasadas cuando manda el presupuesto de tiempo
+	const int MIN_ADAPTIVE_PASSES = 8;             ///< Muestras mínimas antes de confiar en la varianza estimada
+	const double COST_MAP_PERCENTILE = 0.99;       ///< Costo que corresponde al extremo de la escala de colores
+
+	double luminance(double r, double g, double b) {
+		return 0.2126 * r + 0.7152 * g + 0.0722 * b;
+	}
+
+	uint32_t packPixel(const Color& color) {
+		return (uint32_t(color.getRbyte()) << 16) | (uint32_t(color.getGbyte()) << 8) | uint32_t(color.getBbyte());
+	}
+
+	// Escala de falso color: negro, azul, magenta, naranja, amarillo y blanco para t de 0 a 1
+	RGBQUAD costColor(double t) {
+		static const double STOPS[][3] = {
+			{ 0, 0, 0 }, { 40, 10, 140 }, { 180, 30, 130 }, { 245, 120, 30 }, { 250, 230, 60 }, { 255, 255, 255 }
+		};
+		const int last = int(sizeof(STOPS) / sizeof(STOPS[0])) - 1;
+		double x = clamp(t, 0.0, 1.0) * last;
+		int k = std::min(int(x), last - 1);
+		double f = x - k;
+		RGBQUAD color;
+		color.rgbRed = BYTE(STOPS[k][0] + (STOPS[k + 1][0] - STOPS[k][0]) * f);
+		color.rgbGreen = BYTE(STOPS[k][1] + (STOPS[k + 1][1] - STOPS[k][1]) * f);
+		color.rgbBlue = BYTE(STOPS[k][2] + (STOPS[k + 1][2] - STOPS[k][2]) * f);
+		color.rgbReserved = 0;
+		return color;
+	}
+}
+
+ProgressiveRenderer::ProgressiveRenderer(const WhittedTracer& tracer, const Scene& scene, const Camera& camera, unsigned threads)
+	: tracer(tracer), scene(scene), camera(camera),
+	width(camera.getImageWidth()), height(camera.getImageHeight()),
+	total_passes(std::max(1, camera.getSamplesPerPixel())),
+	time_budget(0.0), token(nullptr), adaptive_threshold(0.0),
+	thread_count(threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+	preview_pixel(DEFAULT_PREVIEW_PIXEL), seconds_per_ray(0.0), hdr_format(HDRFormat::None),
+	tiles(size_t((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE)),
+	accumulation(size_t(width) * height * 3, 0.0f),
+	luminance_squares(size_t(width) * height, 0.0f),
+	display(new std::atomic<uint32_t>[size_t(width) * height]),
+	staging(size_t(width) * height * 3, 0),
+	next_job(0), jobs_done(0), traced_rays(0), accumulated_samples(0), converged_tiles(0),
+	stopped_early(false), completed(false), active_workers(0),
+	cancel(false), finished(false), dirty(false),
+	first_sample(0), sample_count(0), subset_index(0), subset_count(1), owned_tiles(0),
+	scene_hash(0), checkpoint_interval(0.0), checkpoint_stop(false) {
+	int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		Tile& tile = tiles[t];
+		tile.x0 = int(t % tiles_x) * TILE_SIZE;
+		tile.y0 = int(t / tiles_x) * TILE_SIZE;
+		tile.x1 = std::min(tile.x0 + TILE_SIZE, width);
+		tile.y1 = std::min(tile.y0 + TILE_SIZE, height);
+	}
+	for (size_t p = 0; p < size_t(width) * height; ++p) {
+		display[p].store(0, std::memory_order_relaxed);
+	}
+}
+
+ProgressiveRenderer::~ProgressiveRenderer() {
+	stop();
+}
+
+void ProgressiveRenderer::setTimeBudget(double seconds) {
+	time_budget = std::max(0.0, seconds);
+}
+
+void ProgressiveRenderer::setCancellationToken(const CancellationToken* token) {
+	this->token = token;
+}
+
+void ProgressiveRenderer::setAdaptiveThreshold(double relative_error) {
+	adaptive_threshold = std::max(0.0, relative_error);
+}
+
+void ProgressiveRenderer::setPreviewEnabled(bool enabled) {
+	preview_pixel = enabled ? DEFAULT_PREVIEW_PIXEL : 1;
+}
+
+void ProgressiveRenderer::setCheckpoint(const std::string& path, double interval_seconds) {
+	checkpoint_path = path;
+	checkpoint_interval = std::max(1.0, interval_seconds);
+}
+
+void ProgressiveRenderer::setSceneHash(uint64_t hash) {
+	scene_hash = hash;
+}
+
+uint64_t ProgressiveRenderer::viewHash() const {
+	uint64_t hash = scene_hash;
+	auto combine = [&hash](uint64_t value) {
+		// Mezcla de splitmix64 sobre el acumulado, sensible al orden de los valores
+		uint64_t z = hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		hash = z ^ (z >> 31);
+	};
+	auto combineVec = [&combine](const Vec3& v) {
+		const double values[3] = { v.getX(), v.getY(), v.getZ() };
+		for (double value : values) {
+			uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			combine(bits);
+		}
+	};
+	combineVec(camera.getEye());
+	combineVec(camera.getLookAt());
+	combineVec(camera.getUp());
+	combine(uint64_t(width));
+	combine(uint64_t(height));
+	combine(uint64_t(camera.getSamplesPerPixel()));
+	return hash;
+}
+
+void ProgressiveRenderer::setTileSubset(int index, int count) {
+	subset_count = std::max(1, count);
+	subset_index = clamp(index, 0, subset_count - 1);
+}
+
+void ProgressiveRenderer::setSampleRange(int first, int count) {
+	first_sample = std::max(0, first);
+	sample_count = std::max(0, count);
+}
+
+void ProgressiveRenderer::setHDROutput(HDRFormat format) {
+	hdr_format = format;
+}
+
+void ProgressiveRenderer::setCostMapEnabled(bool enabled) {
+	pixel_cost.assign(enabled ? size_t(width) * height : 0, 0.0f);
+}
+
+bool ProgressiveRenderer::ownsTile(size_t index) const {
+	// Reparto intercalado: cada proceso recibe bloques de toda la imagen y la carga queda pareja
+	return int(index % size_t(subset_count)) == subset_index;
+}
+
+int ProgressiveRenderer::plannedPasses() const {
+	if (time_budget > 0.0) return BUDGET_MAX_PASSES;
+	return sample_count > 0 ? sample_count : std::max(1, camera.getSamplesPerPixel());
+}
+
+void ProgressiveRenderer::start() {
+	if (!workers.empty()) return;
+	cancel = false;
+	finished = false;
+	stopped_early = false;
+	completed = false;
+	total_passes = plannedPasses();
+	owned_tiles = 0;
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		owned_tiles += ownsTile(t) ? 1 : 0;
+	}
+	start_time = std::chrono::steady_clock::now();
+	active_workers = thread_count;
+	for (unsigned i = 0; i < thread_count; ++i) {
+		workers.emplace_back(&ProgressiveRenderer::workerLoop, this);
+	}
+	if (!checkpoint_path.empty()) {
+		checkpoint_stop = false;
+		checkpoint_thread = std::thread(&ProgressiveRenderer::checkpointLoop, this);
+	}
+}
+
+void ProgressiveRenderer::stop() {
+	cancel = true;
+	wait();
+}
+
+void ProgressiveRenderer::wait() {
+	for (auto& worker : workers) {
+		if (worker.joinable()) {
+			worker.join();
+		}
+	}
+	workers.clear();
+	stopCheckpointThread();
+}
+
+void ProgressiveRenderer::checkpointLoop() {
+	std::unique_lock<std::mutex> lock(checkpoint_mutex);
+	while (!checkpoint_wake.wait_for(lock, std::chrono::duration<double>(checkpoint_interval), [this] { return checkpoint_stop; })) {
+		lock.unlock();
+		savePartial(checkpoint_path);
+		lock.lock();
+	}
+}
+
+void ProgressiveRenderer::stopCheckpointThread() {
+	if (!checkpoint_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(checkpoint_mutex);
+		checkpoint_stop = true;
+	}
+	checkpoint_wake.notify_all();
+	checkpoint_thread.join();
+
+	// Un render completo ya no necesita el checkpoint; uno cortado deja el último estado para continuar
+	if (completed) {
+		std::remove(checkpoint_path.c_str());
+	}
+	else if (savePartial(checkpoint_path)) {
+		std::cout << "Checkpoint guardado: " << checkpoint_path << std::endl;
+	}
+}
+
+void ProgressiveRenderer::snapshot(PartialImage& partial) const {
+	partial.reset(width, height, TILE_SIZE);
+	partial.scene_hash = viewHash();
+	partial.sampler = camera.getSampler();
+	partial.first_sample = first_sample;
+	partial.sample_count = plannedPasses();
+	partial.subset_index = subset_index;
+	partial.subset_count = subset_count;
+	// Cada bloque se copia con su lock, así su acumulación y su cantidad de muestras son coherentes
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		const Tile& tile = tiles[t];
+		std::lock_guard<std::mutex> lock(tile.mutex);
+		partial.tile_samples[t] = tile.samples;
+		partial.tile_converged[t] = tile.converged ? 1 : 0;
+		for (int j = tile.y0; j < tile.y1; ++j) {
+			size_t begin = size_t(j) * width + tile.x0;
+			size_t count = size_t(tile.x1 - tile.x0);
+			std::copy_n(&accumulation[begin * 3], count * 3, &partial.accumulation[begin * 3]);
+			std::copy_n(&luminance_squares[begin], count, &partial.luminance_squares[begin]);
+		}
+	}
+}
+
+bool ProgressiveRenderer::savePartial(const std::string& path) {
+	PartialImage partial;
+	snapshot(partial);
+	std::lock_guard<std::mutex> lock(checkpoint_write_mutex);
+	return partial.save(path);
+}
+
+bool ProgressiveRenderer::resume() {
+	if (checkpoint_path.empty() || !workers.empty()) return false;
+	PartialImage partial;
+	if (!partial.load(checkpoint_path)) return false;
+	if (partial.width != width || partial.height != height || partial.tile_size != TILE_SIZE
+		|| partial.scene_hash != viewHash() || partial.sampler != camera.getSampler() || partial.first_sample != first_sample
+		|| partial.subset_index != subset_index || partial.subset_count != subset_count) {
+		std::cerr << "El checkpoint corresponde a otra escena, a otra parte del render o a otro patrón de muestreo, se ignora: " << checkpoint_path << std::endl;
+		return false;
+	}
+
+	accumulation = std::move(partial.accumulation);
+	luminance_squares = std::move(partial.luminance_squares);
+	uint64_t samples = 0;
+	size_t converged = 0;
+	for (size_t t = 0; t < tiles.size(); ++t) {
+		Tile& tile = tiles[t];
+		tile.samples = partial.tile_samples[t];
+		tile.resumed_samples = tile.samples;
+		tile.converged = partial.tile_converged[t] != 0;
+		samples += uint64_t(tile.samples) * (tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+		converged += tile.converged ? 1 : 0;
+		if (tile.samples > 0) {
+			resolveTile(tile);
+		}
+	}
+	accumulated_samples = samples;
+	converged_tiles = converged;
+	// La imagen reanudada ya está en pantalla, la vista previa sólo la empeoraría
+	preview_pixel = 1;
+
+	std::cout << "Reanudando checkpoint " << checkpoint_path << ": " << getAverageSamples()
+		<< " muestras por píxel en promedio" << std::endl;
+	return true;
+}
+
+void ProgressiveRenderer::restart() {
+	stop();
+	std::fill(accumulation.begin(), accumulation.end(), 0.0f);
+	std::fill(luminance_squares.begin(), luminance_squares.end(), 0.0f);
+	std::fill(pixel_cost.begin(), pixel_cost.end(), 0.0f);
+	for (auto& tile : tiles) {
+		tile.samples = 0;
+		tile.resumed_samples = 0;
+		tile.converged = false;
+	}
+	next_job = 0;
+	jobs_done = 0;
+	traced_rays = 0;
+	accumulated_samples = 0;
+	converged_tiles = 0;
+	preview_pixel = choosePreviewPixelSize();
+	start();
+}
+
+int ProgressiveRenderer::choosePreviewPixelSize() const {
+	if (seconds_per_ray <= 0.0) return preview_pixel;
+	// El menor tamaño cuya vista previa entra en el presupuesto; con 1 la primera pasada ya es suficientemente rápida
+	double pixels = double(width) * height;
+	int size = 1;
+	while (size < MAX_PREVIEW_PIXEL && pixels / (size * size) * seconds_per_ray > PREVIEW_BUDGET_SECONDS) {
+		size *= 2;
+	}
+	return size;
+}
+
+void ProgressiveRenderer::workerLoop() {
+	if (Trace::isEnabled()) {
+		Trace::setThreadName("render");
+	}
+	const uint64_t tile_count = tiles.size();
+	const uint64_t preview_jobs = preview_pixel > 1 ? tile_count : 0;
+	const uint64_t total_jobs = preview_jobs + tile_count * uint64_t(total_passes);
+	const uint64_t first_pass_end = preview_jobs + tile_count;
+	while (!cancel) {
+		// Los trabajos se reparten pasada por pasada, así la primera pasada cubre toda la imagen antes de refinar
+		uint64_t job = next_job.fetch_add(1);
+		if (job >= total_jobs || converged_tiles.load() == owned_tiles) break;
+		if (shouldStop(job, first_pass_end)) {
+			stopped_early = true;
+			break;
+		}
+		if (job < preview_jobs) {
+			renderPreviewTile(tiles[size_t(job)]);
+		}
+		else if (renderTile(tiles[size_t((job - preview_jobs) % tile_count)], (job - preview_jobs) / tile_count)) {
+			jobs_done.fetch_add(1);
+		}
+	}
+
+	if (active_workers.fetch_sub(1) == 1) {
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		uint64_t rays = traced_rays.load();
+		if (rays > 0) {
+			seconds_per_ray = seconds / rays;
+		}
+		if (!cancel) {
+			std::cout << "Render progresivo: " << getCompletedPasses() << " pasadas, " << getAverageSamples()
+				<< " muestras por píxel en promedio, " << seconds << " s con " << thread_count << " hilos";
+			if (stopped_early) {
+				std::cout << " (detenido por " << (token && token->isCancelled() ? "cancelación" : "presupuesto de tiempo") << ")";
+			}
+			if (adaptive_threshold > 0.0) {
+				std::cout << ", " << converged_tiles.load() << "/" << tile_count << " bloques convergidos";
+			}
+			std::cout << std::endl;
+		}
+		completed = !cancel && !stopped_early;
+		finished = true;
+	}
+}
+
+bool ProgressiveRenderer::shouldStop(uint64_t job, uint64_t first_pass_end) const {
+	// La vista previa y la primera pasada se completan siempre; la cancelación interna (stop) no espera
+	if (job < first_pass_end) return false;
+	if (token && token->isCancelled()) return true;
+	if (time_budget > 0.0) {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		return elapsed >= time_budget;
+	}
+	return false;
+}
+
+double ProgressiveRenderer::tileError(const Tile& tile) const {
+	// Error estándar de la media de la luminancia, sumado sobre el bloque y relativo a su brillo
+	double n = tile.samples;
+	double error = 0.0;
+	double brightness = 0.0;
+	for (int j = tile.y0; j < tile.y1; ++j) {
+		for (int i = tile.x0; i < tile.x1; ++i) {
+			size_t p = size_t(j) * width + i;
+			double mean = luminance(accumulation[p * 3 + 0], accumulation[p * 3 + 1], accumulation[p * 3 + 2]) / n;
+			double variance = std::max(0.0, (luminance_squares[p] / n - mean * mean) * n / (n - 1.0));
+			error += std::sqrt(variance / n);
+			brightness += mean;
+		}
+	}
+	double pixels = double(tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+	return error / std::max(brightness, 1e-3 * pixels);
+}
+
+void ProgressiveRenderer::renderPreviewTile(Tile& tile) {
+	if (!ownsTile(size_t(&tile - tiles.data()))) return;
+	std::lock_guard<std::mutex> lock(tile.mutex);
+	// Si una pasada completa ya llegó a este bloque la vista previa sólo lo empeoraría
+	if (tile.samples > 0) return;
+
+	TraceScope trace("vista previa", "render");
+	trace.arg("bloque", int64_t(&tile - tiles.data()));
+	uint64_t rays = 0;
+	for (int by = tile.y0; by < tile.y1 && !cancel; by += preview_pixel) {
+		for (int bx = tile.x0; bx < tile.x1; bx += preview_pixel) {
+			int y1 = std::min(by + preview_pixel, tile.y1);
+			int x1 = std::min(bx + preview_pixel, tile.x1);
+			Color sample = tracer.trace(camera.getRay((bx + x1) / 2, (by + y1) / 2), scene);
+			++rays;
+			uint32_t packed = packPixel(Color(std::sqrt(std::max(0.0, sample.getR())),
+				std::sqrt(std::max(0.0, sample.getG())), std::sqrt(std::max(0.0, sample.getB()))));
+			for (int j = by; j < y1; ++j) {
+				for (int i = bx; i < x1; ++i) {
+					display[size_t(j) * width + i].store(packed, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+	traced_rays.fetch_add(rays);
+	RenderStats::add(RenderCounter::PrimaryRays, rays);
+	dirty.store(true, std::memory_order_release);
+}
+
+bool ProgressiveRenderer::renderTile(Tile& tile, uint64_t pass) {
+	// Con pocos bloques un hilo puede tomar la pasada siguiente de un bloque que otro todavía
+	// está acumulando; el orden de las sumas no importa, sólo que no se pisen
+	std::lock_guard<std::mutex> lock(tile.mutex);
+	size_t index = size_t(&tile - tiles.data());
+	if (!ownsTile(index) || tile.converged || pass < uint64_t(tile.resumed_samples)) return true;
+
+	TraceScope trace("bloque", "render");
+	trace.arg("bloque", int64_t(index));
+	trace.arg("pasada", int64_t(first_sample + tile.samples));
+
+	// La semilla depende sólo del bloque y del número de muestra, así la imagen no depende
+	// de los hilos, un render reanudado sigue la misma secuencia que uno sin cortes y las
+	// partes de un render distribuido suman lo mismo que un único proceso
+	seed_random(uint64_t(first_sample + tile.samples) * tiles.size() + index);
+	bool measure_cost = !pixel_cost.empty();
+	// La pasada se acumula aparte y se suma entera al final: un bloque abandonado no deja
+	// muestras a medias en accumulation que un checkpoint guardaría sin contarlas
+	const int tile_width = tile.x1 - tile.x0;
+	static thread_local std::vector<float> pass_color;
+	static thread_local std::vector<float> pass_luminance;
+	pass_color.resize(size_t(TILE_SIZE) * TILE_SIZE * 3);
+	pass_luminance.resize(size_t(TILE_SIZE) * TILE_SIZE);
+	for (int j = tile.y0; j < tile.y1; ++j) {
+		if (cancel) return false;
+		float* row = &pass_color[size_t(j - tile.y0) * tile_width * 3];
+		float* row_luminance = &pass_luminance[size_t(j - tile.y0) * tile_width];
+		for (int i = tile.x0; i < tile.x1; ++i) {
+			std::chrono::steady_clock::time_point sample_begin;
+			if (measure_cost) sample_begin = std::chrono::steady_clock::now();
+			Color sample = tracer.trace(camera.getRandomRay(i, j, uint64_t(first_sample + tile.samples)), scene);
+			if (measure_cost) {
+				pixel_cost[size_t(j) * width + i] += float(std::chrono::duration<double, std::nano>(
+					std::chrono::steady_clock::now() - sample_begin).count());
+			}
+			int x = i - tile.x0;
+			row[x * 3 + 0] = float(sample.getR());
+			row[x * 3 + 1] = float(sample.getG());
+			row[x * 3 + 2] = float(sample.getB());
+			double l = luminance(sample.getR(), sample.getG(), sample.getB());
+			row_luminance[x] = float(l * l);
+		}
+	}
+	for (int j = tile.y0; j < tile.y1; ++j) {
+		const float* color = &pass_color[size_t(j - tile.y0) * tile_width * 3];
+		const float* squares = &pass_luminance[size_t(j - tile.y0) * tile_width];
+		float* row = &accumulation[(size_t(j) * width + tile.x0) * 3];
+		float* row_squares = &luminance_squares[size_t(j) * width + tile.x0];
+		for (int k = 0; k < tile_width * 3; ++k) {
+			row[k] += color[k];
+		}
+		for (int k = 0; k < tile_width; ++k) {
+			row_squares[k] += squares[k];
+		}
+	}
+	++tile.samples;
+	uint64_t pixels = uint64_t(tile.x1 - tile.x0) * (tile.y1 - tile.y0);
+	traced_rays.fetch_add(pixels);
+	RenderStats::add(RenderCounter::PrimaryRays, pixels);
+	accumulated_samples.fetch_add(pixels);
+	if (adaptive_threshold > 0.0 && tile.samples >= MIN_ADAPTIVE_PASSES && tileError(tile) < adaptive_threshold) {
+		tile.converged = true;
+		converged_tiles.fetch_add(1);
+	}
+
+	resolveTile(tile);
+	return true;
+}
+
+void ProgressiveRenderer::resolveTile(const Tile& tile) {
+	TraceScope trace("tonemapping", "render");
+	float scale = 1.0f / tile.samples;
+	for (int j = tile.y0; j < tile.y1; ++j) {
+		const float* row = &accumulation[size_t(j) * width * 3];
+		for (int i = tile.x0; i < tile.x1; ++i) {
+			// Misma corrección de gamma (raíz cuadrada) y saturación que el render por filas
+			Color pixel(std::sqrt(std::max(0.0f, row[i * 3 + 0] * scale)),
+				std::sqrt(std::max(0.0f, row[i * 3 + 1] * scale)),
+				std::sqrt(std::max(0.0f, row[i * 3 + 2] * scale)));
+			display[size_t(j) * width + i].store(packPixel(pixel), std::memory_order_relaxed);
+		}
+	}
+	dirty.store(true, std::memory_order_release);
+}
+
+void ProgressiveRenderer::copyDisplay(std::vector<uint8_t>& rgb) const {
+	rgb.resize(size_t(width) * height * 3);
+	for (size_t p = 0; p < size_t(width) * height; ++p) {
+		uint32_t packed = display[p].load(std::memory_order_relaxed);
+		rgb[p * 3 + 0] = uint8_t(packed >> 16);
+		rgb[p * 3 + 1] = uint8_t(packed >> 8);
+		rgb[p * 3 + 2] = uint8_t(packed);
+	}
+}
+
+void ProgressiveRenderer::present(SDL_Renderer* renderer, SDL_Texture* texture) {
+	if (!dirty.exchange(false, std::memory_order_acquire)) return;
+	copyDisplay(staging);
+	SDL_UpdateTexture(texture, nullptr, staging.data(), width * 3);
+	SDL_RenderClear(renderer);
+	SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+	SDL_RenderPresent(renderer);
+}
+
+bool ProgressiveRenderer::saveImage() const {
+	TraceScope trace("ProgressiveRenderer::saveImage", "salida");
+	FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+	if (!bitmap) {
+		std::cerr << "Error creando imagen.\n";
+		return false;
+	}
+	for (int j = 0; j < height; ++j) {
+		for (int i = 0; i < width; ++i) {
+			uint32_t packed = display[size_t(j) * width + i].load(std::memory_order_relaxed);
+			RGBQUAD color;
+			color.rgbRed = BYTE(packed >> 16);
+			color.rgbGreen = BYTE(packed >> 8);
+			color.rgbBlue = BYTE(packed);
+			FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+		}
+	}
+
+	bool saved = false;
+	std::time_t now = std::time(nullptr);
+	std::tm tm_info{};
+	if (localTime(now, tm_info)) {
+		std::ostringstream oss;
+		oss << "images/render_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S");
+		std::string png_path = oss.str() + ".png";
+		saved = FreeImage_Save(FIF_PNG, bitmap, png_path.c_str(), 0) != 0;
+		if (saved) {
+			std::cout << "Imagen guardada: " << png_path << std::endl;
+		}
+		else {
+			std::cerr << "Error guardando la imagen.\n";
+		}
+		if (hdr_format != HDRFormat::None) {
+			PartialImage partial;
+			snapshot(partial);
+			std::string hdr_path = oss.str() + HDRImage::extension(hdr_format);
+			if (HDRImage::save(hdr_path, partial.resolve(), width, height, hdr_format)) {
+				std::cout << "Imagen lineal guardada: " << hdr_path << std::endl;
+			}
+			else {
+				saved = false;
+			}
+		}
+	}
+	FreeImage_Unload(bitmap);
+	return saved;
+}
+
+bool ProgressiveRenderer::saveCostMap() const {
+	TraceScope trace("ProgressiveRenderer::saveCostMap", "salida");
+	if (pixel_cost.empty()) {
+		std::cerr << "El costo por píxel no se midió (falta setCostMapEnabled).\n";
+		return false;
+	}
+
+	// El extremo de la escala es un percentil alto y no el máximo, así unos pocos píxeles
+	// muy caros (o interrumpidos por el sistema) no dejan el resto de la imagen en negro
+	std::vector<float> sorted(pixel_cost);
+	size_t rank = size_t(COST_MAP_PERCENTILE * (sorted.size() - 1));
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	double scale_top = std::max(1.0, double(sorted[rank]));
+	double total = 0.0;
+	float peak = 0.0f;
+	for (float cost : pixel_cost) {
+		total += cost;
+		peak = std::max(peak, cost);
+	}
+
+	FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+	FIBITMAP* raw = FreeImage_AllocateT(FIT_FLOAT, width, height);
+	if (!bitmap || !raw) {
+		std::cerr << "Error creando mapa de costo.\n";
+		if (bitmap) FreeImage_Unload(bitmap);
+		if (raw) FreeImage_Unload(raw);
+		return false;
+	}
+	for (int j = 0; j < height; ++j) {
+		float* raw_row = reinterpret_cast<float*>(FreeImage_GetScanLine(raw, height - 1 - j));
+		for (int i = 0; i < width; ++i) {
+			float cost = pixel_cost[size_t(j) * width + i];
+			RGBQUAD color = costColor(cost / scale_top);
+			FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+			raw_row[i] = cost;
+		}
+	}
+
+	bool saved = false;
+	std::time_t now = std::time(nullptr);
+	std::tm tm_info{};
+	if (localTime(now, tm_info)) {
+		std::ostringstream oss;
+		oss << "images/cost_map_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S");
+		std::string png_path = oss.str() + ".png";
+		std::string pfm_path = oss.str() + ".pfm";
+		saved = FreeImage_Save(FIF_PNG, bitmap, png_path.c_str(), 0) != 0;
+		saved = FreeImage_Save(FIF_PFM, raw, pfm_path.c_str(), 0) != 0 && saved;
+		if (saved) {
+			std::cout << "Mapa de costo guardado: " << png_path << " y " << pfm_path << std::endl;
+			std::cout << "  Costo por píxel: promedio " << total / pixel_cost.size() / 1000.0 << " us, percentil "
+				<< int(COST_MAP_PERCENTILE * 100) << " " << scale_top / 1000.0 << " us (blanco en la escala), máximo "
+				<< peak / 1000.0 << " us" << std::endl;
+		}
+		else {
+			std::cerr << "Error guardando mapa de costo.\n";
+		}
+	}
+	FreeImage_Unload(bitmap);
+	FreeImage_Unload(raw);
+	return saved;
+}
+
+std::vector<Color> ProgressiveRenderer::getImage() const {
+	std::vector<Color> image(size_t(width) * height);
+	for (const auto& tile : tiles) {
+		double scale = tile.samples > 0 ? 1.0 / tile.samples : 0.0;
+		for (int j = tile.y0; j < tile.y1; ++j) {
+			for (int i = tile.x0; i < tile.x1; ++i) {
+				size_t p = size_t(j) * width + i;
+				image[p] = Color(accumulation[p * 3 + 0] * scale, accumulation[p * 3 + 1] * scale, accumulation[p * 3 + 2] * scale);
+			}
+		}
+	}
+	return image;
+}
+
+bool ProgressiveRenderer::isFinished() const {
+	return finished;
+}
+
+int ProgressiveRenderer::getCompletedPasses() const {
+	return int(jobs_done.load() / tiles.size());
+}
+
+double ProgressiveRenderer::getAverageSamples() const {
+	return double(accumulated_samples.load()) / (double(width) * height);
+}
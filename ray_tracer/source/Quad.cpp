@@ -10,6 +10,7 @@
  */
 
 #include "Quad.h"
+#include "RenderStats.h"
 #include "Material.h"
 #include "HitRecord.h"
 #include <cmath>
@@ -33,6 +34,7 @@ Quad::Quad(const Vec3& minPoint, const Vec3& maxPoint, int axis, double value)
  * @return true si hay intersección, false en caso contrario
  */
 bool Quad::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const {
+    RenderStats::addKernel(RenderCounter::QuadTests);
     // Obtener los componentes del rayo
     Vec3 origin = ray.getOrigin();
     Vec3 direction = ray.getDirection();
@@ -89,6 +91,7 @@ bool Quad::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const {
     //rec.mat = material_ptr;
     rec.material_ptr = material_ptr;
     
+    RenderStats::addKernel(RenderCounter::QuadHits);
     return true;
 }
 
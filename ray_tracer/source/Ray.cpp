@@ -10,6 +10,7 @@
  */
 
 #include "Ray.h"
+#include <cmath>
 
 /**
  * @brief Constructor por defecto
@@ -48,3 +49,52 @@ Vec3 Ray::pointAtParameter(double t) const {
 	return origin + t * direction;
 }
 
+/**
+ * @brief Asigna los diferenciales del rayo
+ * @param rx_origin Origen del rayo desplazado en x
+ * @param rx_direction Dirección del rayo desplazado en x
+ * @param ry_origin Origen del rayo desplazado en y
+ * @param ry_direction Dirección del rayo desplazado en y
+ */
+void Ray::setDifferentials(const Vec3& rx_origin, const Vec3& rx_direction, const Vec3& ry_origin, const Vec3& ry_direction) {
+	this->rx_origin = rx_origin;
+	this->rx_direction = rx_direction;
+	this->ry_origin = ry_origin;
+	this->ry_direction = ry_direction;
+	has_differentials = true;
+}
+
+/**
+ * @brief Indica si el rayo tiene diferenciales
+ * @return true si se asignaron con setDifferentials
+ */
+bool Ray::hasDifferentials() const {
+	return has_differentials;
+}
+
+/**
+ * @brief Intersecta los rayos desplazados con el plano tangente en un punto de impacto
+ *
+ * Aproxima la superficie por su plano tangente, lo que alcanza para estimar la
+ * huella del píxel en la superficie.
+ *
+ * @param point Punto de intersección del rayo principal
+ * @param normal Normal de la superficie en ese punto
+ * @param px Punto de impacto del rayo desplazado en x
+ * @param py Punto de impacto del rayo desplazado en y
+ * @return false si el rayo no tiene diferenciales o son paralelos al plano
+ */
+bool Ray::differentialPoints(const Vec3& point, const Vec3& normal, Vec3& px, Vec3& py) const {
+	if (!has_differentials) {
+		return false;
+	}
+	double dx = dotProduct(normal, rx_direction);
+	double dy = dotProduct(normal, ry_direction);
+	if (std::abs(dx) < 1e-12 || std::abs(dy) < 1e-12) {
+		return false;
+	}
+	double d = dotProduct(normal, point);
+	px = rx_origin + ((d - dotProduct(normal, rx_origin)) / dx) * rx_direction;
+	py = ry_origin + ((d - dotProduct(normal, ry_origin)) / dy) * ry_direction;
+	return true;
+}
@@ -0,0 +1,282 @@
+#include "RenderServer.h"
+#include "Camera.h"
+#include "CancellationToken.h"
+#include "FreeImage.h"
+#include "LocalSocket.h"
+#include "MappedFile.h"
+#include "ProgressiveRenderer.h"
+#include "Scene.h"
+#include "SceneBundle.h"
+#include "SceneLoader.h"
+#include "TextureCache.h"
+#include "WhittedTracer.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+	const size_t MAX_CACHED_SCENES = 4;       ///< Escenas que se mantienen cargadas a la vez
+	const int MAX_IMAGE_WIDTH = 16384;
+	const int MAX_SAMPLES = 1 << 16;
+
+	bool parseVec3(const std::string& text, Vec3& out) {
+		double x, y, z;
+		if (std::sscanf(text.c_str(), "%lf,%lf,%lf", &x, &y, &z) != 3) return false;
+		out = Vec3(x, y, z);
+		return true;
+	}
+
+	bool sendImage(LocalConnection& connection, const std::string& header, const std::vector<uint8_t>& rgb) {
+		return connection.writeLine(header) && connection.writeBytes(rgb.data(), rgb.size());
+	}
+
+	bool savePNG(const std::vector<uint8_t>& rgb, int width, int height, const std::string& path) {
+		FIBITMAP* bitmap = FreeImage_Allocate(width, height, 24);
+		if (!bitmap) {
+			std::cerr << "Error creando imagen.\n";
+			return false;
+		}
+		for (int j = 0; j < height; ++j) {
+			for (int i = 0; i < width; ++i) {
+				const uint8_t* pixel = &rgb[(size_t(j) * width + i) * 3];
+				RGBQUAD color;
+				color.rgbRed = pixel[0];
+				color.rgbGreen = pixel[1];
+				color.rgbBlue = pixel[2];
+				FreeImage_SetPixelColor(bitmap, i, height - 1 - j, &color);
+			}
+		}
+		bool saved = FreeImage_Save(FIF_PNG, bitmap, path.c_str(), 0) != 0;
+		if (saved) {
+			std::cout << "Imagen guardada: " << path << std::endl;
+		}
+		else {
+			std::cerr << "Error guardando la imagen: " << path << std::endl;
+		}
+		FreeImage_Unload(bitmap);
+		return saved;
+	}
+}
+
+RenderServer::RenderServer()
+	: use_clock(0), cache_hits(0), cache_loads(0) {
+}
+
+RenderServer::~RenderServer() = default;
+
+bool RenderServer::run(const std::string& endpoint) {
+	LocalServer server;
+	if (!server.listen(endpoint)) {
+		std::cerr << "No se pudo escuchar en: " << endpoint << std::endl;
+		return false;
+	}
+	std::cout << "Servicio de render escuchando en " << endpoint << std::endl;
+
+	bool running = true;
+	while (running) {
+		LocalConnection connection;
+		if (!server.accept(connection)) {
+			std::cerr << "Error esperando clientes en: " << endpoint << std::endl;
+			return false;
+		}
+		running = handleConnection(connection);
+	}
+	std::cout << "Servicio de render detenido" << std::endl;
+	return true;
+}
+
+bool RenderServer::handleConnection(LocalConnection& connection) {
+	std::string line;
+	while (connection.readLine(line)) {
+		std::istringstream tokens(line);
+		std::string command;
+		tokens >> command;
+		if (command == "render") {
+			if (!handleRender(connection, line)) return true;
+		}
+		else if (command == "stats") {
+			std::ostringstream stats;
+			stats << "STATS escenas=" << scenes.size() << " aciertos=" << cache_hits
+				<< " cargas=" << cache_loads << " texturas=" << TextureCache::getInstance().size();
+			if (!connection.writeLine(stats.str())) return true;
+		}
+		else if (command == "shutdown") {
+			connection.writeLine("BYE");
+			return false;
+		}
+		else if (!command.empty()) {
+			if (!connection.writeLine("ERROR comando desconocido: " + command)) return true;
+		}
+	}
+	return true;
+}
+
+RenderServer::CachedScene* RenderServer::acquireScene(const std::string& path, bool& cache_hit) {
+	uint64_t size = 0;
+	int64_t mtime = 0;
+	if (!MappedFile::fileInfo(path, size, mtime)) return nullptr;
+
+	auto found = scenes.find(path);
+	cache_hit = found != scenes.end() && found->second.file_size == size && found->second.file_mtime == mtime;
+	if (cache_hit) {
+		++cache_hits;
+		found->second.last_use = ++use_clock;
+		return &found->second;
+	}
+
+	if (found != scenes.end()) {
+		scenes.erase(found);
+	}
+	else if (scenes.size() >= MAX_CACHED_SCENES) {
+		auto oldest = scenes.begin();
+		for (auto it = scenes.begin(); it != scenes.end(); ++it) {
+			if (it->second.last_use < oldest->second.last_use) oldest = it;
+		}
+		scenes.erase(oldest);
+	}
+	// Las texturas de la escena descartada (y de la versión anterior) dejan de ocupar memoria
+	TextureCache::getInstance().releaseUnused();
+
+	CachedScene entry;
+	entry.scene = SceneBundle::isBundle(path)
+		? SceneBundle::load(path, entry.camera, entry.tracer)
+		: SceneLoader::loadFromXML(path, entry.camera, entry.tracer);
+	if (!entry.scene || !entry.camera || !entry.tracer) return nullptr;
+	entry.file_size = size;
+	entry.file_mtime = mtime;
+	entry.last_use = ++use_clock;
+	++cache_loads;
+	CachedScene& stored = scenes[path];
+	stored = std::move(entry);
+	return &stored;
+}
+
+bool RenderServer::handleRender(LocalConnection& connection, const std::string& request) {
+	std::istringstream tokens(request);
+	std::string token;
+	tokens >> token;
+
+	std::string scene_path;
+	Vec3 eye, look_at, up;
+	bool has_eye = false, has_look_at = false, has_up = false;
+	int width = 0, spp = 0, progress_ms = 0;
+	double time_budget = 0.0, adaptive = 0.0;
+	while (tokens >> token) {
+		size_t equals = token.find('=');
+		std::string key = token.substr(0, equals);
+		std::string value = equals == std::string::npos ? "" : token.substr(equals + 1);
+		bool valid = true;
+		if (key == "scene") scene_path = value;
+		else if (key == "eye") valid = has_eye = parseVec3(value, eye);
+		else if (key == "look_at") valid = has_look_at = parseVec3(value, look_at);
+		else if (key == "up") valid = has_up = parseVec3(value, up);
+		else if (key == "width") valid = std::sscanf(value.c_str(), "%d", &width) == 1 && width > 0 && width <= MAX_IMAGE_WIDTH;
+		else if (key == "spp") valid = std::sscanf(value.c_str(), "%d", &spp) == 1 && spp > 0 && spp <= MAX_SAMPLES;
+		else if (key == "time_budget") valid = std::sscanf(value.c_str(), "%lf", &time_budget) == 1 && time_budget >= 0.0;
+		else if (key == "adaptive") valid = std::sscanf(value.c_str(), "%lf", &adaptive) == 1 && adaptive >= 0.0;
+		else if (key == "progress") valid = std::sscanf(value.c_str(), "%d", &progress_ms) == 1 && progress_ms >= 0;
+		else valid = false;
+		if (!valid) {
+			return connection.writeLine("ERROR parámetro inválido: " + token);
+		}
+	}
+	if (scene_path.empty()) {
+		return connection.writeLine("ERROR falta scene=<ruta>");
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	bool cache_hit = false;
+	CachedScene* cached = acquireScene(scene_path, cache_hit);
+	if (!cached) {
+		std::cerr << "Error al cargar la escena: " << scene_path << std::endl;
+		return connection.writeLine("ERROR no se pudo cargar la escena: " + scene_path);
+	}
+
+	// La cámara del archivo queda intacta para los próximos trabajos; se arma una con los cambios pedidos
+	Camera& base = *cached->camera;
+	Camera camera(has_eye ? eye : base.getEye(), has_look_at ? look_at : base.getLookAt(), has_up ? up : base.getUp(),
+		base.getAspectRatio(), width > 0 ? width : base.getImageWidth(), spp > 0 ? spp : base.getSamplesPerPixel());
+	camera.setSampler(base.getSampler());
+	double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	CancellationToken cancel_token;
+	ProgressiveRenderer renderer(*cached->tracer, *cached->scene, camera);
+	renderer.setTimeBudget(time_budget);
+	renderer.setAdaptiveThreshold(adaptive);
+	renderer.setCancellationToken(&cancel_token);
+	renderer.start();
+
+	// Mientras se traza se envían las imágenes parciales; si el cliente se desconecta se cancela el trabajo
+	std::vector<uint8_t> rgb;
+	bool connected = true;
+	auto last_frame = std::chrono::steady_clock::now();
+	while (!renderer.isFinished()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		auto now = std::chrono::steady_clock::now();
+		if (progress_ms > 0 && connected && now - last_frame >= std::chrono::milliseconds(progress_ms)) {
+			last_frame = now;
+			renderer.copyDisplay(rgb);
+			std::ostringstream header;
+			header << "FRAME " << camera.getImageWidth() << " " << camera.getImageHeight() << " " << renderer.getAverageSamples();
+			connected = sendImage(connection, header.str(), rgb);
+			if (!connected) cancel_token.cancel();
+		}
+	}
+	renderer.wait();
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	std::cout << "Trabajo " << scene_path << (cache_hit ? " (en caché)" : "") << ": carga " << load_seconds
+		<< " s, total " << seconds << " s" << std::endl;
+	if (!connected) return false;
+
+	renderer.copyDisplay(rgb);
+	std::ostringstream header;
+	header << "DONE " << camera.getImageWidth() << " " << camera.getImageHeight() << " "
+		<< renderer.getAverageSamples() << " " << seconds;
+	return sendImage(connection, header.str(), rgb);
+}
+
+bool RenderServer::submit(const std::string& endpoint, const std::string& request, const std::string& output_path) {
+	LocalConnection connection;
+	if (!connection.connect(endpoint)) {
+		std::cerr << "No se pudo conectar con el servicio de render: " << endpoint << std::endl;
+		return false;
+	}
+	if (!connection.writeLine(request)) {
+		std::cerr << "Error enviando la solicitud" << std::endl;
+		return false;
+	}
+
+	std::string line;
+	std::vector<uint8_t> rgb;
+	while (connection.readLine(line)) {
+		std::istringstream tokens(line);
+		std::string kind;
+		int width = 0, height = 0;
+		double samples = 0.0, seconds = 0.0;
+		tokens >> kind;
+		if (kind == "FRAME" || kind == "DONE") {
+			tokens >> width >> height >> samples >> seconds;
+			if (width <= 0 || height <= 0) break;
+			rgb.resize(size_t(width) * height * 3);
+			if (!connection.readBytes(rgb.data(), rgb.size())) break;
+			if (kind == "FRAME") {
+				std::cout << "Progreso: " << samples << " muestras por píxel" << std::endl;
+				continue;
+			}
+			std::cout << "Render terminado: " << samples << " muestras por píxel en " << seconds << " s" << std::endl;
+			return savePNG(rgb, width, height, output_path);
+		}
+		if (kind == "ERROR") {
+			std::cerr << "El servicio respondió: " << line << std::endl;
+			return false;
+		}
+		std::cout << line << std::endl;
+		return true;
+	}
+	std::cerr << "El servicio cerró la conexión antes de responder" << std::endl;
+	return false;
+}
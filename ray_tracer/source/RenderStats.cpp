@@ -0,0 +1,165 @@
+#include "RenderStats.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace {
+	const int COUNTER_COUNT = static_cast<int>(RenderCounter::Count);
+
+	const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+		"primary_rays", "scene_rays", "scene_hits", "reflection_rays", "refraction_rays", "shadow_rays",
+		"sphere_tests", "sphere_hits", "triangle_tests", "triangle_hits", "quad_tests", "quad_hits",
+		"cylinder_tests", "cylinder_hits", "bvh_node_visits", "aabb_tests", "max_depth"
+	};
+
+	// La profundidad máxima se combina con el máximo; el resto de los contadores se suman
+	void combine(RenderCounters& total, int k, uint64_t value) {
+		if (k == static_cast<int>(RenderCounter::MaxDepth)) {
+			total.values[k] = std::max(total.values[k], value);
+		}
+		else {
+			total.values[k] += value;
+		}
+	}
+
+	double ratio(uint64_t part, uint64_t whole) {
+		return whole > 0 ? double(part) / double(whole) : 0.0;
+	}
+}
+
+/**
+ * @brief Bloque de un hilo; al terminar el hilo sus valores pasan a los totales retirados
+ */
+struct RenderStatsThreadBlock {
+	RenderStats::Block block;
+
+	RenderStatsThreadBlock();
+	~RenderStatsThreadBlock();
+};
+
+namespace {
+	/**
+	 * @brief Bloques de los hilos vivos y suma de los que ya terminaron
+	 */
+	struct Registry {
+		std::mutex mutex;
+		std::vector<RenderStatsThreadBlock*> blocks;
+		RenderCounters retired;
+	};
+
+	Registry& registry() {
+		static Registry instance;
+		return instance;
+	}
+}
+
+thread_local RenderStats::Block* RenderStats::current = nullptr;
+
+RenderStatsThreadBlock::RenderStatsThreadBlock() {
+	for (int k = 0; k < COUNTER_COUNT; ++k) {
+		block.values[k].store(0, std::memory_order_relaxed);
+	}
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	reg.blocks.push_back(this);
+}
+
+RenderStatsThreadBlock::~RenderStatsThreadBlock() {
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	for (int k = 0; k < COUNTER_COUNT; ++k) {
+		combine(reg.retired, k, block.values[k].load(std::memory_order_relaxed));
+	}
+	reg.blocks.erase(std::remove(reg.blocks.begin(), reg.blocks.end(), this), reg.blocks.end());
+	RenderStats::current = nullptr;
+}
+
+RenderStats::Block& RenderStats::registerThread() {
+	// Se construye con el primer add() del hilo y se destruye cuando el hilo termina
+	static thread_local RenderStatsThreadBlock thread_block;
+	current = &thread_block.block;
+	return thread_block.block;
+}
+
+RenderCounters RenderStats::snapshot() {
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	RenderCounters total = reg.retired;
+	for (const RenderStatsThreadBlock* thread_block : reg.blocks) {
+		for (int k = 0; k < COUNTER_COUNT; ++k) {
+			combine(total, k, thread_block->block.values[k].load(std::memory_order_relaxed));
+		}
+	}
+	return total;
+}
+
+void RenderStats::reset() {
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	reg.retired = RenderCounters();
+	for (RenderStatsThreadBlock* thread_block : reg.blocks) {
+		for (int k = 0; k < COUNTER_COUNT; ++k) {
+			thread_block->block.values[k].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+const char* RenderStats::name(RenderCounter counter) {
+	return COUNTER_NAMES[static_cast<int>(counter)];
+}
+
+void RenderStats::print(std::ostream& os, const RenderCounters& c) {
+#if ICG_RENDER_STATS
+	uint64_t primary = c[RenderCounter::PrimaryRays];
+	os << "Estadísticas del render:" << std::endl;
+	os << "  Rayos: " << primary << " primarios, " << c[RenderCounter::ReflectionRays] << " reflejados, "
+		<< c[RenderCounter::RefractionRays] << " refractados, " << c[RenderCounter::ShadowRays] << " de sombra ("
+		<< std::fixed << std::setprecision(2) << ratio(c[RenderCounter::SceneRays] + c[RenderCounter::ShadowRays], primary)
+		<< " por rayo primario)" << std::endl;
+	os << "  Consultas a la escena: " << c[RenderCounter::SceneRays] << ", con acierto "
+		<< ratio(c[RenderCounter::SceneHits], c[RenderCounter::SceneRays]) * 100.0 << "%" << std::endl;
+	const struct { const char* label; RenderCounter tests; RenderCounter hits; } primitives[] = {
+		{ "esferas", RenderCounter::SphereTests, RenderCounter::SphereHits },
+		{ "triángulos", RenderCounter::TriangleTests, RenderCounter::TriangleHits },
+		{ "quads", RenderCounter::QuadTests, RenderCounter::QuadHits },
+		{ "cilindros", RenderCounter::CylinderTests, RenderCounter::CylinderHits },
+	};
+#if ICG_KERNEL_STATS
+	for (const auto& p : primitives) {
+		if (c[p.tests] == 0) continue;
+		os << "  Pruebas contra " << p.label << ": " << c[p.tests] << " (" << ratio(c[p.tests], primary)
+			<< " por rayo primario), aciertos " << ratio(c[p.hits], c[p.tests]) * 100.0 << "%" << std::endl;
+	}
+	os << "  Nodos del BVH visitados: " << c[RenderCounter::BVHNodeVisits] << ", pruebas de cajas: "
+		<< c[RenderCounter::AABBTests] << std::endl;
+#else
+	(void)primitives;
+	os << "  Pruebas de intersección sin contar (compilar con ICG_KERNEL_STATS=1)" << std::endl;
+#endif
+	os << "  Profundidad máxima de recursión: " << c[RenderCounter::MaxDepth] << std::endl;
+	os.unsetf(std::ios::fixed);
+	os << std::setprecision(6);
+#else
+	(void)c;
+	os << "Estadísticas del render deshabilitadas (compilado con ICG_RENDER_STATS=0)" << std::endl;
+#endif
+}
+
+bool RenderStats::writeJSON(const std::string& path, const RenderCounters& counters) {
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		std::cerr << "No se pudo escribir: " << path << std::endl;
+		return false;
+	}
+	file << "{\n";
+	file << "  \"enabled\": " << (ICG_RENDER_STATS ? "true" : "false");
+	file << ",\n  \"kernel_counters\": " << (ICG_RENDER_STATS && ICG_KERNEL_STATS ? "true" : "false");
+	for (int k = 0; k < COUNTER_COUNT; ++k) {
+		file << ",\n  \"" << COUNTER_NAMES[k] << "\": " << counters.values[k];
+	}
+	file << "\n}\n";
+	return bool(file);
+}
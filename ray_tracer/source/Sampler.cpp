@@ -0,0 +1,209 @@
+#include "Sampler.h"
+#include "Constants.h"
+#include <cmath>
+
+namespace {
+	// Secuencia R2 (Roberts, 2018): múltiplos de la inversa del número plástico, que
+	// generaliza la razón áurea a dos dimensiones
+	const double R2_A1 = 0.7548776662466927;
+	const double R2_A2 = 0.5698402909980532;
+
+	const double UINT32_TO_UNIT = 1.0 / 4294967296.0;
+
+	// Finalizador de splitmix64: mezcla bien incluso semillas consecutivas
+	uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	uint32_t pixelSeed(int i, int j) {
+		return uint32_t(mix((uint64_t(uint32_t(i)) << 32) | uint32_t(j)));
+	}
+
+	double fraction(double value) {
+		return value - std::floor(value);
+	}
+
+	uint32_t reverseBits(uint32_t x) {
+		x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+		x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+		x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+		x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+		return (x >> 16) | (x << 16);
+	}
+
+	/**
+	 * @brief Permutación de [0, length) elegida por pattern (Kensler, "Correlated Multi-Jittered Sampling")
+	 *
+	 * Cada paso es biyectivo sobre los bits de mask; los valores que caen fuera del rango
+	 * se vuelven a permutar hasta entrar.
+	 */
+	uint32_t permute(uint32_t i, uint32_t length, uint32_t pattern) {
+		uint32_t mask = length - 1;
+		mask |= mask >> 1;
+		mask |= mask >> 2;
+		mask |= mask >> 4;
+		mask |= mask >> 8;
+		mask |= mask >> 16;
+		do {
+			i ^= pattern;
+			i *= 0xe170893du;
+			i ^= pattern >> 16;
+			i ^= (i & mask) >> 4;
+			i ^= pattern >> 8;
+			i *= 0x0929eb3fu;
+			i ^= pattern >> 23;
+			i ^= (i & mask) >> 1;
+			i *= 1u | pattern >> 27;
+			i *= 0x6935fa69u;
+			i ^= (i & mask) >> 11;
+			i *= 0x74dcb303u;
+			i ^= (i & mask) >> 2;
+			i *= 0x9e501cc3u;
+			i ^= (i & mask) >> 2;
+			i *= 0xc860a3dfu;
+			i &= mask;
+			i ^= i >> 5;
+		} while (i >= length);
+		return (i + pattern) % length;
+	}
+
+	double hashToUnit(uint32_t i, uint32_t pattern) {
+		i ^= pattern;
+		i ^= i >> 17;
+		i ^= i >> 10;
+		i *= 0xb36534e5u;
+		i ^= i >> 12;
+		i ^= i >> 21;
+		i *= 0x93fc4795u;
+		i ^= 0xdf6e307fu;
+		i ^= i >> 17;
+		i *= 1u | pattern >> 18;
+		return i * UINT32_TO_UNIT;
+	}
+
+	void stratified(uint32_t index, int count, uint32_t seed, double& x, double& y) {
+		// Grilla de m x n celdas con m * n >= count; cada grilla completa usa otra permutación
+		uint32_t m = uint32_t(std::ceil(std::sqrt(double(count > 0 ? count : 1))));
+		uint32_t n = (uint32_t(count > 0 ? count : 1) + m - 1) / m;
+		uint32_t cells = m * n;
+		uint32_t pattern = uint32_t(mix(uint64_t(seed) + index / cells));
+		uint32_t s = permute(index % cells, cells, pattern * 0x51633e2du);
+		uint32_t sx = permute(s % m, m, pattern * 0x68bc21ebu);
+		uint32_t sy = permute(s / m, n, pattern * 0x02e5be93u);
+		double jx = hashToUnit(s, pattern * 0x967a889bu);
+		double jy = hashToUnit(s, pattern * 0x368cc8b7u);
+		x = ((s % m) + (sy + jx) / n) / m;
+		y = ((s / m) + (sx + jy) / m) / n;
+	}
+
+	double radicalInverse(uint64_t index, uint64_t base) {
+		double inverse_base = 1.0 / double(base);
+		double factor = inverse_base;
+		double result = 0.0;
+		while (index > 0) {
+			result += double(index % base) * factor;
+			index /= base;
+			factor *= inverse_base;
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Scrambling de Owen aproximado con un hash (Laine y Karras, 2011; Burley, 2020)
+	 *
+	 * Los bits se invierten para que el hash, que sólo propaga hacia los bits altos, haga
+	 * depender cada dígito de los más significativos, como en el árbol de Owen.
+	 */
+	uint32_t owenScramble(uint32_t x, uint32_t seed) {
+		x = reverseBits(x);
+		x += seed;
+		x ^= x * 0x6c50b47cu;
+		x ^= x * 0xb82f1e52u;
+		x ^= x * 0xc7afe638u;
+		x ^= x * 0x8d22f6e6u;
+		return reverseBits(x);
+	}
+
+	// Dimensión 0 de Sobol: el índice con los bits invertidos (van der Corput)
+	uint32_t sobol0(uint32_t index) {
+		return reverseBits(index);
+	}
+
+	// Dimensión 1 de Sobol, polinomio x + 1: cada número de dirección es el anterior
+	// combinado con sí mismo desplazado un bit
+	uint32_t sobol1(uint32_t index) {
+		uint32_t result = 0;
+		for (uint32_t direction = 0x80000000u; index != 0; index >>= 1, direction ^= direction >> 1) {
+			if (index & 1u) result ^= direction;
+		}
+		return result;
+	}
+
+	void sobol(uint32_t index, uint32_t seed, double& x, double& y) {
+		// Mezclar también el índice desordena el orden de las muestras en cada píxel sin
+		// perder la estratificación de los prefijos de potencias de dos
+		uint32_t shuffled = owenScramble(index, uint32_t(mix(seed)));
+		x = owenScramble(sobol0(shuffled), uint32_t(mix(uint64_t(seed) + 1))) * UINT32_TO_UNIT;
+		y = owenScramble(sobol1(shuffled), uint32_t(mix(uint64_t(seed) + 2))) * UINT32_TO_UNIT;
+	}
+
+	void blueNoise(uint64_t index, int i, int j, double& x, double& y) {
+		// Sin una textura de ruido azul precomputada se usa como máscara la propia R2 en el
+		// plano de la imagen y el ruido de gradiente entrelazado (Jimenez, 2014): píxeles
+		// vecinos reciben desplazamientos muy distintos, así el error queda en frecuencias altas
+		double mask_x = fraction(R2_A1 * i + R2_A2 * j);
+		double mask_y = fraction(52.9829189 * fraction(0.06711056 * i + 0.00583715 * j));
+		double n = double(index % (uint64_t(1) << 40));
+		x = fraction(0.5 + R2_A1 * n + mask_x);
+		y = fraction(0.5 + R2_A2 * n + mask_y);
+	}
+}
+
+bool Sampler::parseType(const std::string& name, SamplerType& type) {
+	const SamplerType types[] = { SamplerType::Random, SamplerType::Stratified, SamplerType::Halton, SamplerType::Sobol, SamplerType::BlueNoise };
+	for (SamplerType candidate : types) {
+		if (name == Sampler::name(candidate)) {
+			type = candidate;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* Sampler::name(SamplerType type) {
+	switch (type) {
+	case SamplerType::Random: return "random";
+	case SamplerType::Stratified: return "stratified";
+	case SamplerType::Halton: return "halton";
+	case SamplerType::Sobol: return "sobol";
+	case SamplerType::BlueNoise: return "bluenoise";
+	}
+	return "";
+}
+
+void Sampler::sample(SamplerType type, int i, int j, uint64_t index, int count, double& x, double& y) {
+	switch (type) {
+	case SamplerType::Stratified:
+		stratified(uint32_t(index), count, pixelSeed(i, j), x, y);
+		return;
+	case SamplerType::Halton: {
+		// Rotación de Cranley-Patterson: la misma secuencia desplazada (módulo 1) en cada píxel
+		uint32_t seed = pixelSeed(i, j);
+		x = fraction(radicalInverse(index + 1, 2) + hashToUnit(seed, 0x8e1d2a3bu));
+		y = fraction(radicalInverse(index + 1, 3) + hashToUnit(seed, 0x1f9c6e57u));
+		return;
+	}
+	case SamplerType::Sobol:
+		sobol(uint32_t(index), pixelSeed(i, j), x, y);
+		return;
+	case SamplerType::BlueNoise:
+		blueNoise(index, i, j, x, y);
+		return;
+	case SamplerType::Random:
+		break;
+	}
+	x = random_double();
+	y = random_double();
+}
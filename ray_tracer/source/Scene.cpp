@@ -17,6 +17,7 @@
 #include "EntityList.h"
 #include "Material.h"
 #include "MaterialGlass.h"
+#include "RenderStats.h"
 #include <algorithm>
 #include <LambertianMaterial.h>
 
@@ -70,11 +71,17 @@ bool Scene::is_in_shadow(const Ray& shadow_ray, const Vec3& light_position) cons
  * @return true si hay intersección, false en caso contrario
  */
 bool Scene::hit(const Ray& ray, const Interval& ray_t, HitRecord& rec) const {
-    return world->hit(ray, ray_t, rec);
+    RenderStats::add(RenderCounter::SceneRays);
+    bool hit = world->hit(ray, ray_t, rec);
+    if (hit) {
+        RenderStats::add(RenderCounter::SceneHits);
+    }
+    return hit;
 }
 
 Color Scene::transmissionAlong(const Ray& shadow_ray, double distance) const
 {
+    RenderStats::add(RenderCounter::ShadowRays);
     Color transmission(1.0, 1.0, 1.0);
     HitRecord rec;
     std::shared_ptr<EntityList> entities = std::dynamic_pointer_cast<EntityList>(world);
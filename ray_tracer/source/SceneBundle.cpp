@@ -0,0 +1,318 @@
+#include "SceneBundle.h"
+#include "SceneLoader.h"
+#include "ObjectLoader.h"
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "BinaryStream.h"
+#include "Texture.h"
+#include "TextureCache.h"
+#include "Mesh.h"
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	const char BUNDLE_MAGIC[8] = { 'I', 'C', 'G', 'S', 'C', 'E', 'N', 'E' };
+	const uint32_t BUNDLE_VERSION = 5;
+	const std::string BUNDLE_EXTENSION = ".icgscene";
+
+	// Los texels (con todos sus mipmaps) se guardan ya codificados en el formato de la
+	// textura, así que cargarlos es una copia directa y el resultado es idéntico al de leer la imagen
+	void writeTexture(BinaryWriter& out, const Texture& texture) {
+		uint32_t level_count = texture.isLoaded() ? uint32_t(texture.getLevelCount()) : 0;
+		out.write(uint32_t(texture.getFormat()));
+		out.write(uint32_t(texture.getLayout()));
+		out.write(level_count);
+		for (uint32_t i = 0; i < level_count; ++i) {
+			const Texture::MipLevel& level = texture.getLevel(int(i));
+			out.write(int32_t(level.width));
+			out.write(int32_t(level.height));
+			out.write(uint64_t(level.texels.size()));
+			out.writeBytes(level.texels.data(), level.texels.size() * sizeof(uint32_t));
+		}
+	}
+
+	bool readTexture(BinaryReader& in, Texture& texture) {
+		uint32_t format, layout, level_count;
+		if (!in.read(format) || format > uint32_t(TextureFormat::Normal)
+			|| !in.read(layout) || layout > uint32_t(TextureLayout::Morton)
+			|| !in.read(level_count) || level_count > 64) {
+			return false;
+		}
+		std::vector<Texture::MipLevel> levels(level_count);
+		for (auto& level : levels) {
+			int32_t width, height;
+			if (!in.read(width) || !in.read(height) || width < 0 || height < 0) return false;
+			// La cantidad de palabras depende del relleno del layout, así que se guarda explícita
+			uint64_t words;
+			if (!in.read(words) || !in.canRead(words, sizeof(uint32_t))) return false;
+			level.width = width;
+			level.height = height;
+			level.texels.resize(words);
+			in.readBytes(level.texels.data(), words * sizeof(uint32_t));
+		}
+		// Una textura que no se pudo cargar al compilar se guarda sin niveles y queda vacía
+		texture = level_count > 0 ? Texture(TextureFormat(format), TextureLayout(layout), std::move(levels)) : Texture();
+		return level_count == 0 || texture.isLoaded();
+	}
+}
+
+bool SceneBundle::isBundle(const std::string& path) {
+	return path.size() >= BUNDLE_EXTENSION.size()
+		&& path.compare(path.size() - BUNDLE_EXTENSION.size(), BUNDLE_EXTENSION.size(), BUNDLE_EXTENSION) == 0;
+}
+
+bool SceneBundle::compile(const std::string& xml_path, const std::string& bundle_path) {
+	auto start = std::chrono::steady_clock::now();
+
+	SceneDescription desc;
+	if (!SceneLoader::parseXML(xml_path, desc)) {
+		std::cerr << "No se pudo leer la escena: " << xml_path << std::endl;
+		return false;
+	}
+
+	std::string temp_path = bundle_path + ".tmp";
+	std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		std::cerr << "No se pudo crear el archivo: " << bundle_path << std::endl;
+		return false;
+	}
+	BinaryWriter out(file);
+
+	out.writeBytes(BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC));
+	out.write(BUNDLE_VERSION);
+	out.write(uint32_t(0));
+
+	// Cámara y tracer
+	out.write(desc.aspect);
+	out.write(int32_t(desc.width));
+	out.write(int32_t(desc.samples));
+	out.writeVec3(desc.eye);
+	out.writeVec3(desc.look_at);
+	out.writeVec3(desc.up);
+	out.write(int32_t(desc.max_depth));
+	out.write(desc.bias);
+
+	// Texturas ya decodificadas; las paginadas sólo guardan sus opciones y se leen de su archivo de bloques
+	out.write(uint32_t(desc.textures.size()));
+	for (const auto& t : desc.textures) {
+		out.writeString(t.path);
+		out.write(uint32_t(t.paged ? 1 : 0));
+		if (t.paged) {
+			out.write(uint32_t(t.format));
+			out.write(uint32_t(t.layout));
+			continue;
+		}
+		auto texture = TextureCache::getInstance().get(t.path, t.format, t.layout);
+		if (!texture->isLoaded()) {
+			std::cerr << "Advertencia: la textura " << t.path << " no se pudo cargar y queda vacía en el bundle" << std::endl;
+		}
+		writeTexture(out, *texture);
+	}
+
+	// Materiales
+	out.write(uint32_t(desc.materials.size()));
+	for (const auto& m : desc.materials) {
+		out.write(uint32_t(m.type));
+		out.writeColor(m.ambient);
+		out.writeColor(m.diffuse);
+		out.writeColor(m.specular);
+		out.writeColor(m.albedo);
+		out.write(m.shininess);
+		out.write(m.ior);
+		out.write(int32_t(m.texture));
+	}
+
+	// Mallas con su BVH
+	out.write(uint32_t(desc.meshes.size()));
+	for (const auto& m : desc.meshes) {
+		MeshData data;
+		std::vector<BVH::Node> nodes;
+		std::vector<int> order;
+		bool from_cache;
+		if (!ObjectLoader::loadObjData(m.path, m.scale, m.translate, data, nodes, order, from_cache)) {
+			file.close();
+			std::remove(temp_path.c_str());
+			return false;
+		}
+		auto mesh = std::make_shared<Mesh>(data, nullptr, std::move(nodes), order);
+		out.writeString(m.path);
+		out.writeVec3(m.scale);
+		out.writeVec3(m.translate);
+		MeshCache::writeMesh(out, data, mesh->getBVH());
+	}
+
+	// Entidades
+	out.write(uint32_t(desc.entities.size()));
+	for (const auto& e : desc.entities) {
+		out.write(uint32_t(e.type));
+		out.writeVec3(e.center);
+		out.writeVec3(e.min);
+		out.writeVec3(e.max);
+		out.write(e.radius);
+		out.write(e.y0);
+		out.write(e.y1);
+		out.write(e.value);
+		out.write(int32_t(e.axis));
+		out.write(int32_t(e.material));
+		out.write(int32_t(e.mesh));
+	}
+
+	// Luces
+	out.write(uint32_t(desc.lights.size()));
+	for (const auto& l : desc.lights) {
+		out.writeVec3(l.position);
+		out.writeColor(l.intensity);
+	}
+
+	bool ok = out.good();
+	file.close();
+	std::remove(bundle_path.c_str());
+	if (!ok || std::rename(temp_path.c_str(), bundle_path.c_str()) != 0) {
+		std::remove(temp_path.c_str());
+		std::cerr << "Error escribiendo el bundle: " << bundle_path << std::endl;
+		return false;
+	}
+
+	double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Escena compilada: " << bundle_path << " (" << desc.materials.size() << " materiales, "
+		<< desc.entities.size() << " entidades, " << desc.textures.size() << " texturas, "
+		<< desc.meshes.size() << " mallas) en " << elapsed_ms << " ms" << std::endl;
+	return true;
+}
+
+std::shared_ptr<Scene> SceneBundle::load(const std::string& bundle_path,
+	std::unique_ptr<Camera>& out_camera,
+	std::unique_ptr<WhittedTracer>& out_tracer) {
+	TraceScope trace("SceneBundle::load", "carga");
+	trace.arg("archivo", bundle_path);
+	auto start = std::chrono::steady_clock::now();
+
+	MappedFile file;
+	if (!file.open(bundle_path)) {
+		std::cerr << "No se pudo abrir el bundle: " << bundle_path << std::endl;
+		return nullptr;
+	}
+
+	BinaryReader in(file.data(), file.size());
+	auto fail = [&]() -> std::shared_ptr<Scene> {
+		std::cerr << "Bundle inválido o de otra versión: " << bundle_path << std::endl;
+		return nullptr;
+	};
+
+	char magic[8];
+	uint32_t version, reserved;
+	if (!in.readBytes(magic, sizeof(magic)) || std::memcmp(magic, BUNDLE_MAGIC, sizeof(magic)) != 0
+		|| !in.read(version) || version != BUNDLE_VERSION || !in.read(reserved)) {
+		return fail();
+	}
+
+	SceneDescription desc;
+	int32_t width, samples, max_depth;
+	if (!in.read(desc.aspect) || !in.read(width) || !in.read(samples)
+		|| !in.readVec3(desc.eye) || !in.readVec3(desc.look_at) || !in.readVec3(desc.up)
+		|| !in.read(max_depth) || !in.read(desc.bias)) {
+		return fail();
+	}
+	desc.width = width;
+	desc.samples = samples;
+	desc.max_depth = max_depth;
+	if (desc.aspect <= 0 || desc.width <= 0 || desc.samples <= 0 || desc.max_depth < 0 || desc.bias < 0) {
+		return fail();
+	}
+
+	uint32_t count;
+	std::vector<std::shared_ptr<const Texture>> textures;
+	if (!in.read(count)) return fail();
+	for (uint32_t i = 0; i < count; ++i) {
+		std::string path;
+		uint32_t paged;
+		if (!in.readString(path) || !in.read(paged)) return fail();
+		SceneDescription::TextureDesc t;
+		t.path = path;
+		if (paged) {
+			uint32_t format, layout;
+			if (!in.read(format) || format > uint32_t(TextureFormat::Normal)
+				|| !in.read(layout) || layout > uint32_t(TextureLayout::Morton)) {
+				return fail();
+			}
+			t.format = TextureFormat(format);
+			t.layout = TextureLayout(layout);
+			t.paged = true;
+			desc.textures.push_back(t);
+			textures.push_back(TextureCache::getInstance().get(t.path, t.format, t.layout, true));
+			continue;
+		}
+		Texture texture;
+		if (!readTexture(in, texture)) return fail();
+		t.format = texture.getFormat();
+		t.layout = texture.getLayout();
+		desc.textures.push_back(t);
+		// Si otra escena ya cargó la misma imagen se comparte la textura existente
+		textures.push_back(TextureCache::getInstance().insert(path, std::move(texture)));
+	}
+
+	if (!in.read(count)) return fail();
+	for (uint32_t i = 0; i < count; ++i) {
+		SceneDescription::MaterialDesc m;
+		uint32_t type;
+		int32_t texture;
+		if (!in.read(type) || type > uint32_t(SceneDescription::MaterialType::NormalMapped)
+			|| !in.readColor(m.ambient) || !in.readColor(m.diffuse) || !in.readColor(m.specular) || !in.readColor(m.albedo)
+			|| !in.read(m.shininess) || !in.read(m.ior) || !in.read(texture)) {
+			return fail();
+		}
+		m.type = SceneDescription::MaterialType(type);
+		m.texture = texture;
+		desc.materials.push_back(m);
+	}
+
+	std::vector<std::shared_ptr<Mesh>> meshes;
+	if (!in.read(count)) return fail();
+	for (uint32_t i = 0; i < count; ++i) {
+		SceneDescription::MeshDesc m;
+		MeshData data;
+		std::vector<BVH::Node> nodes;
+		std::vector<int> order;
+		if (!in.readString(m.path) || !in.readVec3(m.scale) || !in.readVec3(m.translate)
+			|| !MeshCache::readMesh(in, data, nodes, order)) {
+			return fail();
+		}
+		desc.meshes.push_back(m);
+		meshes.push_back(std::make_shared<Mesh>(data, nullptr, std::move(nodes), order));
+	}
+
+	if (!in.read(count)) return fail();
+	for (uint32_t i = 0; i < count; ++i) {
+		SceneDescription::EntityDesc e;
+		uint32_t type;
+		int32_t axis, material, mesh;
+		if (!in.read(type) || type > uint32_t(SceneDescription::EntityType::Mesh)
+			|| !in.readVec3(e.center) || !in.readVec3(e.min) || !in.readVec3(e.max)
+			|| !in.read(e.radius) || !in.read(e.y0) || !in.read(e.y1) || !in.read(e.value)
+			|| !in.read(axis) || !in.read(material) || !in.read(mesh)) {
+			return fail();
+		}
+		e.type = SceneDescription::EntityType(type);
+		e.axis = axis;
+		e.material = material;
+		e.mesh = mesh;
+		desc.entities.push_back(e);
+	}
+
+	if (!in.read(count)) return fail();
+	for (uint32_t i = 0; i < count; ++i) {
+		SceneDescription::LightDesc l;
+		if (!in.readVec3(l.position) || !in.readColor(l.intensity)) return fail();
+		desc.lights.push_back(l);
+	}
+
+	auto scene = SceneLoader::buildScene(desc, out_camera, out_tracer, textures, meshes);
+
+	double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Escena cargada desde bundle: " << bundle_path << " en " << elapsed_ms << " ms" << std::endl;
+	return scene;
+}
@@ -10,10 +10,12 @@
 #include "Camera.h"
 #include "WhittedTracer.h"
 #include "MaterialTextured.h"
+#include "TextureCache.h"
 #include "Texture.h"
 #include "Triangle.h"
 #include "Mesh.h"
 #include "ObjectLoader.h"
+#include "Trace.h"
 #include <fstream>
 #include <sstream>
 #include <unordered_map>
@@ -36,28 +38,59 @@ static double parseDouble(const std::string& value) {
     return std::stod(value);
 }
 
-// Mapa global de materiales por ID
-static std::unordered_map<std::string, std::shared_ptr<Material>> materialMap;
+// ndice de una textura en la descripcin (la misma ruta con las mismas opciones comparte ndice)
+static int textureIndex(SceneDescription& desc, const std::string& path, TextureFormat format, const std::string& line) {
+    TextureLayout layout = TextureLayout::Linear;
+    std::string layout_name = getAttribute(line, "layout");
+    if (!layout_name.empty() && !Texture::parseLayout(layout_name, layout)) {
+        std::cerr << "Layout de textura desconocido: " << layout_name << ", se usa linear" << std::endl;
+    }
+    bool paged = getAttribute(line, "paged") == "true";
+
+    for (size_t i = 0; i < desc.textures.size(); ++i) {
+        const auto& t = desc.textures[i];
+        if (t.path == path && t.format == format && t.layout == layout && t.paged == paged) return static_cast<int>(i);
+    }
+    SceneDescription::TextureDesc texture;
+    texture.path = path;
+    texture.format = format;
+    texture.layout = layout;
+    texture.paged = paged;
+    desc.textures.push_back(texture);
+    return static_cast<int>(desc.textures.size() - 1);
+}
+
+// Formato de almacenamiento pedido en el atributo format (rgba8 si no se indica)
+static TextureFormat textureFormat(const std::string& line) {
+    std::string name = getAttribute(line, "format");
+    TextureFormat format = TextureFormat::RGBA8;
+    if (!name.empty() && !Texture::parseFormat(name, format)) {
+        std::cerr << "Formato de textura desconocido: " << name << ", se usa rgba8" << std::endl;
+    }
+    return format;
+}
 
 std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std::unique_ptr<Camera>& out_camera, std::unique_ptr<WhittedTracer>& out_tracer)
 {
-    auto world = std::make_shared<EntityList>();
-    auto scene = std::make_shared<Scene>(world);
+    TraceScope trace("SceneLoader::loadFromXML", "carga");
+    trace.arg("archivo", filename);
+    SceneDescription desc;
+    if (!parseXML(filename, desc)) {
+        return nullptr;
+    }
+    return buildScene(desc, out_camera, out_tracer);
+}
 
+bool SceneLoader::parseXML(const std::string& filename, SceneDescription& desc)
+{
     std::ifstream file(filename);
     if (!file.is_open()) {
-        return nullptr;
+        return false;
     }
 
     std::string line;
     std::vector<std::string> lines;
-    double aspect = -1.0;
-    int width = -1;
-    int samples = -1;
     bool hasEye = false, hasLookAt = false, hasUp = false;
-    Vec3 eye, lookAt, up;
-    int max_depth = -1;
-    double bias = -1.0;
 
     while (std::getline(file, line)) {
         lines.push_back(line);
@@ -66,12 +99,12 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
 
     for (const std::string& line : lines) {
         if (line.find("<camera") != std::string::npos) {
-            aspect = parseDouble(getAttribute(line, "aspect"));
-            width = std::stoi(getAttribute(line, "width"));
-            samples = std::stoi(getAttribute(line, "samples"));
+            desc.aspect = parseDouble(getAttribute(line, "aspect"));
+            desc.width = std::stoi(getAttribute(line, "width"));
+            desc.samples = std::stoi(getAttribute(line, "samples"));
         }
         else if (line.find("<position") != std::string::npos) {
-            eye = Vec3(
+            desc.eye = Vec3(
                 parseDouble(getAttribute(line, "x")),
                 parseDouble(getAttribute(line, "y")),
                 parseDouble(getAttribute(line, "z"))
@@ -79,7 +112,7 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
             hasEye = true;
         }
         else if (line.find("<lookat") != std::string::npos) {
-            lookAt = Vec3(
+            desc.look_at = Vec3(
                 parseDouble(getAttribute(line, "x")),
                 parseDouble(getAttribute(line, "y")),
                 parseDouble(getAttribute(line, "z"))
@@ -87,7 +120,7 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
             hasLookAt = true;
         }
         else if (line.find("<up") != std::string::npos) {
-            up = Vec3(
+            desc.up = Vec3(
                 parseDouble(getAttribute(line, "x")),
                 parseDouble(getAttribute(line, "y")),
                 parseDouble(getAttribute(line, "z"))
@@ -95,80 +128,85 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
             hasUp = true;
         }
         else if (line.find("<tracer") != std::string::npos) {
-            max_depth = std::stoi(getAttribute(line, "depth"));
-            bias = parseDouble(getAttribute(line, "bias"));
+            desc.max_depth = std::stoi(getAttribute(line, "depth"));
+            desc.bias = parseDouble(getAttribute(line, "bias"));
         }
     }
-    if (!hasEye || !hasLookAt || !hasUp || aspect <= 0 || width <= 0 || samples <= 0 || max_depth < 0 || bias < 0) {
+    if (!hasEye || !hasLookAt || !hasUp || desc.aspect <= 0 || desc.width <= 0 || desc.samples <= 0 || desc.max_depth < 0 || desc.bias < 0) {
         std::cerr << "ERROR: El XML debe definir <camera>, <position>, <lookat>, <up>, y <tracer> correctamente.\n";
-        return nullptr;
+        return false;
     }
-    out_camera = std::make_unique<Camera>(eye, lookAt, up, aspect, width, samples);
-    out_tracer = std::make_unique<WhittedTracer>(max_depth, bias);
+
+    // Mapa de materiales por ID (ndices en desc.materials)
+    std::unordered_map<std::string, int> materialMap;
+    auto addMaterial = [&](const std::string& id, const SceneDescription::MaterialDesc& mat) {
+        desc.materials.push_back(mat);
+        materialMap[id] = static_cast<int>(desc.materials.size() - 1);
+    };
+    auto findMaterial = [&](const std::string& id) {
+        auto it = materialMap.find(id);
+        return it != materialMap.end() ? it->second : -1;
+    };
 
     for (const std::string& line : lines) {
         if (line.find("<lambertian") != std::string::npos) {
             std::string id = getAttribute(line, "id");
-            Color ambient(parseDouble(getAttribute(line, "ambientR")),
+            SceneDescription::MaterialDesc mat;
+            mat.type = SceneDescription::MaterialType::Lambertian;
+            mat.ambient = Color(parseDouble(getAttribute(line, "ambientR")),
                 parseDouble(getAttribute(line, "ambientG")),
                 parseDouble(getAttribute(line, "ambientB")));
-            Color diffuse(parseDouble(getAttribute(line, "diffuseR")),
+            mat.diffuse = Color(parseDouble(getAttribute(line, "diffuseR")),
                 parseDouble(getAttribute(line, "diffuseG")),
                 parseDouble(getAttribute(line, "diffuseB")));
-            Color specular(parseDouble(getAttribute(line, "specularR")),
+            mat.specular = Color(parseDouble(getAttribute(line, "specularR")),
                 parseDouble(getAttribute(line, "specularG")),
                 parseDouble(getAttribute(line, "specularB")));
-            double shininess = parseDouble(getAttribute(line, "shininess"));
-
-            auto mat = std::make_shared<LambertianMaterial>(ambient, diffuse, specular, shininess);
-            materialMap[id] = mat;
+            mat.shininess = parseDouble(getAttribute(line, "shininess"));
+            addMaterial(id, mat);
         }
         else if (line.find("<mirror") != std::string::npos) {
             std::string id = getAttribute(line, "id");
-            Color albedo(parseDouble(getAttribute(line, "albedoR")),
+            SceneDescription::MaterialDesc mat;
+            mat.type = SceneDescription::MaterialType::Mirror;
+            mat.albedo = Color(parseDouble(getAttribute(line, "albedoR")),
                 parseDouble(getAttribute(line, "albedoG")),
                 parseDouble(getAttribute(line, "albedoB")));
-            auto mat = std::make_shared<MaterialMirror>(albedo, *out_tracer);
-            materialMap[id] = mat;
+            addMaterial(id, mat);
         }
         else if (line.find("<glass") != std::string::npos) {
             std::string id = getAttribute(line, "id");
-            Color albedo(parseDouble(getAttribute(line, "albedoR")),
+            SceneDescription::MaterialDesc mat;
+            mat.type = SceneDescription::MaterialType::Glass;
+            mat.albedo = Color(parseDouble(getAttribute(line, "albedoR")),
                 parseDouble(getAttribute(line, "albedoG")),
                 parseDouble(getAttribute(line, "albedoB")));
-            double ior = parseDouble(getAttribute(line, "ior"));
-            auto mat = std::make_shared<MaterialGlass>(albedo, ior, *out_tracer);
-            materialMap[id] = mat;
+            mat.ior = parseDouble(getAttribute(line, "ior"));
+            addMaterial(id, mat);
         }
 
         // Entidades
         else if (line.find("<sphere") != std::string::npos) {
-            Vec3 center(parseDouble(getAttribute(line, "cx")),
+            SceneDescription::EntityDesc entity;
+            entity.type = SceneDescription::EntityType::Sphere;
+            entity.center = Vec3(parseDouble(getAttribute(line, "cx")),
                 parseDouble(getAttribute(line, "cy")),
                 parseDouble(getAttribute(line, "cz")));
-            double radius = parseDouble(getAttribute(line, "radius"));
-            std::string mat_id = getAttribute(line, "material");
-
-            auto sphere = std::make_shared<Sphere>(center, radius);
-            if (materialMap.count(mat_id)) {
-                sphere->setMaterial(materialMap[mat_id]);
-            }
-            world->addEntity(sphere);
+            entity.radius = parseDouble(getAttribute(line, "radius"));
+            entity.material = findMaterial(getAttribute(line, "material"));
+            desc.entities.push_back(entity);
         }
         else if (line.find("<cylinder") != std::string::npos) {
-            Vec3 center(parseDouble(getAttribute(line, "cx")),
+            SceneDescription::EntityDesc entity;
+            entity.type = SceneDescription::EntityType::Cylinder;
+            entity.center = Vec3(parseDouble(getAttribute(line, "cx")),
                 parseDouble(getAttribute(line, "cy")),
                 parseDouble(getAttribute(line, "cz")));
-            double y0 = parseDouble(getAttribute(line, "y0"));
-            double y1 = parseDouble(getAttribute(line, "y1"));
-            double radius = parseDouble(getAttribute(line, "radius"));
-            std::string mat_id = getAttribute(line, "material");
-
-            auto cyl = std::make_shared<Cylinder>(center, y0, y1, radius);
-            if (materialMap.count(mat_id)) {
-                cyl->setMaterial(materialMap[mat_id]);
-            }
-            world->addEntity(cyl);
+            entity.y0 = parseDouble(getAttribute(line, "y0"));
+            entity.y1 = parseDouble(getAttribute(line, "y1"));
+            entity.radius = parseDouble(getAttribute(line, "radius"));
+            entity.material = findMaterial(getAttribute(line, "material"));
+            desc.entities.push_back(entity);
         }
         else if (line.find("<quad") != std::string::npos) {
             Vec3 minP, maxP;
@@ -195,37 +233,40 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
             maxP.setY(maxY);
             maxP.setZ(maxZ);
 
-            auto quad = std::make_shared<Quad>(minP, maxP, axis, value);
-            if (materialMap.count(mat_id)) {
-                quad->setMaterial(materialMap[mat_id]);
-            }
-            world->addEntity(quad);
+            SceneDescription::EntityDesc entity;
+            entity.type = SceneDescription::EntityType::Quad;
+            entity.min = minP;
+            entity.max = maxP;
+            entity.axis = axis;
+            entity.value = value;
+            entity.material = findMaterial(mat_id);
+            desc.entities.push_back(entity);
         }
         else if (line.find("<point") != std::string::npos) {
-            Vec3 position(
+            SceneDescription::LightDesc light;
+            light.position = Vec3(
                 parseDouble(getAttribute(line, "x")),
                 parseDouble(getAttribute(line, "y")),
                 parseDouble(getAttribute(line, "z"))
             );
-            Color intensity(
+            light.intensity = Color(
                 parseDouble(getAttribute(line, "r")),
                 parseDouble(getAttribute(line, "g")),
                 parseDouble(getAttribute(line, "b"))
             );
-            auto light = std::make_shared<PointLight>(position, intensity);
-            scene->addLight(light);
+            desc.lights.push_back(light);
         }
         else if (line.find("<textured") != std::string::npos) {
             std::string id = getAttribute(line, "id");
-            std::string texturePath = getAttribute(line, "path");
-            double shininess = parseDouble(getAttribute(line, "shininess"));
-            Texture texture(texturePath);
-            auto mat = std::make_shared<MaterialTextured>(texture, shininess);
-            materialMap[id] = mat;
+            SceneDescription::MaterialDesc mat;
+            mat.type = SceneDescription::MaterialType::Textured;
+            mat.texture = textureIndex(desc, getAttribute(line, "path"), textureFormat(line), line);
+            mat.shininess = parseDouble(getAttribute(line, "shininess"));
+            addMaterial(id, mat);
         }
         else if (line.find("<mesh") != std::string::npos) {
-            std::string path = getAttribute(line, "path");
-            std::string mat_id = getAttribute(line, "material");
+            SceneDescription::MeshDesc mesh;
+            mesh.path = getAttribute(line, "path");
 
             double sx = parseDouble(getAttribute(line, "scaleX"));
             double sy = parseDouble(getAttribute(line, "scaleY"));
@@ -234,40 +275,127 @@ std::shared_ptr<Scene> SceneLoader::loadFromXML(const std::string& filename, std
             double ty = parseDouble(getAttribute(line, "translateY"));
             double tz = parseDouble(getAttribute(line, "translateZ"));
 
-            Vec3 scale(sx, sy, sz);
-            Vec3 translate(tx, ty, tz);
+            mesh.scale = Vec3(sx, sy, sz);
+            mesh.translate = Vec3(tx, ty, tz);
+            desc.meshes.push_back(mesh);
 
-            std::shared_ptr<Material> mat = nullptr;
-            if (materialMap.count(mat_id)) {
-                mat = materialMap[mat_id];
-            }
-
-            auto mesh = ObjectLoader::loadObj(path, mat, scale, translate);
-            if (mesh) {
-                world->addEntity(mesh);
-            }
+            SceneDescription::EntityDesc entity;
+            entity.type = SceneDescription::EntityType::Mesh;
+            entity.mesh = static_cast<int>(desc.meshes.size() - 1);
+            entity.material = findMaterial(getAttribute(line, "material"));
+            desc.entities.push_back(entity);
         }
         else if (line.find("<normalmapped") != std::string::npos) {
             std::string id = getAttribute(line, "id");
-            Color ambient(parseDouble(getAttribute(line, "ambientR")),
+            SceneDescription::MaterialDesc mat;
+            mat.type = SceneDescription::MaterialType::NormalMapped;
+            mat.ambient = Color(parseDouble(getAttribute(line, "ambientR")),
                 parseDouble(getAttribute(line, "ambientG")),
                 parseDouble(getAttribute(line, "ambientB")));
-            Color diffuse(parseDouble(getAttribute(line, "diffuseR")),
+            mat.diffuse = Color(parseDouble(getAttribute(line, "diffuseR")),
                 parseDouble(getAttribute(line, "diffuseG")),
                 parseDouble(getAttribute(line, "diffuseB")));
-            Color specular(parseDouble(getAttribute(line, "specularR")),
+            mat.specular = Color(parseDouble(getAttribute(line, "specularR")),
                 parseDouble(getAttribute(line, "specularG")),
                 parseDouble(getAttribute(line, "specularB")));
-            double shininess = parseDouble(getAttribute(line, "shininess"));
-            std::string normalMapPath = getAttribute(line, "normalmap");
+            mat.shininess = parseDouble(getAttribute(line, "shininess"));
+            mat.texture = textureIndex(desc, getAttribute(line, "normalmap"), TextureFormat::Normal, line);
+            addMaterial(id, mat);
+        }
+    }
+
+    return true;
+}
+
+std::shared_ptr<Scene> SceneLoader::buildScene(const SceneDescription& desc,
+    std::unique_ptr<Camera>& out_camera,
+    std::unique_ptr<WhittedTracer>& out_tracer,
+    const std::vector<std::shared_ptr<const Texture>>& textures,
+    const std::vector<std::shared_ptr<Mesh>>& meshes)
+{
+    auto world = std::make_shared<EntityList>();
+    auto scene = std::make_shared<Scene>(world);
+
+    out_camera = std::make_unique<Camera>(desc.eye, desc.look_at, desc.up, desc.aspect, desc.width, desc.samples);
+    out_tracer = std::make_unique<WhittedTracer>(desc.max_depth, desc.bias);
 
-            Texture normalMap(normalMapPath);
-            auto mat = std::make_shared<MaterialNormalMapped>(ambient, diffuse, specular, shininess, normalMap);
-            materialMap[id] = mat;
+    auto textureAt = [&](int index) -> std::shared_ptr<const Texture> {
+        if (index < 0 || index >= static_cast<int>(desc.textures.size())) {
+            return std::make_shared<const Texture>();
         }
+        if (index < static_cast<int>(textures.size()) && textures[index]) {
+            return textures[index];
+        }
+        const auto& t = desc.textures[index];
+        return TextureCache::getInstance().get(t.path, t.format, t.layout, t.paged);
+    };
+
+    std::vector<std::shared_ptr<Material>> materials;
+    for (const auto& m : desc.materials) {
+        std::shared_ptr<Material> mat;
+        switch (m.type) {
+        case SceneDescription::MaterialType::Lambertian:
+            mat = std::make_shared<LambertianMaterial>(m.ambient, m.diffuse, m.specular, m.shininess);
+            break;
+        case SceneDescription::MaterialType::Mirror:
+            mat = std::make_shared<MaterialMirror>(m.albedo, *out_tracer);
+            break;
+        case SceneDescription::MaterialType::Glass:
+            mat = std::make_shared<MaterialGlass>(m.albedo, m.ior, *out_tracer);
+            break;
+        case SceneDescription::MaterialType::Textured:
+            mat = std::make_shared<MaterialTextured>(textureAt(m.texture), m.shininess);
+            break;
+        case SceneDescription::MaterialType::NormalMapped:
+            mat = std::make_shared<MaterialNormalMapped>(m.ambient, m.diffuse, m.specular, static_cast<float>(m.shininess), textureAt(m.texture));
+            break;
+        }
+        materials.push_back(mat);
     }
 
+    for (const auto& e : desc.entities) {
+        std::shared_ptr<Material> mat = nullptr;
+        if (e.material >= 0 && e.material < static_cast<int>(materials.size())) {
+            mat = materials[e.material];
+        }
+
+        std::shared_ptr<Entity> entity;
+        switch (e.type) {
+        case SceneDescription::EntityType::Sphere:
+            entity = std::make_shared<Sphere>(e.center, e.radius);
+            break;
+        case SceneDescription::EntityType::Cylinder:
+            entity = std::make_shared<Cylinder>(e.center, e.y0, e.y1, e.radius);
+            break;
+        case SceneDescription::EntityType::Quad:
+            entity = std::make_shared<Quad>(e.min, e.max, e.axis, e.value);
+            break;
+        case SceneDescription::EntityType::Mesh:
+            if (e.mesh < 0 || e.mesh >= static_cast<int>(desc.meshes.size())) {
+                continue;
+            }
+            if (e.mesh < static_cast<int>(meshes.size()) && meshes[e.mesh]) {
+                meshes[e.mesh]->setMaterial(mat);
+                world->addEntity(meshes[e.mesh]);
+            }
+            else {
+                const auto& m = desc.meshes[e.mesh];
+                auto mesh = ObjectLoader::loadObj(m.path, mat, m.scale, m.translate);
+                if (mesh) {
+                    world->addEntity(mesh);
+                }
+            }
+            continue;
+        }
+        if (mat) {
+            entity->setMaterial(mat);
+        }
+        world->addEntity(entity);
+    }
 
+    for (const auto& l : desc.lights) {
+        scene->addLight(std::make_shared<PointLight>(l.position, l.intensity));
+    }
 
     return scene;
 }
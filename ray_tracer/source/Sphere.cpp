@@ -13,6 +13,18 @@
  */
 
 #include "Sphere.h"
+#include "RenderStats.h"
+#include <cmath>
+
+namespace {
+	/**
+	 * @brief Coordenadas (u,v) esféricas de un punto de la esfera unitaria
+	 */
+	void sphereUV(const Vec3& p_local, double& u, double& v) {
+		u = 0.5f + atan2(p_local.getZ(), p_local.getX()) / (2.0f * PI);
+		v = 0.5f - asin(clamp(p_local.getY(), -1.0, 1.0)) / PI;
+	}
+}
 
 /**
  * @brief Constructor que inicializa la esfera con un centro y un radio
@@ -41,6 +53,7 @@ Sphere::Sphere(const Vec3& center, double radius) : center(center), radius(radiu
  * @return true si hay intersección dentro del intervalo válido, false en caso contrario
  */
 bool Sphere::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const {
+	RenderStats::addKernel(RenderCounter::SphereTests);
 	Vec3 oc = center - ray.getOrigin();
 	double a = ray.getDirection().lengthSquared();
 	double h = dotProduct(ray.getDirection(), oc);
@@ -75,6 +88,22 @@ bool Sphere::hit(const Ray& ray, Interval ray_t, HitRecord& rec) const {
 	rec.u = u;
 	rec.v = v;
 
+	// Huella del píxel en (u,v) a partir de los diferenciales del rayo
+	rec.dudx = rec.dvdx = rec.dudy = rec.dvdy = 0.0;
+	Vec3 px, py;
+	if (ray.differentialPoints(rec.point, normal, px, py)) {
+		double ux, vx, uy, vy;
+		sphereUV(unitVector(px - center), ux, vx);
+		sphereUV(unitVector(py - center), uy, vy);
+		// u da la vuelta en la costura de la esfera
+		auto wrap = [](double du) { return du > 0.5 ? du - 1.0 : (du < -0.5 ? du + 1.0 : du); };
+		rec.dudx = wrap(ux - rec.u);
+		rec.dvdx = vx - rec.v;
+		rec.dudy = wrap(uy - rec.u);
+		rec.dvdy = vy - rec.v;
+	}
+
+	RenderStats::addKernel(RenderCounter::SphereHits);
 	return true;
 }
 
@@ -1,69 +1,892 @@
 #include "Texture.h"
+#include "TextureTileCache.h"
+#include "MappedFile.h"
+#include "BinaryStream.h"
 #include "Constants.h"
+#include "Trace.h"
 #include <FreeImage.h>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <utility>
+
+namespace {
+    /**
+     * @brief Tablas de decodificación compartidas por todas las texturas
+     */
+    struct DecodeTables {
+        float linear[256];          ///< i / 255
+        float srgb[256];            ///< Curva sRGB a lineal
+        std::vector<float> half;    ///< Los 65536 valores de punto flotante de 16 bits
+
+        DecodeTables() : half(65536) {
+            for (int i = 0; i < 256; ++i) {
+                linear[i] = i / 255.0f;
+                float c = i / 255.0f;
+                srgb[i] = c <= 0.04045f ? c / 12.92f : static_cast<float>(std::pow((c + 0.055) / 1.055, 2.4));
+            }
+            for (uint32_t i = 0; i < 65536; ++i) {
+                half[i] = halfToFloat(static_cast<uint16_t>(i));
+            }
+        }
+
+        static float halfToFloat(uint16_t value) {
+            uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+            uint32_t exponent = (value >> 10) & 0x1F;
+            uint32_t mantissa = value & 0x3FF;
+            uint32_t bits;
+            if (exponent == 0) {
+                if (mantissa == 0) {
+                    bits = sign;
+                }
+                else {
+                    // Subnormal: se normaliza la mantisa
+                    exponent = 127 - 15 + 1;
+                    while (!(mantissa & 0x400)) {
+                        mantissa <<= 1;
+                        --exponent;
+                    }
+                    bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+                }
+            }
+            else if (exponent == 0x1F) {
+                bits = sign | 0x7F800000 | (mantissa << 13);
+            }
+            else {
+                bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+            }
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+    };
+
+    const DecodeTables TABLES;
+
+    // Conversión a punto flotante de 16 bits con redondeo al par más cercano
+    uint16_t floatToHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        uint32_t sign = (bits >> 16) & 0x8000;
+        uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t mantissa = bits & 0x7FFFFF;
+
+        if (exponent == 0xFF) {
+            return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+        }
+        int e = static_cast<int>(exponent) - 127 + 15;
+        if (e >= 31) {
+            return static_cast<uint16_t>(sign | 0x7C00);
+        }
+        if (e <= 0) {
+            if (e < -10) {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000;
+            int shift = 14 - e;
+            uint32_t result = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (result & 1))) {
+                ++result;
+            }
+            return static_cast<uint16_t>(sign | result);
+        }
+        uint32_t result = sign | (static_cast<uint32_t>(e) << 10) | (mantissa >> 13);
+        uint32_t rest = mantissa & 0x1FFF;
+        if (rest > 0x1000 || (rest == 0x1000 && (result & 1))) {
+            ++result; // Un acarreo hacia el exponente sigue siendo correcto
+        }
+        return static_cast<uint16_t>(result);
+    }
+
+    uint8_t toByte(float value) {
+        return static_cast<uint8_t>(clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    float linearToSrgb(float c) {
+        c = clamp(c, 0.0f, 1.0f);
+        return c <= 0.0031308f ? c * 12.92f : static_cast<float>(1.055 * std::pow(c, 1.0 / 2.4) - 0.055);
+    }
+
+    uint16_t toUnorm16(float value) {
+        return static_cast<uint16_t>(clamp(value * 0.5f + 0.5f, 0.0f, 1.0f) * 65535.0f + 0.5f);
+    }
+
+    float fromUnorm16(uint32_t value) {
+        return value * (2.0f / 65535.0f) - 1.0f;
+    }
+
+    float signNotZero(float v) {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    // Normal en [-1, 1] a codificación octaédrica de 2 x 16 bits
+    uint32_t packNormal(float x, float y, float z) {
+        float l1 = std::abs(x) + std::abs(y) + std::abs(z);
+        if (l1 < 1e-8f) {
+            x = 0.0f;
+            y = 0.0f;
+            z = 1.0f;
+            l1 = 1.0f;
+        }
+        float px = x / l1;
+        float py = y / l1;
+        if (z < 0.0f) {
+            float ox = (1.0f - std::abs(py)) * signNotZero(px);
+            float oy = (1.0f - std::abs(px)) * signNotZero(py);
+            px = ox;
+            py = oy;
+        }
+        return static_cast<uint32_t>(toUnorm16(px)) | (static_cast<uint32_t>(toUnorm16(py)) << 16);
+    }
+
+    Vec3 unpackNormal(uint32_t packed) {
+        float x = fromUnorm16(packed & 0xFFFF);
+        float y = fromUnorm16(packed >> 16);
+        float z = 1.0f - std::abs(x) - std::abs(y);
+        if (z < 0.0f) {
+            float ox = (1.0f - std::abs(y)) * signNotZero(x);
+            float oy = (1.0f - std::abs(x)) * signNotZero(y);
+            x = ox;
+            y = oy;
+        }
+        return unitVector(Vec3(x, y, z));
+    }
+
+    void encodeFloats(TextureFormat format, uint32_t* dst, float r, float g, float b, float a) {
+        switch (format) {
+        case TextureFormat::RGBA8:
+            dst[0] = toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (static_cast<uint32_t>(toByte(a)) << 24);
+            break;
+        case TextureFormat::SRGBA8:
+            dst[0] = toByte(linearToSrgb(r)) | (toByte(linearToSrgb(g)) << 8) | (toByte(linearToSrgb(b)) << 16)
+                | (static_cast<uint32_t>(toByte(a)) << 24);
+            break;
+        case TextureFormat::RGBAHalf:
+            dst[0] = floatToHalf(r) | (static_cast<uint32_t>(floatToHalf(g)) << 16);
+            dst[1] = floatToHalf(b) | (static_cast<uint32_t>(floatToHalf(a)) << 16);
+            break;
+        case TextureFormat::Normal:
+            dst[0] = packNormal(r * 2.0f - 1.0f, g * 2.0f - 1.0f, b * 2.0f - 1.0f);
+            break;
+        }
+    }
+
+    void encodeBytes(TextureFormat format, uint32_t* dst, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+        if (format == TextureFormat::RGBA8 || format == TextureFormat::SRGBA8) {
+            // Los bytes de la imagen se guardan tal cual; el formato sólo cambia cómo se decodifican
+            dst[0] = r | (g << 8) | (b << 16) | (static_cast<uint32_t>(a) << 24);
+            return;
+        }
+        encodeFloats(format, dst, TABLES.linear[r], TABLES.linear[g], TABLES.linear[b], TABLES.linear[a]);
+    }
+
+    // Separa los 16 bits bajos de v dejando un cero entre cada uno (para el índice Morton)
+    uint64_t spreadBits(uint32_t v) {
+        uint64_t x = v & 0xFFFF;
+        x = (x | (x << 8)) & 0x00FF00FF;
+        x = (x | (x << 4)) & 0x0F0F0F0F;
+        x = (x | (x << 2)) & 0x33333333;
+        x = (x | (x << 1)) & 0x55555555;
+        return x;
+    }
+
+    int ceilLog2(int value) {
+        int bits = 0;
+        while ((1 << bits) < value) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    const int TILE_SIZE = 8;
+
+    // Texturas paginadas
+    const int PAGE_TILE_SIZE = 64;
+    const int RECENT_TILES = 4;
+    const char TILE_FILE_MAGIC[8] = { 'I', 'C', 'G', 'T', 'I', 'L', 'E', 'S' };
+    const uint32_t TILE_FILE_VERSION = 1;
+
+    /**
+     * @brief Encabezado del archivo de bloques; siguen el ancho y alto de cada nivel y los bloques
+     */
+    struct TileFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t format;
+        uint64_t source_size;
+        int64_t source_mtime;
+        uint32_t tile_size;
+        uint32_t level_count;
+    };
+    static_assert(sizeof(TileFileHeader) == 40, "TileFileHeader debe tener un layout fijo");
+
+    std::atomic<uint64_t> next_texture_id(1);
+
+    /**
+     * @brief Bloque usado recientemente por un hilo
+     */
+    struct RecentTile {
+        uint64_t texture_id = 0;
+        int level = -1;
+        int tile = -1;
+        std::shared_ptr<const TextureTileCache::Tile> data;
+    };
+
+    thread_local RecentTile recent_tiles[RECENT_TILES];
+    thread_local int recent_next = 0;
+
+    void decodeFloats(TextureFormat format, const uint32_t* src, float out[4]) {
+        switch (format) {
+        case TextureFormat::RGBA8:
+            out[0] = TABLES.linear[src[0] & 0xFF];
+            out[1] = TABLES.linear[(src[0] >> 8) & 0xFF];
+            out[2] = TABLES.linear[(src[0] >> 16) & 0xFF];
+            out[3] = TABLES.linear[src[0] >> 24];
+            break;
+        case TextureFormat::SRGBA8:
+            out[0] = TABLES.srgb[src[0] & 0xFF];
+            out[1] = TABLES.srgb[(src[0] >> 8) & 0xFF];
+            out[2] = TABLES.srgb[(src[0] >> 16) & 0xFF];
+            out[3] = TABLES.linear[src[0] >> 24];
+            break;
+        case TextureFormat::RGBAHalf:
+            out[0] = TABLES.half[src[0] & 0xFFFF];
+            out[1] = TABLES.half[src[0] >> 16];
+            out[2] = TABLES.half[src[1] & 0xFFFF];
+            out[3] = TABLES.half[src[1] >> 16];
+            break;
+        case TextureFormat::Normal: {
+            // Se devuelve la normal llevada a [0, 1], igual que en la imagen original
+            Vec3 n = unpackNormal(src[0]);
+            out[0] = static_cast<float>(n.getX() * 0.5 + 0.5);
+            out[1] = static_cast<float>(n.getY() * 0.5 + 0.5);
+            out[2] = static_cast<float>(n.getZ() * 0.5 + 0.5);
+            out[3] = 1.0f;
+            break;
+        }
+        }
+    }
+}
+
+/**
+ * @brief Archivo de bloques abierto de una textura paginada
+ */
+struct Texture::PagedSource {
+    uint64_t id = 0;                        ///< Identificador en TextureTileCache
+    size_t tile_words = 0;                  ///< Palabras de 32 bits por bloque
+    std::vector<uint64_t> level_offsets;    ///< Posición en el archivo del primer bloque de cada nivel
+    std::vector<int> tiles_x;               ///< Bloques por fila en cada nivel
+    std::mutex mutex;                       ///< Protege las lecturas de file
+    std::ifstream file;
+
+    ~PagedSource() {
+        TextureTileCache::getInstance().evictTexture(id);
+    }
+
+    bool readTile(int level, int tile, TextureTileCache::Tile& out) {
+        out.resize(tile_words);
+        std::lock_guard<std::mutex> lock(mutex);
+        file.seekg(static_cast<std::streamoff>(level_offsets[level] + static_cast<uint64_t>(tile) * tile_words * sizeof(uint32_t)));
+        if (!file.read(reinterpret_cast<char*>(out.data()), tile_words * sizeof(uint32_t))) {
+            file.clear();
+            return false;
+        }
+        return true;
+    }
+};
 
 Texture::Texture() {}
 
-Texture::Texture(const std::string& filepath) {
-    loadFromFile(filepath);
+Texture::Texture(const std::string& filepath, TextureFormat format, TextureLayout layout, bool paged)
+    : format(format), layout(paged ? TextureLayout::Linear : layout) {
+    if (paged) {
+        loadPaged(filepath);
+    }
+    else {
+        loadFromFile(filepath);
+    }
+}
+
+Texture::Texture(int width, int height, const std::vector<Color>& pixels, TextureFormat format, TextureLayout layout)
+    : format(format), layout(layout) {
+    size_t count = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+    if (width <= 0 || height <= 0 || pixels.size() != count) {
+        return;
+    }
+    size_t words = wordsPerTexel(format);
+    MipLevel base;
+    base.width = width;
+    base.height = height;
+    base.texels.resize(count * words);
+    for (size_t i = 0; i < count; ++i) {
+        const Color& c = pixels[i];
+        encodeFloats(format, &base.texels[i * words], static_cast<float>(c.getR()), static_cast<float>(c.getG()), static_cast<float>(c.getB()), 1.0f);
+    }
+    levels.push_back(std::move(base));
+    buildMipmaps();
+    applyLayout();
+    loaded = true;
+}
+
+Texture::Texture(int width, int height, TextureFormat format, std::vector<uint32_t> texels)
+    : format(format) {
+    if (width <= 0 || height <= 0 || texels.size() != static_cast<size_t>(width) * height * wordsPerTexel(format)) {
+        return;
+    }
+    MipLevel base;
+    base.width = width;
+    base.height = height;
+    base.texels = std::move(texels);
+    levels.push_back(std::move(base));
+    buildMipmaps();
+    applyLayout();
+    loaded = true;
+}
+
+Texture::Texture(TextureFormat format, TextureLayout layout, std::vector<MipLevel> mip_levels)
+    : format(format), layout(layout), levels(std::move(mip_levels)) {
+    // Cada nivel debe ser la mitad del anterior (mínimo 1) y terminar en 1x1
+    bool valid = !levels.empty();
+    for (size_t i = 0; valid && i < levels.size(); ++i) {
+        MipLevel& level = levels[i];
+        level.log2_width = ceilLog2(level.width);
+        level.log2_height = ceilLog2(level.height);
+        valid = level.width > 0 && level.height > 0
+            && level.texels.size() == storageTexels(layout, level) * wordsPerTexel(format);
+        if (valid && i > 0) {
+            valid = level.width == std::max(1, levels[i - 1].width / 2) && level.height == std::max(1, levels[i - 1].height / 2);
+        }
+    }
+    valid = valid && levels.back().width == 1 && levels.back().height == 1;
+    if (!valid) {
+        levels.clear();
+        return;
+    }
+    loaded = true;
 }
 
 bool Texture::isLoaded() const {
     return loaded;
 }
 
+bool Texture::isPaged() const {
+    return paged_source != nullptr;
+}
+
+int Texture::getWidth() const {
+    return levels.empty() ? 0 : levels[0].width;
+}
+
+int Texture::getHeight() const {
+    return levels.empty() ? 0 : levels[0].height;
+}
+
+TextureFormat Texture::getFormat() const {
+    return format;
+}
+
+TextureLayout Texture::getLayout() const {
+    return layout;
+}
+
+const std::vector<uint32_t>& Texture::getTexels() const {
+    static const std::vector<uint32_t> empty;
+    return levels.empty() ? empty : levels[0].texels;
+}
+
+int Texture::getLevelCount() const {
+    return static_cast<int>(levels.size());
+}
+
+const Texture::MipLevel& Texture::getLevel(int level) const {
+    return levels[level];
+}
+
+size_t Texture::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : levels) {
+        bytes += level.texels.size() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+size_t Texture::wordsPerTexel(TextureFormat format) {
+    return format == TextureFormat::RGBAHalf ? 2 : 1;
+}
+
+const char* Texture::formatName(TextureFormat format) {
+    switch (format) {
+    case TextureFormat::RGBA8: return "rgba8";
+    case TextureFormat::SRGBA8: return "srgb8";
+    case TextureFormat::RGBAHalf: return "half";
+    case TextureFormat::Normal: return "normal";
+    }
+    return "";
+}
+
+bool Texture::parseFormat(const std::string& name, TextureFormat& format) {
+    if (name == "rgba8") format = TextureFormat::RGBA8;
+    else if (name == "srgb8") format = TextureFormat::SRGBA8;
+    else if (name == "half") format = TextureFormat::RGBAHalf;
+    else return false;
+    return true;
+}
+
+const char* Texture::layoutName(TextureLayout layout) {
+    switch (layout) {
+    case TextureLayout::Linear: return "linear";
+    case TextureLayout::Tiled: return "tiled";
+    case TextureLayout::Morton: return "morton";
+    }
+    return "";
+}
+
+bool Texture::parseLayout(const std::string& name, TextureLayout& layout) {
+    if (name == "linear") layout = TextureLayout::Linear;
+    else if (name == "tiled") layout = TextureLayout::Tiled;
+    else if (name == "morton") layout = TextureLayout::Morton;
+    else return false;
+    return true;
+}
+
 void Texture::loadFromFile(const std::string& filepath) {
-    FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filepath.c_str(), 0);
-    if (format == FIF_UNKNOWN) {
-        format = FreeImage_GetFIFFromFilename(filepath.c_str());
+    TraceScope trace("Texture::loadFromFile", "carga");
+    trace.arg("archivo", filepath);
+    FREE_IMAGE_FORMAT file_format = FreeImage_GetFileType(filepath.c_str(), 0);
+    if (file_format == FIF_UNKNOWN) {
+        file_format = FreeImage_GetFIFFromFilename(filepath.c_str());
     }
 
-    if (format == FIF_UNKNOWN) {
+    if (file_format == FIF_UNKNOWN) {
         std::cerr << "Formato desconocido para la textura: " << filepath << std::endl;
         return;
     }
 
-    FIBITMAP* bitmap = FreeImage_Load(format, filepath.c_str());
+    FIBITMAP* bitmap = FreeImage_Load(file_format, filepath.c_str());
     if (!bitmap) {
         std::cerr << "No se pudo cargar la textura: " << filepath << std::endl;
         return;
     }
 
-    FIBITMAP* bitmap32 = FreeImage_ConvertTo32Bits(bitmap);
-    FreeImage_Unload(bitmap);
+    size_t words = wordsPerTexel(format);
+    MipLevel base;
 
-    width = FreeImage_GetWidth(bitmap32);
-    height = FreeImage_GetHeight(bitmap32);
+    if (FreeImage_GetImageType(bitmap) != FIT_BITMAP) {
+        // Imágenes de punto flotante (HDR, EXR): se leen sin pasar por 8 bits
+        FIBITMAP* bitmapf = FreeImage_ConvertToRGBAF(bitmap);
+        FreeImage_Unload(bitmap);
+        if (!bitmapf) {
+            std::cerr << "No se pudo convertir la textura a punto flotante: " << filepath << std::endl;
+            return;
+        }
 
-    data.resize(width * height);
+        base.width = FreeImage_GetWidth(bitmapf);
+        base.height = FreeImage_GetHeight(bitmapf);
+        base.texels.resize(static_cast<size_t>(base.width) * base.height * words);
 
-    for (int y = 0; y < height; ++y) {
-        BYTE* bits = FreeImage_GetScanLine(bitmap32, y);
-        for (int x = 0; x < width; ++x) {
-            float r = bits[FI_RGBA_RED] / 255.0f;
-            float g = bits[FI_RGBA_GREEN] / 255.0f;
-            float b = bits[FI_RGBA_BLUE] / 255.0f;
-            data[y * width + x] = Color(r, g, b);
-            bits += 4;
+        for (int y = 0; y < base.height; ++y) {
+            const FIRGBAF* bits = reinterpret_cast<const FIRGBAF*>(FreeImage_GetScanLine(bitmapf, y));
+            for (int x = 0; x < base.width; ++x) {
+                encodeFloats(format, &base.texels[(static_cast<size_t>(y) * base.width + x) * words], bits[x].red, bits[x].green, bits[x].blue, bits[x].alpha);
+            }
         }
+        FreeImage_Unload(bitmapf);
     }
+    else {
+        FIBITMAP* bitmap32 = FreeImage_ConvertTo32Bits(bitmap);
+        FreeImage_Unload(bitmap);
 
+        base.width = FreeImage_GetWidth(bitmap32);
+        base.height = FreeImage_GetHeight(bitmap32);
+        base.texels.resize(static_cast<size_t>(base.width) * base.height * words);
+
+        for (int y = 0; y < base.height; ++y) {
+            BYTE* bits = FreeImage_GetScanLine(bitmap32, y);
+            for (int x = 0; x < base.width; ++x) {
+                encodeBytes(format, &base.texels[(static_cast<size_t>(y) * base.width + x) * words],
+                    bits[FI_RGBA_RED], bits[FI_RGBA_GREEN], bits[FI_RGBA_BLUE], bits[FI_RGBA_ALPHA]);
+                bits += 4;
+            }
+        }
+        FreeImage_Unload(bitmap32);
+    }
+
+    if (base.width <= 0 || base.height <= 0) {
+        return;
+    }
+    levels.push_back(std::move(base));
+    buildMipmaps();
+    applyLayout();
     loaded = true;
-    FreeImage_Unload(bitmap32);
 }
 
-Color Texture::sample(double u, double v) const {
-    if (!loaded || width == 0 || height == 0) {
-        return Color(1, 0, 1); // Magenta: error
+void Texture::loadPaged(const std::string& filepath) {
+    // Cada formato tiene su propio archivo, porque los bloques guardan los texels ya codificados
+    std::string tile_path = filepath + "." + formatName(format) + ".tiles";
+    if (openTileFile(filepath, tile_path)) {
+        return;
+    }
+
+    // Primera carga (o imagen modificada): se decodifica completa una vez para escribir los bloques
+    loadFromFile(filepath);
+    if (!loaded) {
+        return;
+    }
+    if (writeTileFile(filepath, tile_path) && openTileFile(filepath, tile_path)) {
+        std::cout << "Archivo de bloques escrito: " << tile_path << std::endl;
+        return;
+    }
+    std::cerr << "No se pudo escribir " << tile_path << ", la textura queda completa en memoria" << std::endl;
+}
+
+bool Texture::writeTileFile(const std::string& filepath, const std::string& tile_path) const {
+    TileFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TILE_FILE_MAGIC, sizeof(TILE_FILE_MAGIC));
+    header.version = TILE_FILE_VERSION;
+    header.format = static_cast<uint32_t>(format);
+    header.tile_size = PAGE_TILE_SIZE;
+    header.level_count = static_cast<uint32_t>(levels.size());
+    if (!MappedFile::fileInfo(filepath, header.source_size, header.source_mtime)) {
+        return false;
+    }
+
+    // Se escribe a un archivo temporal y se renombra para no dejar archivos a medio escribir
+    std::string temp_path = tile_path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        BinaryWriter out(file);
+        out.write(header);
+        for (const auto& level : levels) {
+            out.write(int32_t(level.width));
+            out.write(int32_t(level.height));
+        }
+
+        size_t words = wordsPerTexel(format);
+        std::vector<uint32_t> tile(static_cast<size_t>(PAGE_TILE_SIZE) * PAGE_TILE_SIZE * words);
+        for (const auto& level : levels) {
+            int tiles_x = (level.width + PAGE_TILE_SIZE - 1) / PAGE_TILE_SIZE;
+            int tiles_y = (level.height + PAGE_TILE_SIZE - 1) / PAGE_TILE_SIZE;
+            for (int ty = 0; ty < tiles_y; ++ty) {
+                for (int tx = 0; tx < tiles_x; ++tx) {
+                    std::fill(tile.begin(), tile.end(), 0u);
+                    int x0 = tx * PAGE_TILE_SIZE;
+                    int columns = std::min(PAGE_TILE_SIZE, level.width - x0);
+                    for (int row = 0; row < PAGE_TILE_SIZE; ++row) {
+                        int y = ty * PAGE_TILE_SIZE + row;
+                        if (y >= level.height) {
+                            break;
+                        }
+                        const uint32_t* src = &level.texels[(static_cast<size_t>(y) * level.width + x0) * words];
+                        std::copy(src, src + columns * words, &tile[static_cast<size_t>(row) * PAGE_TILE_SIZE * words]);
+                    }
+                    out.writeBytes(tile.data(), tile.size() * sizeof(uint32_t));
+                }
+            }
+        }
+        if (!out.good()) {
+            file.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+
+    std::remove(tile_path.c_str());
+    if (std::rename(temp_path.c_str(), tile_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Texture::openTileFile(const std::string& filepath, const std::string& tile_path) {
+    uint64_t source_size;
+    int64_t source_mtime;
+    if (!MappedFile::fileInfo(filepath, source_size, source_mtime)) {
+        return false;
+    }
+
+    auto source = std::make_shared<PagedSource>();
+    source->id = next_texture_id++;
+    source->file.open(tile_path, std::ios::binary);
+    if (!source->file) {
+        return false;
+    }
+
+    TileFileHeader header;
+    if (!source->file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, TILE_FILE_MAGIC, sizeof(TILE_FILE_MAGIC)) != 0
+        || header.version != TILE_FILE_VERSION || header.format != static_cast<uint32_t>(format)
+        || header.source_size != source_size || header.source_mtime != source_mtime
+        || header.tile_size != static_cast<uint32_t>(PAGE_TILE_SIZE)
+        || header.level_count == 0 || header.level_count > 64) {
+        return false;
+    }
+
+    size_t words = wordsPerTexel(format);
+    source->tile_words = static_cast<size_t>(PAGE_TILE_SIZE) * PAGE_TILE_SIZE * words;
+    std::vector<MipLevel> dims(header.level_count);
+    uint64_t offset = sizeof(header) + static_cast<uint64_t>(header.level_count) * 2 * sizeof(int32_t);
+    for (size_t i = 0; i < dims.size(); ++i) {
+        int32_t width, height;
+        if (!source->file.read(reinterpret_cast<char*>(&width), sizeof(width))
+            || !source->file.read(reinterpret_cast<char*>(&height), sizeof(height))
+            || width <= 0 || height <= 0) {
+            return false;
+        }
+        if (i > 0 && (width != std::max(1, dims[i - 1].width / 2) || height != std::max(1, dims[i - 1].height / 2))) {
+            return false;
+        }
+        dims[i].width = width;
+        dims[i].height = height;
+        int tiles_x = (width + PAGE_TILE_SIZE - 1) / PAGE_TILE_SIZE;
+        int tiles_y = (height + PAGE_TILE_SIZE - 1) / PAGE_TILE_SIZE;
+        source->level_offsets.push_back(offset);
+        source->tiles_x.push_back(tiles_x);
+        offset += static_cast<uint64_t>(tiles_x) * tiles_y * source->tile_words * sizeof(uint32_t);
+    }
+
+    // Un archivo truncado se descarta y se vuelve a generar
+    source->file.seekg(0, std::ios::end);
+    if (static_cast<uint64_t>(source->file.tellg()) != offset) {
+        return false;
+    }
+
+    levels = std::move(dims);
+    paged_source = source;
+    loaded = true;
+    return true;
+}
+
+// Se llama con los niveles todavía fila por fila, antes de applyLayout
+void Texture::buildMipmaps() {
+    size_t words = wordsPerTexel(format);
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        const MipLevel& src = levels.back();
+        MipLevel next;
+        next.width = std::max(1, src.width / 2);
+        next.height = std::max(1, src.height / 2);
+        next.texels.resize(static_cast<size_t>(next.width) * next.height * words);
+
+        // Promedio de bloques de 2x2 en espacio lineal (en dimensiones impares se repite el borde)
+        for (int y = 0; y < next.height; ++y) {
+            int y0 = std::min(2 * y, src.height - 1);
+            int y1 = std::min(2 * y + 1, src.height - 1);
+            for (int x = 0; x < next.width; ++x) {
+                int x0 = std::min(2 * x, src.width - 1);
+                int x1 = std::min(2 * x + 1, src.width - 1);
+                const int xs[4] = { x0, x1, x0, x1 };
+                const int ys[4] = { y0, y0, y1, y1 };
+                float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                for (int k = 0; k < 4; ++k) {
+                    float value[4];
+                    decodeFloats(format, &src.texels[(static_cast<size_t>(ys[k]) * src.width + xs[k]) * words], value);
+                    for (int c = 0; c < 4; ++c) {
+                        sum[c] += value[c];
+                    }
+                }
+                encodeFloats(format, &next.texels[(static_cast<size_t>(y) * next.width + x) * words],
+                    sum[0] * 0.25f, sum[1] * 0.25f, sum[2] * 0.25f, sum[3] * 0.25f);
+            }
+        }
+        levels.push_back(std::move(next));
+    }
+}
+
+size_t Texture::storageTexels(TextureLayout layout, const MipLevel& level) {
+    switch (layout) {
+    case TextureLayout::Tiled: {
+        size_t tiles_x = (level.width + TILE_SIZE - 1) / TILE_SIZE;
+        size_t tiles_y = (level.height + TILE_SIZE - 1) / TILE_SIZE;
+        return tiles_x * tiles_y * TILE_SIZE * TILE_SIZE;
+    }
+    case TextureLayout::Morton:
+        return (static_cast<size_t>(1) << level.log2_width) << level.log2_height;
+    case TextureLayout::Linear:
+        break;
+    }
+    return static_cast<size_t>(level.width) * level.height;
+}
+
+size_t Texture::texelIndex(const MipLevel& level, int x, int y) const {
+    switch (layout) {
+    case TextureLayout::Tiled: {
+        size_t tiles_x = (level.width + TILE_SIZE - 1) / TILE_SIZE;
+        size_t tile = static_cast<size_t>(y / TILE_SIZE) * tiles_x + x / TILE_SIZE;
+        return tile * TILE_SIZE * TILE_SIZE + (y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE;
+    }
+    case TextureLayout::Morton: {
+        // Los bits bajos comunes a ambos ejes se intercalan; los que sobran del eje más largo van arriba
+        int common = std::min(level.log2_width, level.log2_height);
+        uint32_t mask = (1u << common) - 1;
+        uint64_t low = spreadBits(x & mask) | (spreadBits(y & mask) << 1);
+        uint64_t high = level.log2_width > level.log2_height ? (x >> common) : (y >> common);
+        return static_cast<size_t>(low | (high << (2 * common)));
+    }
+    case TextureLayout::Linear:
+        break;
+    }
+    return static_cast<size_t>(y) * level.width + x;
+}
+
+void Texture::applyLayout() {
+    size_t words = wordsPerTexel(format);
+    for (auto& level : levels) {
+        level.log2_width = ceilLog2(level.width);
+        level.log2_height = ceilLog2(level.height);
+        if (layout == TextureLayout::Linear) {
+            continue;
+        }
+        std::vector<uint32_t> reordered(storageTexels(layout, level) * words, 0);
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                const uint32_t* src = &level.texels[(static_cast<size_t>(y) * level.width + x) * words];
+                std::copy(src, src + words, &reordered[texelIndex(level, x, y) * words]);
+            }
+        }
+        level.texels.swap(reordered);
+    }
+}
+
+const uint32_t* Texture::texelData(int level, int x, int y) const {
+    size_t words = wordsPerTexel(format);
+    if (!paged_source) {
+        const MipLevel& l = levels[level];
+        return &l.texels[texelIndex(l, x, y) * words];
+    }
+
+    PagedSource& source = *paged_source;
+    int tile = (y / PAGE_TILE_SIZE) * source.tiles_x[level] + x / PAGE_TILE_SIZE;
+    size_t offset = (static_cast<size_t>(y % PAGE_TILE_SIZE) * PAGE_TILE_SIZE + x % PAGE_TILE_SIZE) * words;
+
+    // Los bloques usados recientemente por este hilo se resuelven sin tomar el lock de la caché
+    for (const auto& recent : recent_tiles) {
+        if (recent.texture_id == source.id && recent.level == level && recent.tile == tile) {
+            return recent.data->data() + offset;
+        }
+    }
+    auto data = TextureTileCache::getInstance().get(source.id, level, tile,
+        [&](TextureTileCache::Tile& out) { return source.readTile(level, tile, out); });
+    if (!data) {
+        return nullptr;
+    }
+    RecentTile& slot = recent_tiles[recent_next];
+    recent_next = (recent_next + 1) % RECENT_TILES;
+    slot.texture_id = source.id;
+    slot.level = level;
+    slot.tile = tile;
+    slot.data = data;
+    return data->data() + offset;
+}
+
+Color Texture::texel(int x, int y, int level) const {
+    const uint32_t* data = texelData(level, x, y);
+    if (!data) {
+        return Color(1, 0, 1);
     }
+    float value[4];
+    decodeFloats(format, data, value);
+    return Color(value[0], value[1], value[2]);
+}
+
+Vec3 Texture::fetch(int level, int x, int y) const {
+    const uint32_t* data = texelData(level, x, y);
+    if (!data) {
+        return Vec3(1, 0, 1); // Bloque ilegible: magenta, igual que una textura sin cargar
+    }
+    switch (format) {
+    case TextureFormat::RGBA8: {
+        uint32_t t = data[0];
+        return Vec3(TABLES.linear[t & 0xFF], TABLES.linear[(t >> 8) & 0xFF], TABLES.linear[(t >> 16) & 0xFF]);
+    }
+    case TextureFormat::SRGBA8: {
+        uint32_t t = data[0];
+        return Vec3(TABLES.srgb[t & 0xFF], TABLES.srgb[(t >> 8) & 0xFF], TABLES.srgb[(t >> 16) & 0xFF]);
+    }
+    case TextureFormat::RGBAHalf:
+        return Vec3(TABLES.half[data[0] & 0xFFFF], TABLES.half[data[0] >> 16], TABLES.half[data[1] & 0xFFFF]);
+    case TextureFormat::Normal:
+        return unpackNormal(data[0]);
+    }
+    return Vec3(1, 0, 1);
+}
+
+Vec3 Texture::bilinear(int level, double u, double v) const {
+    const MipLevel& l = levels[level];
 
     u = clamp(u, 0.0, 1.0);
     v = clamp(v, 0.0, 1.0);
 
-    int x = std::min(int(u * width), width - 1);
-    int y = std::min(int((1.0f - v) * height), height - 1); // invertir v: FreeImage es bottom-up
+    // Centros de texel en coordenadas continuas; v se invierte porque FreeImage es bottom-up
+    double x = u * l.width - 0.5;
+    double y = (1.0 - v) * l.height - 0.5;
+    int x0 = static_cast<int>(std::floor(x));
+    int y0 = static_cast<int>(std::floor(y));
+    double fx = x - x0;
+    double fy = y - y0;
+    int x1 = std::min(x0 + 1, l.width - 1);
+    int y1 = std::min(y0 + 1, l.height - 1);
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+
+    Vec3 bottom = (1.0 - fx) * fetch(level, x0, y0) + fx * fetch(level, x1, y0);
+    Vec3 top = (1.0 - fx) * fetch(level, x0, y1) + fx * fetch(level, x1, y1);
+    return (1.0 - fy) * bottom + fy * top;
+}
+
+double Texture::levelOfDetail(double dudx, double dvdx, double dudy, double dvdy) const {
+    // Lado mayor de la huella del píxel, medido en texels del nivel 0
+    double w = levels[0].width;
+    double h = levels[0].height;
+    double fx = (dudx * w) * (dudx * w) + (dvdx * h) * (dvdx * h);
+    double fy = (dudy * w) * (dudy * w) + (dvdy * h) * (dvdy * h);
+    double footprint = std::max(fx, fy);
+    if (footprint <= 1.0) {
+        return 0.0;
+    }
+    return std::min(0.5 * std::log2(footprint), static_cast<double>(levels.size() - 1));
+}
+
+Vec3 Texture::filtered(double u, double v, double dudx, double dvdx, double dudy, double dvdy) const {
+    double lod = levelOfDetail(dudx, dvdx, dudy, dvdy);
+    int level = static_cast<int>(lod);
+    double f = lod - level;
+    if (level >= static_cast<int>(levels.size()) - 1 || f < 1e-6) {
+        return bilinear(level, u, v);
+    }
+    return (1.0 - f) * bilinear(level, u, v) + f * bilinear(level + 1, u, v);
+}
 
-    return data[y * width + x];
-}
\ No newline at end of file
+Color Texture::sample(double u, double v, double dudx, double dvdx, double dudy, double dvdy) const {
+    if (!loaded) {
+        return Color(1, 0, 1); // Magenta: error
+    }
+
+    Vec3 value = filtered(u, v, dudx, dvdx, dudy, dvdy);
+    if (format == TextureFormat::Normal) {
+        value = 0.5 * unitVector(value) + Vec3(0.5, 0.5, 0.5);
+    }
+    return Color(value.getX(), value.getY(), value.getZ());
+}
+
+Vec3 Texture::sampleNormal(double u, double v, double dudx, double dvdx, double dudy, double dvdy) const {
+    if (!loaded) {
+        return Vec3(0, 0, 1);
+    }
+
+    Vec3 value = filtered(u, v, dudx, dvdx, dudy, dvdy);
+    if (format == TextureFormat::Normal) {
+        return value.lengthSquared() > 1e-12 ? unitVector(value) : Vec3(0, 0, 1);
+    }
+    return 2.0 * value - Vec3(1, 1, 1);
+}
@@ -0,0 +1,94 @@
+#include "TextureCache.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+TextureCache& TextureCache::getInstance() {
+	static TextureCache instance;
+	return instance;
+}
+
+std::string TextureCache::cacheKey(const std::string& path, TextureFormat format, TextureLayout layout, bool paged) {
+	std::string key = path;
+	std::replace(key.begin(), key.end(), '\\', '/');
+	return key + "|" + Texture::formatName(format) + "|" + Texture::layoutName(layout) + (paged ? "|paged" : "");
+}
+
+std::shared_ptr<const Texture> TextureCache::get(const std::string& path, TextureFormat format, TextureLayout layout, bool paged) {
+	std::string key = cacheKey(path, format, layout, paged);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = textures.find(key);
+		if (it != textures.end()) {
+			return it->second;
+		}
+	}
+
+	// La decodificación se hace fuera del lock para no serializar cargas de imágenes distintas
+	auto texture = std::make_shared<const Texture>(path, format, layout, paged);
+	if (!texture->isLoaded()) {
+		return texture;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto inserted = textures.emplace(key, texture);
+	if (inserted.second) {
+		std::cout << "Textura cargada: " << path << " (" << texture->getWidth() << "x" << texture->getHeight() << ", "
+			<< Texture::formatName(format) << ", ";
+		if (texture->isPaged()) {
+			std::cout << "paginada)" << std::endl;
+		}
+		else {
+			std::cout << Texture::layoutName(texture->getLayout()) << ", " << texture->memoryBytes() / (1024.0 * 1024.0) << " MB)" << std::endl;
+		}
+	}
+	return inserted.first->second;
+}
+
+std::shared_ptr<const Texture> TextureCache::insert(const std::string& path, Texture texture) {
+	std::string key = cacheKey(path, texture.getFormat(), texture.getLayout(), texture.isPaged());
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = textures.find(key);
+	if (it != textures.end()) {
+		return it->second;
+	}
+	auto shared = std::make_shared<const Texture>(std::move(texture));
+	if (shared->isLoaded()) {
+		textures.emplace(key, shared);
+	}
+	return shared;
+}
+
+size_t TextureCache::releaseUnused() {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t released = 0;
+	for (auto it = textures.begin(); it != textures.end();) {
+		if (it->second.use_count() == 1) {
+			it = textures.erase(it);
+			++released;
+		}
+		else {
+			++it;
+		}
+	}
+	return released;
+}
+
+void TextureCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	textures.clear();
+}
+
+size_t TextureCache::size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return textures.size();
+}
+
+size_t TextureCache::memoryBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t bytes = 0;
+	for (const auto& entry : textures) {
+		bytes += entry.second->memoryBytes();
+	}
+	return bytes;
+}
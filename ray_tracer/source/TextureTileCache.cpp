@@ -0,0 +1,95 @@
+#include "TextureTileCache.h"
+#include "Trace.h"
+
+TextureTileCache& TextureTileCache::getInstance() {
+	static TextureTileCache instance;
+	return instance;
+}
+
+uint64_t TextureTileCache::makeKey(uint64_t texture_id, int level, int tile) {
+	return (texture_id << 40) | (static_cast<uint64_t>(level & 0xFF) << 32) | static_cast<uint32_t>(tile);
+}
+
+std::shared_ptr<const TextureTileCache::Tile> TextureTileCache::get(uint64_t texture_id, int level, int tile, const std::function<bool(Tile&)>& load) {
+	uint64_t key = makeKey(texture_id, level, tile);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = entries.find(key);
+		if (it != entries.end()) {
+			lru.splice(lru.begin(), lru, it->second);
+			++hits;
+			return it->second->tile;
+		}
+	}
+
+	auto loaded = std::make_shared<Tile>();
+	{
+		TraceScope trace("decodificar bloque de textura", "carga");
+		trace.arg("nivel", level);
+		trace.arg("bloque", tile);
+		if (!load(*loaded)) {
+			return nullptr;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.find(key);
+	if (it != entries.end()) {
+		lru.splice(lru.begin(), lru, it->second);
+		return it->second->tile;
+	}
+	++misses;
+	lru.push_front(Entry{ key, loaded });
+	entries[key] = lru.begin();
+	used += loaded->size() * sizeof(uint32_t);
+	evictToBudget();
+	return loaded;
+}
+
+void TextureTileCache::evictToBudget() {
+	// El bloque recién insertado (al frente) nunca se descarta, aunque supere el presupuesto solo
+	while (used > budget && lru.size() > 1) {
+		const Entry& oldest = lru.back();
+		used -= oldest.tile->size() * sizeof(uint32_t);
+		entries.erase(oldest.key);
+		lru.pop_back();
+		++evictions;
+	}
+}
+
+void TextureTileCache::evictTexture(uint64_t texture_id) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto it = lru.begin(); it != lru.end();) {
+		if ((it->key >> 40) == texture_id) {
+			used -= it->tile->size() * sizeof(uint32_t);
+			entries.erase(it->key);
+			it = lru.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void TextureTileCache::setBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	budget = bytes;
+	evictToBudget();
+}
+
+size_t TextureTileCache::getBudget() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return budget;
+}
+
+size_t TextureTileCache::usedBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return used;
+}
+
+void TextureTileCache::printStats(std::ostream& os) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	os << "Bloques de textura: " << lru.size() << " en memoria (" << used / (1024.0 * 1024.0) << " de "
+		<< budget / (1024.0 * 1024.0) << " MB), " << hits << " aciertos, " << misses << " lecturas, "
+		<< evictions << " descartes" << std::endl;
+}
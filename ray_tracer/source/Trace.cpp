@@ -0,0 +1,138 @@
+#include "Trace.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+	struct Event {
+		const char* name;
+		const char* category;
+		double begin;
+		double duration;
+		int thread;
+		std::string args;
+	};
+
+	/**
+	 * @brief Eventos y nombres de hilos; los eventos son pocos (del orden de uno por bloque y
+	 * pasada), así que un mutex alcanza
+	 */
+	struct Recorder {
+		std::mutex mutex;
+		std::vector<Event> events;
+		std::map<int, std::string> thread_names;
+		std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+		std::atomic<int> next_thread{ 0 };
+	};
+
+	Recorder& recorder() {
+		static Recorder instance;
+		return instance;
+	}
+
+	// Identificador chico y estable del hilo actual, en el orden en que cada hilo registra su primer evento
+	int threadIndex() {
+		static thread_local int index = recorder().next_thread.fetch_add(1);
+		return index;
+	}
+
+	std::string escape(const std::string& text) {
+		std::string out;
+		for (char c : text) {
+			if (c == '"' || c == '\\') {
+				out += '\\';
+				out += c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20) {
+				out += ' ';
+			}
+			else {
+				out += c;
+			}
+		}
+		return out;
+	}
+}
+
+std::atomic<bool> Trace::enabled(false);
+
+void Trace::start() {
+	Recorder& rec = recorder();
+	{
+		std::lock_guard<std::mutex> lock(rec.mutex);
+		rec.events.clear();
+		rec.origin = std::chrono::steady_clock::now();
+	}
+	setThreadName("principal");
+	enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::setThreadName(const std::string& name) {
+	Recorder& rec = recorder();
+	int thread = threadIndex();
+	std::lock_guard<std::mutex> lock(rec.mutex);
+	rec.thread_names[thread] = name;
+}
+
+double Trace::now() {
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - recorder().origin).count();
+}
+
+void Trace::record(const char* name, const char* category, double begin, double end, const std::string& args) {
+	Recorder& rec = recorder();
+	int thread = threadIndex();
+	std::lock_guard<std::mutex> lock(rec.mutex);
+	rec.events.push_back(Event{ name, category, begin, end - begin, thread, args });
+}
+
+bool Trace::write(const std::string& path) {
+	Recorder& rec = recorder();
+	std::lock_guard<std::mutex> lock(rec.mutex);
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) {
+		std::cerr << "No se pudo escribir: " << path << std::endl;
+		return false;
+	}
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	for (const auto& entry : rec.thread_names) {
+		file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << entry.first
+			<< ", \"args\": {\"name\": \"" << escape(entry.second) << "\"}}";
+		first = false;
+	}
+	for (const Event& e : rec.events) {
+		file << (first ? "" : ",\n") << "{\"name\": \"" << e.name << "\", \"cat\": \"" << e.category
+			<< "\", \"ph\": \"X\", \"ts\": " << e.begin << ", \"dur\": " << e.duration
+			<< ", \"pid\": 1, \"tid\": " << e.thread;
+		if (!e.args.empty()) {
+			file << ", \"args\": {" << e.args << "}";
+		}
+		file << "}";
+		first = false;
+	}
+	file << "\n]}\n";
+	if (!file) {
+		std::cerr << "Error escribiendo: " << path << std::endl;
+		return false;
+	}
+	std::cout << "Línea de tiempo guardada: " << path << " (" << rec.events.size() << " eventos)" << std::endl;
+	return true;
+}
+
+void TraceScope::arg(const char* key, int64_t value) {
+	if (!active) return;
+	std::ostringstream oss;
+	oss << (args.empty() ? "" : ", ") << "\"" << key << "\": " << value;
+	args += oss.str();
+}
+
+void TraceScope::arg(const char* key, const std::string& value) {
+	if (!active) return;
+	args += (args.empty() ? "\"" : ", \"") + std::string(key) + "\": \"" + escape(value) + "\"";
+}
@@ -1,4 +1,6 @@
 #include "Triangle.h"
+#include "RenderStats.h"
+#include <cmath>
 
 Triangle::Triangle(const Vec3& a, const Vec3& b, const Vec3& c, std::shared_ptr<Material> m)
     : v0(a), v1(b), v2(c), material_ptr(m) {
@@ -17,6 +19,7 @@ Triangle::Triangle(const Vec3& a, const Vec3& b, const Vec3& c, std::shared_ptr<
 }
 
 bool Triangle::hit(const Ray& r, Interval t, HitRecord& rec) const {
+    RenderStats::addKernel(RenderCounter::TriangleTests);
     const double EPSILON = 1e-8;
     Vec3 edge1 = v1 - v0;
     Vec3 edge2 = v2 - v0;
@@ -43,8 +46,48 @@ bool Triangle::hit(const Ray& r, Interval t, HitRecord& rec) const {
     rec.t = t_hit;
     rec.point = r.pointAtParameter(t_hit);
     rec.setFaceNormal(r, normal);
+    if (has_vertex_normals) {
+        Vec3 shading = unitVector((1.0 - u - v) * n0 + u * n1 + v * n2);
+        rec.normal = rec.frontFace ? shading : -shading;
+    }
+    rec.dudx = rec.dvdx = rec.dudy = rec.dvdy = 0.0;
+    if (has_tex_coords) {
+        Vec3 uv = (1.0 - u - v) * uv0 + u * uv1 + v * uv2;
+        rec.u = uv.getX();
+        rec.v = uv.getY();
+
+        // Huella del píxel en (u,v): baricéntricas de los rayos desplazados sobre el plano del triángulo
+        Vec3 px, py;
+        if (r.differentialPoints(rec.point, normal, px, py)) {
+            double d00 = dotProduct(edge1, edge1);
+            double d01 = dotProduct(edge1, edge2);
+            double d11 = dotProduct(edge2, edge2);
+            double denom = d00 * d11 - d01 * d01;
+            if (std::fabs(denom) > EPSILON) {
+                auto barycentric = [&](const Vec3& p, double& b1, double& b2) {
+                    Vec3 w = p - v0;
+                    double d20 = dotProduct(w, edge1);
+                    double d21 = dotProduct(w, edge2);
+                    b1 = (d11 * d20 - d01 * d21) / denom;
+                    b2 = (d00 * d21 - d01 * d20) / denom;
+                };
+                double bx1, bx2, by1, by2;
+                barycentric(px, bx1, bx2);
+                barycentric(py, by1, by2);
+                Vec3 duv1 = uv1 - uv0;
+                Vec3 duv2 = uv2 - uv0;
+                Vec3 duv_dx = (bx1 - u) * duv1 + (bx2 - v) * duv2;
+                Vec3 duv_dy = (by1 - u) * duv1 + (by2 - v) * duv2;
+                rec.dudx = duv_dx.getX();
+                rec.dvdx = duv_dx.getY();
+                rec.dudy = duv_dy.getX();
+                rec.dvdy = duv_dy.getY();
+            }
+        }
+    }
     rec.material_ptr = material_ptr;
 	//std::cout << "Hit triangle at t = " << rec.t << std::endl;
+    RenderStats::addKernel(RenderCounter::TriangleHits);
     return true;
 }
 
@@ -81,3 +124,19 @@ void Triangle::setMaterial(std::shared_ptr<Material> material)
 {
 	material_ptr = material;
 }
+
+void Triangle::setVertexNormals(const Vec3& a, const Vec3& b, const Vec3& c)
+{
+    n0 = a;
+    n1 = b;
+    n2 = c;
+    has_vertex_normals = true;
+}
+
+void Triangle::setTexCoords(const Vec3& a, const Vec3& b, const Vec3& c)
+{
+    uv0 = a;
+    uv1 = b;
+    uv2 = c;
+    has_tex_coords = true;
+}
@@ -10,6 +10,7 @@
  */
 
 #include "Vec3.h"
+#include <cmath>
 
 /**
  * @brief Constructor por defecto que inicializa el vector a (0,0,0)
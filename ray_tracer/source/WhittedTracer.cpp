@@ -26,7 +26,10 @@
 #include "Material.h"
 #include "Scene.h"
 #include "Interval.h"
+#include "RenderStats.h"
+#include "HDRImage.h"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <iomanip>  // Para std::put_time
 #include <sstream>  // Para std::ostringstream
@@ -38,7 +41,21 @@
  * @param shadow_bias Valor de bias para evitar self-shadowing
  */
 WhittedTracer::WhittedTracer(int max_depth, double shadow_bias)
-    : max_depth(max_depth), shadow_bias(shadow_bias) {
+    : max_depth(max_depth), shadow_bias(shadow_bias), hdr_format(HDRFormat::None) {
+}
+
+void WhittedTracer::setHDROutput(HDRFormat format)
+{
+    hdr_format = format;
+}
+
+void WhittedTracer::saveHDR(const std::string& png_path, const std::vector<Color>& pixels, int width, int height) const
+{
+    if (pixels.empty()) return;
+    std::string path = png_path.substr(0, png_path.rfind('.')) + HDRImage::extension(hdr_format);
+    if (HDRImage::save(path, pixels, width, height, hdr_format)) {
+        std::cout << "Imagen lineal guardada: " << path << std::endl;
+    }
 }
 
 /**
@@ -50,7 +67,7 @@ WhittedTracer::WhittedTracer(int max_depth, double shadow_bias)
  */
 Color WhittedTracer::trace(const Ray& ray, const Scene& scene, int depth) const {
     // Verificar límite de profundidad de recursión
-    
+    RenderStats::recordMax(RenderCounter::MaxDepth, uint64_t(depth));
     
     // Encontrar la intersección más cercana
     HitRecord hit_record;
@@ -127,7 +144,7 @@ void WhittedTracer::generateReflectionMap(const Scene& scene, Camera& camera,
     
     std::time_t now = std::time(nullptr);
     std::tm tm_info{};
-    if (localtime_s(&tm_info, &now) != 0) {
+    if (!localTime(now, tm_info)) {
         std::cerr << "Error al obtener la hora local.\n";
         return;
     }
@@ -192,7 +209,7 @@ void WhittedTracer::generateTransmissionMap(const Scene& scene, Camera& camera,
     
     std::time_t now = std::time(nullptr);
     std::tm tm_info{};
-    if (localtime_s(&tm_info, &now) != 0) {
+    if (!localTime(now, tm_info)) {
         std::cerr << "Error al obtener la hora local.\n";
         return;
     }
@@ -262,7 +279,7 @@ void WhittedTracer::generateDiffuseImage(const Scene& scene, Camera& camera, int
 
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return;
 	}
@@ -304,7 +321,7 @@ void WhittedTracer::generateSpecularImage(const Scene& scene, Camera& camera, in
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return;
 	}
@@ -344,7 +361,7 @@ void WhittedTracer::generateAmbientImage(const Scene& scene, Camera& camera, int
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return;
 	}
@@ -386,7 +403,7 @@ void WhittedTracer::generateReflectionImage(const Scene& scene, Camera& camera,
 
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return;
 	}
@@ -431,7 +448,7 @@ void WhittedTracer::generateTransmissionImage(const Scene& scene, Camera& camera
 
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) != 0) {
+	if (!localTime(now, tm_info)) {
 		std::cerr << "Error al obtener la hora local.\n";
 		return;
 	}
@@ -467,15 +484,18 @@ void WhittedTracer::renderWhittedSceneLive(const Scene& scene, Camera& camera, S
     }
 
     std::vector<uint8_t> framebuffer(width * height * 3, 0);
+    std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 
     for (int j = 0; j < height; ++j) {
         for (int i = 0; i < width; ++i) {
             Color pixel_color(0, 0, 0);
             for (int s = 0; s < spp; ++s) {
-                Ray ray = camera.getRandomRay(i, j);
+                Ray ray = camera.getRandomRay(i, j, s);
                 pixel_color += trace(ray, scene);
             }
+            RenderStats::add(RenderCounter::PrimaryRays, uint64_t(spp));
             pixel_color = pixel_color / static_cast<double>(spp);
+            if (!hdr.empty()) hdr[size_t(j) * width + i] = pixel_color;
             pixel_color = Color(
                 std::sqrt(pixel_color.getR()),
                 std::sqrt(pixel_color.getG()),
@@ -506,9 +526,10 @@ void WhittedTracer::renderWhittedSceneLive(const Scene& scene, Camera& camera, S
 
     std::time_t now = std::time(nullptr);
     std::tm tm_info{};
-    if (localtime_s(&tm_info, &now) == 0) {
+    if (localTime(now, tm_info)) {
         std::ostringstream oss;
         oss << "images/render_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+        saveHDR(oss.str(), hdr, width, height);
         if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
             std::cout << "Imagen guardada: " << oss.str() << std::endl;
         }
@@ -535,11 +556,13 @@ void WhittedTracer::renderTransmissionLive(const Scene& scene, Camera& camera, S
     }
 
     std::vector<uint8_t> framebuffer(width * height * 3, 0);
+    std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 
     for (int j = 0; j < height; ++j) {
         for (int i = 0; i < width; ++i) {
             Ray ray = camera.getRay(i, j);
             Color transmission_color = traceComponent(ray, scene, ShadeComponent::Transmission);
+            if (!hdr.empty()) hdr[size_t(j) * width + i] = transmission_color;
 
             uint8_t r = transmission_color.getRbyte();
             uint8_t g = transmission_color.getGbyte();
@@ -565,9 +588,10 @@ void WhittedTracer::renderTransmissionLive(const Scene& scene, Camera& camera, S
 
     std::time_t now = std::time(nullptr);
     std::tm tm_info{};
-    if (localtime_s(&tm_info, &now) == 0) {
+    if (localTime(now, tm_info)) {
         std::ostringstream oss;
         oss << "images/transmission_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+        saveHDR(oss.str(), hdr, width, height);
         if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
             std::cout << "Imagen de transmisión guardada: " << oss.str() << std::endl;
         }
@@ -593,10 +617,12 @@ void WhittedTracer::renderReflectionLive(const Scene& scene, Camera& camera, SDL
 		return;
 	}
 	std::vector<uint8_t> framebuffer(width * height * 3, 0);
+	std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 	for (int j = 0; j < height; ++j) {
 		for (int i = 0; i < width; ++i) {
 			Ray ray = camera.getRay(i, j);
 			Color reflection_color = traceComponent(ray, scene, ShadeComponent::Reflection);
+			if (!hdr.empty()) hdr[size_t(j) * width + i] = reflection_color;
 			uint8_t r = reflection_color.getRbyte();
 			uint8_t g = reflection_color.getGbyte();
 			uint8_t b = reflection_color.getBbyte();
@@ -617,9 +643,10 @@ void WhittedTracer::renderReflectionLive(const Scene& scene, Camera& camera, SDL
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) == 0) {
+	if (localTime(now, tm_info)) {
 		std::ostringstream oss;
 		oss << "images/reflection_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+		saveHDR(oss.str(), hdr, width, height);
 		if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
 			std::cout << "Imagen de reflexión guardada: " << oss.str() << std::endl;
 		}
@@ -643,10 +670,12 @@ void WhittedTracer::renderDiffuseLive(const Scene& scene, Camera& camera, SDL_Re
 		return;
 	}
 	std::vector<uint8_t> framebuffer(width * height * 3, 0);
+	std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 	for (int j = 0; j < height; ++j) {
 		for (int i = 0; i < width; ++i) {
 			Ray ray = camera.getRay(i, j);
 			Color diffuse_color = traceComponent(ray, scene, ShadeComponent::Diffuse);
+			if (!hdr.empty()) hdr[size_t(j) * width + i] = diffuse_color;
 			uint8_t r = diffuse_color.getRbyte();
 			uint8_t g = diffuse_color.getGbyte();
 			uint8_t b = diffuse_color.getBbyte();
@@ -667,9 +696,10 @@ void WhittedTracer::renderDiffuseLive(const Scene& scene, Camera& camera, SDL_Re
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) == 0) {
+	if (localTime(now, tm_info)) {
 		std::ostringstream oss;
 		oss << "images/diffuse_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+		saveHDR(oss.str(), hdr, width, height);
 		if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
 			std::cout << "Imagen componente difusa guardada: " << oss.str() << std::endl;
 		}
@@ -693,10 +723,12 @@ void WhittedTracer::renderSpecularLive(const Scene& scene, Camera& camera, SDL_R
 		return;
 	}
 	std::vector<uint8_t> framebuffer(width * height * 3, 0);
+	std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 	for (int j = 0; j < height; ++j) {
 		for (int i = 0; i < width; ++i) {
 			Ray ray = camera.getRay(i, j);
 			Color specular_color = traceComponent(ray, scene, ShadeComponent::Specular);
+			if (!hdr.empty()) hdr[size_t(j) * width + i] = specular_color;
 			uint8_t r = specular_color.getRbyte();
 			uint8_t g = specular_color.getGbyte();
 			uint8_t b = specular_color.getBbyte();
@@ -717,9 +749,10 @@ void WhittedTracer::renderSpecularLive(const Scene& scene, Camera& camera, SDL_R
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) == 0) {
+	if (localTime(now, tm_info)) {
 		std::ostringstream oss;
 		oss << "images/specular_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+		saveHDR(oss.str(), hdr, width, height);
 		if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
 			std::cout << "Imagen componente especular guardada: " << oss.str() << std::endl;
 		}
@@ -743,10 +776,12 @@ void WhittedTracer::renderAmbientLive(const Scene& scene, Camera& camera, SDL_Re
 		return;
 	}
 	std::vector<uint8_t> framebuffer(width * height * 3, 0);
+	std::vector<Color> hdr(hdr_format != HDRFormat::None ? size_t(width) * height : 0);
 	for (int j = 0; j < height; ++j) {
 		for (int i = 0; i < width; ++i) {
 			Ray ray = camera.getRay(i, j);
 			Color ambient_color = traceComponent(ray, scene, ShadeComponent::Ambient);
+			if (!hdr.empty()) hdr[size_t(j) * width + i] = ambient_color;
 			uint8_t r = ambient_color.getRbyte();
 			uint8_t g = ambient_color.getGbyte();
 			uint8_t b = ambient_color.getBbyte();
@@ -767,9 +802,10 @@ void WhittedTracer::renderAmbientLive(const Scene& scene, Camera& camera, SDL_Re
 	}
 	std::time_t now = std::time(nullptr);
 	std::tm tm_info{};
-	if (localtime_s(&tm_info, &now) == 0) {
+	if (localTime(now, tm_info)) {
 		std::ostringstream oss;
 		oss << "images/ambient_" << std::put_time(&tm_info, "%Y-%m-%d_%H-%M-%S") << ".png";
+		saveHDR(oss.str(), hdr, width, height);
 		if (FreeImage_Save(FIF_PNG, bitmap, oss.str().c_str(), 0)) {
 			std::cout << "Imagen componente ambiental guardada: " << oss.str() << std::endl;
 		}
@@ -783,7 +819,15 @@ void WhittedTracer::renderAmbientLive(const Scene& scene, Camera& camera, SDL_Re
 
 void WhittedTracer::renderLive(const Scene& scene, Camera& camera, SDL_Renderer* renderer, SDL_Texture* texture)
 {
+	RenderStats::reset();
 	renderWhittedSceneLive(scene, camera, renderer, texture);
+	// Sólo la imagen principal; las de componentes trazan rayos propios que distorsionarían el resumen
+	RenderStats::print(std::cout, RenderStats::snapshot());
+	renderComponentsLive(scene, camera, renderer, texture);
+}
+
+void WhittedTracer::renderComponentsLive(const Scene& scene, Camera& camera, SDL_Renderer* renderer, SDL_Texture* texture)
+{
 	renderDiffuseLive(scene, camera, renderer, texture);
 	renderSpecularLive(scene, camera, renderer, texture);
 	renderAmbientLive(scene, camera, renderer, texture);
@@ -30,10 +30,15 @@
 
 #include <FreeImage.h>
 #include <iostream>
+#include <cmath>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
 #include <memory>
+#include <string>
+#include <cstdlib>
+#include <csignal>
+#include <cstdio>
 
 // Componentes base del sistema
 #include "Constants.h"
@@ -68,6 +73,21 @@
 #include "MaterialMirror.h"
 
 #include "SceneLoader.h"
+#include "SceneBundle.h"
+#include "TextureTileCache.h"
+#include "ProgressiveRenderer.h"
+#include "CameraController.h"
+#include "CancellationToken.h"
+#include "MappedFile.h"
+#include "PartialImage.h"
+#include "RenderServer.h"
+#include "Benchmark.h"
+#include "MicroBenchmark.h"
+#include "ImageRegression.h"
+#include "RenderStats.h"
+#include "Trace.h"
+#include "Denoiser.h"
+#include "Sampler.h"
 
 
 
@@ -165,7 +185,7 @@ void renderWhittedScene(const Scene& scene, Camera& camera) {
             // Muestreo múltiple para antialiasing
             int samples = camera.getSamplesPerPixel();
             for (int s = 0; s < samples; ++s) {
-                Ray ray = camera.getRandomRay(i, j);
+                Ray ray = camera.getRandomRay(i, j, s);
                 pixel_color += tracer.trace(ray, scene);
             }
             
@@ -189,7 +209,7 @@ void renderWhittedScene(const Scene& scene, Camera& camera) {
     // Guardar imagen
     std::time_t now = std::time(nullptr);
     std::tm tm_info{};
-    if (localtime_s(&tm_info, &now) != 0) {
+    if (!localTime(now, tm_info)) {
         std::cerr << "Error al obtener la hora local.\n";
         return;
     }
@@ -216,6 +236,68 @@ void renderWhittedScene(const Scene& scene, Camera& camera) {
 
 
 
+CancellationToken interrupt_token;
+
+/**
+ * @brief Cancela el render sin ventana al recibir Ctrl+C o SIGTERM; se guarda la imagen obtenida
+ * hasta ese momento (y el checkpoint, si hay)
+ */
+void onInterrupt(int) {
+    interrupt_token.cancel();
+}
+
+/**
+ * @brief Renderiza sin ventana hasta completar las muestras, agotar el presupuesto o recibir Ctrl+C
+ *
+ * @param renderer Render progresivo ya configurado
+ * @param partial_path Si no está vacío guarda la acumulación como parte de un render distribuido en lugar del PNG
+ * @return 0 si se guardó el resultado, 1 si no
+ */
+int renderHeadless(ProgressiveRenderer& renderer, const std::string& partial_path) {
+    renderer.setCancellationToken(&interrupt_token);
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+    renderer.start();
+    renderer.wait();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    if (!partial_path.empty()) {
+        if (!renderer.savePartial(partial_path)) return 1;
+        std::cout << "Parte guardada: " << partial_path << std::endl;
+        return 0;
+    }
+    return renderer.saveImage() ? 0 : 1;
+}
+
+/**
+ * @brief Imprime las estadísticas de la imagen principal y, si se pidió, las guarda en JSON
+ */
+void reportStats(const std::string& stats_path) {
+    RenderCounters counters = RenderStats::snapshot();
+    RenderStats::print(std::cout, counters);
+    if (!stats_path.empty() && RenderStats::writeJSON(stats_path, counters)) {
+        std::cout << "Estadísticas guardadas: " << stats_path << std::endl;
+    }
+}
+
+/**
+ * @brief Combina las partes de un render distribuido y guarda la imagen final
+ * @param hdr_format Si no es HDRFormat::None guarda también la imagen lineal, con el nombre de la salida
+ * @return 0 si se guardó la imagen, 1 si no
+ */
+int mergeParts(const std::vector<std::string>& parts, const std::string& output, HDRFormat hdr_format) {
+    PartialImage merged;
+    if (!PartialImage::merge(parts, merged)) return 1;
+    std::cout << "Partes combinadas: " << parts.size() << std::endl;
+    if (!merged.saveImage(output)) return 1;
+    if (hdr_format != HDRFormat::None) {
+        std::string hdr_path = output.substr(0, output.rfind('.')) + HDRImage::extension(hdr_format);
+        if (!HDRImage::save(hdr_path, merged.resolve(), merged.width, merged.height, hdr_format)) return 1;
+        std::cout << "Imagen lineal guardada: " << hdr_path << std::endl;
+    }
+    return 0;
+}
+
 /**
  * @brief Función principal del programa
  * 
@@ -226,23 +308,271 @@ void renderWhittedScene(const Scene& scene, Camera& camera) {
  * 4. Configura la cámara con parámetros optimizados
  * 5. Ejecuta el ray tracing básico
  * 6. Demuestra las capacidades del WhittedTracer
+ *
+ * Uso: ray_tracer [escena.xml | escena.icgscene] [--compile salida.icgscene] [--texture-budget MB] [--interactive]
+ *                  [--headless] [--time-budget segundos] [--adaptive error]
+ *                  [--checkpoint archivo] [--checkpoint-interval segundos]
+ *                  [--tiles i/n] [--samples primera:cantidad] [--partial archivo]
+ *                  [--stats estadisticas.json] [--cost-map] [--trace linea_de_tiempo.json] [--hdr pfm|exr]
+ *                  [--denoise] [--sampler random|stratified|halton|sobol|bluenoise]
+ *        ray_tracer --merge salida.png [--hdr pfm|exr] parte1 parte2 ...
+ *        ray_tracer --serve endpoint
+ *        ray_tracer --submit endpoint "solicitud" salida.png
+ *        ray_tracer --benchmark salida.json [--baseline base.json] [--tolerance porcentaje]
+ *        ray_tracer --microbench salida.json
+ *        ray_tracer --regress | --update-golden
+ * - Sin argumentos carga assets/scenes/XMLscene.xml
+ * - Con un .icgscene carga la escena ya compilada
+ * - Con --compile compila el XML indicado en un bundle y termina sin renderizar
+ * - Con --texture-budget limita la memoria de los bloques de texturas paginadas
+ * - Con --interactive la cámara se mueve con teclado y mouse (ver CameraController),
+ *   cada movimiento reinicia el render y Enter guarda la imagen actual
+ * - Con --headless renderiza sin ventana, guarda la imagen y termina (Ctrl+C corta y guarda lo obtenido)
+ * - Con --time-budget las pasadas siguen hasta agotar el tiempo, siempre completando la primera
+ * - Con --adaptive los bloques dejan de refinarse al bajar del error relativo indicado (por ejemplo 0.01)
+ * - Con --checkpoint guarda el progreso cada --checkpoint-interval segundos (60 por defecto) y,
+ *   si el archivo ya existe y es de la misma escena, continúa desde él
+ * - Render distribuido: cada proceso recibe --tiles i/n (los bloques con índice % n == i) y/o
+ *   --samples primera:cantidad, renderiza sin ventana y guarda su acumulación con --partial;
+ *   --merge suma las partes (de la misma escena, y rechaza las que repiten muestras) y guarda
+ *   la imagen final
+ * - Con --serve queda como servicio de render en el named pipe o socket Unix indicado, con las
+ *   escenas cargadas entre trabajos (ver RenderServer); --submit le envía una solicitud, por ejemplo
+ *   "render scene=assets/scenes/XMLscene.xml eye=0,1,5 spp=16", y guarda la imagen resultante
+ * - Con --benchmark renderiza las escenas incluidas con tamaño y muestras fijos y guarda tiempos,
+ *   rayos por segundo y memoria en JSON; con --baseline compara contra un JSON anterior y termina
+ *   con error si alguna escena es más lenta que la tolerancia (5% por defecto)
+ * - Con --microbench mide por separado los núcleos de intersección, muestreo de texturas y
+ *   sombreado (ver MicroBenchmark) e imprime mediana y percentiles de ciclos por llamada
+ * - Con --regress renderiza las escenas de referencia con semillas fijas, las compara con
+ *   assets/golden (PSNR, SSIM y error máximo; ver ImageRegression) y termina con error si alguna
+ *   no pasa, guardando la imagen obtenida y las diferencias; si falta alguna referencia lo avisa y
+ *   sale con el código 77; --update-golden regenera las referencias
+ * - Al terminar la imagen principal se imprimen las estadísticas del render (ver RenderStats);
+ *   con --stats también se guardan en JSON. Las pruebas de primitivas, cajas y nodos del BVH
+ *   sólo se cuentan en Debug o compilando con ICG_KERNEL_STATS=1
+ * - Con --cost-map mide el tiempo de cada muestra y guarda el costo por píxel junto a la imagen
+ *   (images/cost_map_<fecha>.png en falso color y .pfm con los nanosegundos de cada píxel)
+ * - Con --hdr guarda junto a cada PNG (imagen principal e imágenes de componentes) sus valores
+ *   lineales sin saturar en PFM u OpenEXR, para posprocesarlos sin volver a renderizar
+ * - Con --denoise filtra la imagen terminada con un à-trous guiado por normal, profundidad y
+ *   albedo (ver Denoiser) y la guarda como images/denoised_<fecha>.png; con --hdr también
+ *   guarda en float la imagen filtrada y las guías
+ * - Con --sampler elige cómo se reparten las muestras dentro de cada píxel (ver Sampler); por
+ *   defecto sobol. El patrón se guarda en checkpoints y partes, y no se reanuda ni se combina uno distinto
+ * - Con --trace guarda una línea de tiempo de la carga, la construcción de los BVH, cada bloque
+ *   de cada pasada y el guardado, por hilo, en formato de eventos de Chrome (ver Trace)
  * 
  * @return 0 si el programa se ejecuta correctamente, código de error en caso contrario
  */
-int main() {
+int main(int argc, char* argv[]) {
+
+    std::string scene_path = "assets/scenes/XMLscene.xml";
+    std::string compile_path;
+    bool interactive = false;
+    bool headless = false;
+    double time_budget = 0.0;
+    double adaptive_threshold = 0.0;
+    std::string checkpoint_path;
+    double checkpoint_interval = 60.0;
+    std::string partial_path;
+    std::string merge_output;
+    int subset_index = 0, subset_count = 1;
+    int first_sample = 0, sample_count = 0;
+    std::vector<std::string> positional;
+    std::string serve_endpoint;
+    std::string benchmark_path;
+    std::string baseline_path;
+    double tolerance = 5.0;
+    std::string stats_path;
+    bool cost_map = false;
+    bool denoise = false;
+    std::string trace_path;
+    HDRFormat hdr_format = HDRFormat::None;
+    SamplerType sampler = SamplerType::Sobol;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compile" && i + 1 < argc) {
+            compile_path = argv[++i];
+        }
+        else if (arg == "--interactive") {
+            interactive = true;
+        }
+        else if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--time-budget" && i + 1 < argc) {
+            time_budget = std::atof(argv[++i]);
+        }
+        else if (arg == "--adaptive" && i + 1 < argc) {
+            adaptive_threshold = std::atof(argv[++i]);
+        }
+        else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        }
+        else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            checkpoint_interval = std::atof(argv[++i]);
+        }
+        else if (arg == "--tiles" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%d/%d", &subset_index, &subset_count) != 2 || subset_count < 1
+                || subset_index < 0 || subset_index >= subset_count) {
+                std::cerr << "Formato de --tiles inválido (se espera i/n): " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--samples" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%d:%d", &first_sample, &sample_count) != 2 || first_sample < 0 || sample_count < 1) {
+                std::cerr << "Formato de --samples inválido (se espera primera:cantidad): " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--partial" && i + 1 < argc) {
+            partial_path = argv[++i];
+            headless = true;
+        }
+        else if (arg == "--merge" && i + 1 < argc) {
+            merge_output = argv[++i];
+        }
+        else if (arg == "--benchmark" && i + 1 < argc) {
+            benchmark_path = argv[++i];
+        }
+        else if (arg == "--microbench" && i + 1 < argc) {
+            return MicroBenchmark::run(argv[++i]);
+        }
+        else if (arg == "--regress" || arg == "--update-golden") {
+            FreeImage_Initialise();
+            int result = ImageRegression::run("assets/golden", arg == "--update-golden");
+            FreeImage_DeInitialise();
+            return result;
+        }
+        else if (arg == "--hdr" && i + 1 < argc) {
+            if (!HDRImage::parseFormat(argv[++i], hdr_format)) {
+                std::cerr << "Formato de --hdr desconocido (se espera pfm o exr): " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sampler" && i + 1 < argc) {
+            if (!Sampler::parseType(argv[++i], sampler)) {
+                std::cerr << "Patrón de --sampler desconocido (se espera random, stratified, halton, sobol o bluenoise): " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        }
+        else if (arg == "--cost-map") {
+            cost_map = true;
+        }
+        else if (arg == "--denoise") {
+            denoise = true;
+        }
+        else if (arg == "--stats" && i + 1 < argc) {
+            stats_path = argv[++i];
+        }
+        else if (arg == "--baseline" && i + 1 < argc) {
+            baseline_path = argv[++i];
+        }
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        }
+        else if (arg == "--serve" && i + 1 < argc) {
+            serve_endpoint = argv[++i];
+        }
+        else if (arg == "--submit" && i + 3 < argc) {
+            FreeImage_Initialise();
+            bool submitted = RenderServer::submit(argv[i + 1], argv[i + 2], argv[i + 3]);
+            FreeImage_DeInitialise();
+            return submitted ? 0 : 1;
+        }
+        else if (arg == "--texture-budget" && i + 1 < argc) {
+            int megabytes = std::atoi(argv[++i]);
+            if (megabytes > 0) {
+                TextureTileCache::getInstance().setBudget(size_t(megabytes) * 1024 * 1024);
+            }
+            else {
+                std::cerr << "Presupuesto de texturas inválido: " << argv[i] << std::endl;
+            }
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
 
+    if (!trace_path.empty()) {
+        Trace::start();
+    }
     FreeImage_Initialise();
 
+    if (!merge_output.empty()) {
+        int merged = mergeParts(positional, merge_output, hdr_format);
+        FreeImage_DeInitialise();
+        return merged;
+    }
+    if (!benchmark_path.empty()) {
+        int result = Benchmark::run(benchmark_path, baseline_path, tolerance);
+        FreeImage_DeInitialise();
+        return result;
+    }
+    if (!serve_endpoint.empty()) {
+        RenderServer server;
+        bool served = server.run(serve_endpoint);
+        FreeImage_DeInitialise();
+        return served ? 0 : 1;
+    }
+    if (!positional.empty()) {
+        scene_path = positional.back();
+    }
+
+    if (!compile_path.empty()) {
+        bool compiled = SceneBundle::compile(scene_path, compile_path);
+        FreeImage_DeInitialise();
+        return compiled ? 0 : 1;
+    }
+
     std::unique_ptr<Camera> camera;
     std::unique_ptr<WhittedTracer> tracer;
 
-    auto scene = SceneLoader::loadFromXML("assets/scenes/XMLscene.xml", camera, tracer);
+    auto scene = SceneBundle::isBundle(scene_path)
+        ? SceneBundle::load(scene_path, camera, tracer)
+        : SceneLoader::loadFromXML(scene_path, camera, tracer);
 
     if (!scene || !camera) {
-        std::cerr << "Error al cargar la escena desde XML.\n";
+        std::cerr << "Error al cargar la escena: " << scene_path << "\n";
         return 1;
     }
 
+    camera->setSampler(sampler);
+    ProgressiveRenderer progressive(*tracer, *scene, *camera);
+    progressive.setTimeBudget(time_budget);
+    progressive.setAdaptiveThreshold(adaptive_threshold);
+    progressive.setTileSubset(subset_index, subset_count);
+    progressive.setSampleRange(first_sample, sample_count);
+    progressive.setCostMapEnabled(cost_map);
+    progressive.setHDROutput(hdr_format);
+    tracer->setHDROutput(hdr_format);
+    if (!checkpoint_path.empty() || !partial_path.empty()) {
+        uint64_t scene_hash = 0;
+        if (!MappedFile::hashContents(scene_path, scene_hash)) {
+            std::cerr << "No se pudo leer la escena para calcular su hash: " << scene_path << std::endl;
+        }
+        progressive.setSceneHash(scene_hash);
+    }
+    if (!checkpoint_path.empty()) {
+        progressive.setCheckpoint(checkpoint_path, checkpoint_interval);
+        progressive.resume();
+    }
+    RenderStats::reset();
+    if (headless) {
+        progressive.setPreviewEnabled(false);
+        int result = renderHeadless(progressive, partial_path);
+        reportStats(stats_path);
+        if (cost_map && !progressive.saveCostMap()) result = 1;
+        if (denoise && partial_path.empty() && !Denoiser::run(progressive.getImage(), *scene, *camera, hdr_format)) result = 1;
+        if (!trace_path.empty()) Trace::write(trace_path);
+        FreeImage_DeInitialise();
+        return result;
+    }
+
   
 	int width = camera->getImageWidth();
 	int height = camera->getImageHeight();
@@ -277,18 +607,65 @@ int main() {
     }
 
 
-    (*tracer).renderLive(*scene, *camera, renderer, texture);
-	
+    // La imagen principal se acumula por pasadas en otro hilo; este hilo atiende la
+    // ventana y presenta el resultado parcial a frecuencia fija
+    const Uint32 present_interval_ms = 33;
+    progressive.start();
+    CameraController controller(*camera);
 
     SDL_Event event;
     bool running = true;
+    bool components_rendered = false;
+    Uint32 last_present = 0;
     while (running) {
+        bool moved = false;
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = false;
             }
+            else if (interactive && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_RETURN) {
+                progressive.saveImage();
+            }
+            else if (interactive && controller.handleEvent(event)) {
+                moved = true;
+            }
+        }
+        if (!running) {
+            break;
+        }
+
+        // Los eventos acumulados en el cuadro se aplican juntos: se abandonan los bloques en
+        // curso, se mueve la cámara y el render vuelve a empezar con la vista previa
+        if (moved) {
+            progressive.stop();
+            controller.apply(*camera);
+            progressive.restart();
+        }
+
+        Uint32 now = SDL_GetTicks();
+        if (now - last_present >= present_interval_ms) {
+            progressive.present(renderer, texture);
+            last_present = now;
         }
-        SDL_Delay(16);
+
+        if (!interactive && progressive.isFinished() && !components_rendered) {
+            progressive.present(renderer, texture);
+            progressive.saveImage();
+            reportStats(stats_path);
+            if (cost_map) progressive.saveCostMap();
+            if (denoise) Denoiser::run(progressive.getImage(), *scene, *camera, hdr_format);
+            (*tracer).renderComponentsLive(*scene, *camera, renderer, texture);
+            components_rendered = true;
+
+            if (TextureTileCache::getInstance().usedBytes() > 0) {
+                TextureTileCache::getInstance().printStats(std::cout);
+            }
+        }
+        SDL_Delay(progressive.isFinished() ? 16 : 1);
+    }
+    progressive.stop();
+    if (!trace_path.empty()) {
+        Trace::write(trace_path);
     }
 
     SDL_DestroyTexture(texture);